@@ -0,0 +1,153 @@
+#ifndef BYTESTREAM_H
+#define BYTESTREAM_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Little helpers for the binary formats (trajectories, checkpoints).
+// Integers are LEB128 varints, signed values are zigzag encoded first,
+// doubles are stored as their raw 8 bytes in little-endian order.
+class ByteWriter
+{
+public:
+    void putByte(uint8_t value) { bytes.push_back(value); }
+
+    void putVarint(uint64_t value)
+    {
+        while (value >= 0x80) {
+            bytes.push_back(uint8_t(value) | 0x80);
+            value >>= 7;
+        }
+        bytes.push_back(uint8_t(value));
+    }
+
+    void putSigned(int64_t value) { putVarint(zigzag(value)); }
+
+    void putFixed64(uint64_t value)
+    {
+        for (int i = 0; i < 8; ++i) bytes.push_back(uint8_t(value >> (8 * i)));
+    }
+
+    void putDouble(double value)
+    {
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof bits);
+        putFixed64(bits);
+    }
+
+    void putBytes(const uint8_t* data, size_t size)
+    {
+        putVarint(size);
+        bytes.insert(bytes.end(), data, data + size);
+    }
+
+    void putBytes(const std::vector<uint8_t>& data) { putBytes(data.data(), data.size()); }
+    void putString(const std::string& s) { putBytes(reinterpret_cast<const uint8_t*>(s.data()), s.size()); }
+
+    void putRaw(const void* data, size_t size)
+    {
+        const uint8_t* p = static_cast<const uint8_t*>(data);
+        bytes.insert(bytes.end(), p, p + size);
+    }
+
+    size_t size() const { return bytes.size(); }
+    std::vector<uint8_t>& data() { return bytes; }
+    const std::vector<uint8_t>& data() const { return bytes; }
+
+    static uint64_t zigzag(int64_t v) { return (uint64_t(v) << 1) ^ uint64_t(v >> 63); }
+
+private:
+    std::vector<uint8_t> bytes;
+};
+
+// Reads what ByteWriter wrote. Running past the end sets the error flag and
+// yields zeros instead of reading out of bounds, so callers check ok() once.
+class ByteReader
+{
+public:
+    ByteReader(const uint8_t* data = nullptr, size_t size = 0) : begin(data), end(data + size), cursor(data) {}
+    explicit ByteReader(const std::vector<uint8_t>& data) : ByteReader(data.data(), data.size()) {}
+
+    uint8_t getByte()
+    {
+        if (cursor >= end) { failed = true; return 0; }
+        return *cursor++;
+    }
+
+    uint64_t getVarint()
+    {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (cursor >= end) { failed = true; return 0; }
+            uint8_t b = *cursor++;
+            value |= uint64_t(b & 0x7F) << shift;
+            if (!(b & 0x80)) return value;
+        }
+        failed = true;
+        return 0;
+    }
+
+    int64_t getSigned() { return unzigzag(getVarint()); }
+
+    uint64_t getFixed64()
+    {
+        if (end - cursor < 8) { failed = true; cursor = end; return 0; }
+        uint64_t value = 0;
+        for (int i = 0; i < 8; ++i) value |= uint64_t(cursor[i]) << (8 * i);
+        cursor += 8;
+        return value;
+    }
+
+    double getDouble()
+    {
+        uint64_t bits = getFixed64();
+        double value;
+        std::memcpy(&value, &bits, sizeof value);
+        return value;
+    }
+
+    std::vector<uint8_t> getBytes()
+    {
+        uint64_t size = getVarint();
+        if (uint64_t(end - cursor) < size) { failed = true; cursor = end; return {}; }
+        std::vector<uint8_t> out(cursor, cursor + size);
+        cursor += size;
+        return out;
+    }
+
+    std::string getString()
+    {
+        std::vector<uint8_t> raw = getBytes();
+        return std::string(raw.begin(), raw.end());
+    }
+
+    bool getRaw(void* out, size_t size)
+    {
+        if (size_t(end - cursor) < size) { failed = true; cursor = end; return false; }
+        std::memcpy(out, cursor, size);
+        cursor += size;
+        return true;
+    }
+
+    size_t offset() const { return size_t(cursor - begin); }
+    void seek(size_t offset)
+    {
+        if (offset > size_t(end - begin)) { failed = true; cursor = end; return; }
+        cursor = begin + offset;
+    }
+    size_t size() const { return size_t(end - begin); }
+    bool atEnd() const { return cursor >= end; }
+    bool ok() const { return !failed; }
+
+    static int64_t unzigzag(uint64_t v) { return int64_t(v >> 1) ^ -int64_t(v & 1); }
+
+private:
+    const uint8_t* begin;
+    const uint8_t* end;
+    const uint8_t* cursor;
+    bool failed = false;
+};
+
+#endif // BYTESTREAM_H
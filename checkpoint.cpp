@@ -0,0 +1,130 @@
+#include "checkpoint.h"
+#include "bytestream.h"
+#include "vacuum.h"
+
+#include <QFile>
+#include <QSaveFile>
+
+#include <algorithm>
+
+namespace {
+const char runMagic[4] = {'R', 'S', 'C', 'K'};
+const uint64_t runVersion = 1;
+}
+
+CheckpointedRun::CheckpointedRun(Vacuum &vacuum)
+    : vacuum(vacuum)
+{
+}
+
+void CheckpointedRun::start(const QString &newAlgorithm, quint64 newSeed, const EnsembleSettings &newSettings)
+{
+    algorithm = newAlgorithm;
+    seed = newSeed;
+    settings = newSettings;
+    plateau = PlateauDetector(settings.plateauWindow, settings.plateauMinGain);
+    EnsembleRunner::prepare(vacuum, algorithm, seed, settings);
+    plateau.add(vacuum.getCoveredArea());
+}
+
+bool CheckpointedRun::load(const QString &path, QString *error)
+{
+    auto fail = [&](const QString &message) {
+        if (error) *error = message;
+        return false;
+    };
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) return fail("Cannot open " + path);
+    const QByteArray bytes = file.readAll();
+    ByteReader in(reinterpret_cast<const uint8_t*>(bytes.constData()), size_t(bytes.size()));
+
+    char magic[4] = {};
+    in.getRaw(magic, sizeof magic);
+    if (!std::equal(magic, magic + 4, runMagic) || in.getVarint() != runVersion) {
+        return fail(path + " is not a run checkpoint");
+    }
+
+    QString loadedAlgorithm = QString::fromStdString(in.getString());
+    quint64 loadedSeed = in.getVarint();
+    EnsembleSettings loadedSettings;
+    loadedSettings.batteryLife = int(in.getSigned());
+    loadedSettings.vacuumEfficiency = int(in.getSigned());
+    loadedSettings.whiskerEfficiency = int(in.getSigned());
+    loadedSettings.speed = int(in.getSigned());
+    loadedSettings.plateauWindow = int(in.getSigned());
+    loadedSettings.plateauMinGain = in.getDouble();
+    uint8_t stuckAction = in.getByte();
+    if (stuckAction > uint8_t(StuckAction::Abort)) return fail(path + " is damaged");
+    loadedSettings.stuckAction = StuckAction(stuckAction);
+    PlateauDetector loadedPlateau(loadedSettings.plateauWindow, loadedSettings.plateauMinGain);
+    if (!loadedPlateau.load(in)) return fail(path + " is damaged");
+    std::vector<uint8_t> state = in.getBytes();
+    if (!in.ok()) return fail(path + " is damaged");
+
+    QByteArray blob(reinterpret_cast<const char*>(state.data()), int(state.size()));
+    if (!vacuum.restoreCheckpoint(blob)) {
+        return fail(path + " was saved on another plan or is damaged");
+    }
+
+    algorithm = loadedAlgorithm;
+    seed = loadedSeed;
+    settings = loadedSettings;
+    settings.strategyParams = vacuum.getStrategyParams();      // saved with the vacuum
+    plateau = loadedPlateau;
+    return true;
+}
+
+bool CheckpointedRun::save(const QString &path, QString *error) const
+{
+    ByteWriter out;
+    out.putRaw(runMagic, sizeof runMagic);
+    out.putVarint(runVersion);
+    out.putString(algorithm.toStdString());
+    out.putVarint(seed);
+    out.putSigned(settings.batteryLife);
+    out.putSigned(settings.vacuumEfficiency);
+    out.putSigned(settings.whiskerEfficiency);
+    out.putSigned(settings.speed);
+    out.putSigned(settings.plateauWindow);
+    out.putDouble(settings.plateauMinGain);
+    out.putByte(uint8_t(settings.stuckAction));
+    plateau.save(out);
+    const QByteArray state = vacuum.saveCheckpoint();
+    out.putBytes(reinterpret_cast<const uint8_t*>(state.constData()), size_t(state.size()));
+
+    // Written aside and renamed, so an interrupted save keeps the previous checkpoint
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly) ||
+        file.write(reinterpret_cast<const char*>(out.data().data()), qint64(out.size())) != qint64(out.size()) ||
+        !file.commit()) {
+        if (error) *error = "Cannot write " + path;
+        return false;
+    }
+    return true;
+}
+
+bool CheckpointedRun::step(int ticks, const CancellationToken &token)
+{
+    for (int i = 0; i < ticks && !isFinished(); i++) {
+        if (token.isCancelled()) return false;
+        vacuum.updateMovementandTrail(nullptr);
+        plateau.add(vacuum.getCoveredArea());
+    }
+    return !isFinished();
+}
+
+bool CheckpointedRun::isFinished() const
+{
+    return vacuum.isFinished() || plateau.hasPlateaued();
+}
+
+int CheckpointedRun::getTick() const
+{
+    return settings.batteryLife * 60 - vacuum.getBatteryLife();
+}
+
+EnsembleRunResult CheckpointedRun::getResult() const
+{
+    return EnsembleRunner::resultOf(vacuum, algorithm, seed, settings, plateau.getPlateauTime());
+}
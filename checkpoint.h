@@ -0,0 +1,44 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <QString>
+
+#include "ensemble.h"
+#include "plateau.h"
+
+class Vacuum;
+
+// One headless run that can be written to disk between ticks and picked up
+// again later, in this process or another: the CLI uses it to resume long
+// runs, and a saved file can be loaded several times to fork what-if
+// continuations without simulating the prefix again.
+//
+// The file holds the run settings, the plateau detector and a
+// Vacuum::saveCheckpoint blob, so a loaded run continues exactly as the
+// saved one would have.
+class CheckpointedRun
+{
+public:
+    explicit CheckpointedRun(Vacuum &vacuum);
+
+    void start(const QString &algorithm, quint64 seed, const EnsembleSettings &settings);
+    // Replaces the run with the saved one; the vacuum must have the same plan loaded
+    bool load(const QString &path, QString *error = nullptr);
+    bool save(const QString &path, QString *error = nullptr) const;
+
+    // Advances at most `ticks` ticks; false once the run is over
+    bool step(int ticks, const CancellationToken &token = CancellationToken());
+
+    bool isFinished() const;
+    int getTick() const;
+    EnsembleRunResult getResult() const;
+
+private:
+    Vacuum &vacuum;
+    QString algorithm;
+    quint64 seed = 0;
+    EnsembleSettings settings;
+    PlateauDetector plateau;
+};
+
+#endif // CHECKPOINT_H
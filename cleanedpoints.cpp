@@ -0,0 +1,101 @@
+#include "cleanedpoints.h"
+#include "bytestream.h"
+
+#include <algorithm>
+#include <cstring>
+
+void CleanedPoints::reset(double left, double top, double right, double bottom)
+{
+    originX = int(std::min(left, right)) - margin;
+    originY = int(std::min(top, bottom)) - margin;
+    width = int(std::max(left, right)) + margin - originX + 1;
+    height = int(std::max(top, bottom)) + margin - originY + 1;
+    blocked.resize(width, height);
+    count = 0;
+}
+
+bool CleanedPoints::add(double x, double y)
+{
+    int px = int(x), py = int(y);
+    if (px - reach < originX || px + reach >= originX + width ||
+        py - reach < originY || py + reach >= originY + height)
+        grow(px, py);
+
+    int ix = px - originX, iy = py - originY;
+    if (blocked.get(ix, iy)) return false;
+
+    // The block can straddle tiles; mark it one tile-row run at a time
+    for (int row = iy - reach; row <= iy + reach; row++) {
+        for (int col = ix - reach; col <= ix + reach; ) {
+            int length = std::min(ix + reach + 1, (col | TiledRaster<uint8_t>::tileMask) + 1) - col;
+            std::memset(blocked.writeRun(col, row), 1, size_t(length));
+            col += length;
+        }
+    }
+    count++;
+    return true;
+}
+
+void CleanedPoints::save(ByteWriter& out) const
+{
+    out.putSigned(originX);
+    out.putSigned(originY);
+    out.putVarint(uint64_t(width));
+    out.putVarint(uint64_t(height));
+    out.putVarint(uint64_t(count));
+    for (int iy = 0; iy < height; ++iy) {
+        for (int ix = 0, length = 0; ix < width; ix += length) {
+            const uint8_t* run = blocked.readRun(ix, iy, length);
+            out.putRaw(run, size_t(length));
+        }
+    }
+}
+
+bool CleanedPoints::load(ByteReader& in)
+{
+    int64_t x = in.getSigned();
+    int64_t y = in.getSigned();
+    uint64_t w = in.getVarint();
+    uint64_t h = in.getVarint();
+    uint64_t n = in.getVarint();
+    if (!in.ok() || w == 0 || h == 0 || w * h > in.size() || n > w * h) return false;
+
+    std::vector<uint8_t> loaded(size_t(w * h));
+    if (!in.getRaw(loaded.data(), loaded.size())) return false;
+
+    originX = int(x);
+    originY = int(y);
+    width = int(w);
+    height = int(h);
+    count = int(n);
+    blocked.resize(width, height);
+    for (int iy = 0; iy < height; ++iy) {
+        for (int ix = 0, length = 0; ix < width; ix += length) {
+            blocked.readRun(ix, iy, length);
+            const uint8_t* source = &loaded[size_t(iy) * width + ix];
+            if (std::all_of(source, source + length, [](uint8_t b) { return b == 0; })) continue;
+            std::memcpy(blocked.writeRun(ix, iy), source, size_t(length));
+        }
+    }
+    return true;
+}
+
+// Strategies can carry the vacuum outside every room; widen the mask by
+// whole tiles so the block around (px, py) fits, keeping what is already
+// marked and sharing its tiles
+void CleanedPoints::grow(int px, int py)
+{
+    const int tileSize = TiledRaster<uint8_t>::tileSize;
+    auto tilesFor = [&](int cells) { return cells > 0 ? (cells + tileSize - 1) / tileSize : 0; };
+
+    int left = tilesFor(originX - (px - reach - margin));
+    int top = tilesFor(originY - (py - reach - margin));
+    int right = tilesFor(px + reach + margin - (originX + blocked.getWidth() - 1));
+    int bottom = tilesFor(py + reach + margin - (originY + blocked.getHeight() - 1));
+
+    blocked.growTiles(left, top, right, bottom);
+    originX -= left * tileSize;
+    originY -= top * tileSize;
+    width = blocked.getWidth();
+    height = blocked.getHeight();
+}
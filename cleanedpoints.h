@@ -0,0 +1,43 @@
+#ifndef CLEANEDPOINTS_H
+#define CLEANEDPOINTS_H
+
+#include <cstdint>
+#include <vector>
+
+#include "tiledraster.h"
+
+class ByteWriter;
+class ByteReader;
+
+// The covered-area count SimWindow reports: a position is added as a cleaned
+// point unless an earlier point lies within 6 units of it on both axes (in
+// truncated integer coordinates). Instead of scanning every earlier point,
+// each added point marks the 13x13 block of integer positions it rules out,
+// so the test is a single lookup.
+class CleanedPoints
+{
+public:
+    void reset(double left, double top, double right, double bottom);
+
+    // Adds the point if no earlier one is close; returns whether it was added
+    bool add(double x, double y);
+    int size() const { return count; }
+
+    void save(ByteWriter& out) const;
+    bool load(ByteReader& in);
+
+private:
+    void grow(int px, int py);
+
+    static const int reach = 6;
+    static const int margin = 32;
+
+    TiledRaster<uint8_t> blocked;      // copy-on-write, so forked runs share it
+    int originX = 0;
+    int originY = 0;
+    int width = 0;
+    int height = 0;
+    int count = 0;
+};
+
+#endif // CLEANEDPOINTS_H
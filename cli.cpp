@@ -0,0 +1,650 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+
+#include <algorithm>
+#include <csignal>
+
+#include "checkpoint.h"
+#include "columnar.h"
+#include "ensemble.h"
+#include "experiment.h"
+#include "fleet.h"
+#include "mission.h"
+#include "resultcache.h"
+#include "tuner.h"
+#include "vacuum.h"
+#include "sweep.h"
+
+// Headless front end for batch work:
+//   robosim-cli sweep --plan house.json --battery 90:200:10 --speed 6:18:3 \
+//                     --algorithms "Random,Spiral" --seeds 20 --out results.rscf
+//   robosim-cli ensemble --plan house.json --seeds 200
+//   robosim-cli run experiment.json      (Ctrl-C, then run again to resume)
+//   robosim-cli dump results.rscf > results.csv
+//   robosim-cli simulate --plan house.json --algorithms Spiral --base-seed 7 \
+//                        --cache ~/.cache/robosim --trajectory spiral.rstj
+//   robosim-cli simulate --plan house.json --battery 200 --checkpoint long.rsck
+//                        (Ctrl-C, then the same command again to resume)
+//   robosim-cli cache --cache ~/.cache/robosim [--clear]
+//   robosim-cli tune --plan a.json,b.json --algorithms Spiral --generations 30 \
+//                    --out spiral-tuned.json
+//   robosim-cli ensemble --plan house.json --profile spiral-tuned.json
+//   robosim-cli ensemble --plan house.json --algorithms Spiral --spot
+//   robosim-cli fleet --plan house.json --robots 3 --algorithms Frontier --seeds 10 \
+//                     --partition
+//   robosim-cli mission --plan house.json --algorithms Frontier --seeds 20 \
+//                       --target 95 --recharge 90
+
+namespace {
+QTextStream out(stdout);
+QTextStream err(stderr);
+
+CancellationToken interrupted;
+
+void onInterrupt(int)
+{
+    interrupted.cancel();
+}
+
+void addRobotOptions(QCommandLineParser &parser)
+{
+    parser.addOption({"plan", "Floorplan JSON file.", "file"});
+    parser.addOption({"battery", "Battery life in minutes (90-200).", "values", "150"});
+    parser.addOption({"vacuum", "Vacuum efficiency (10-90).", "values", "90"});
+    parser.addOption({"whisker", "Whisker efficiency (10-50).", "values", "30"});
+    parser.addOption({"speed", "Speed in inches per second (6-18).", "values", "12"});
+    parser.addOption({"algorithms", "Comma separated algorithms.", "list", "Random,Snaking,Wall Follow,Spiral"});
+    parser.addOption({"seeds", "Seeds per combination.", "count", "1"});
+    parser.addOption({"base-seed", "First seed.", "seed", "1"});
+    parser.addOption({"threads", "Worker threads, 0 for all cores.", "count", "0"});
+    parser.addOption({"cache", "Result cache directory; runs found there are not simulated again.", "dir"});
+    parser.addOption({"cache-size", "Result cache size limit in MB.", "mb", "512"});
+    parser.addOption({"plateau-window", "Stop a run after this many seconds without progress, 0 never.", "seconds", "0"});
+    parser.addOption({"plateau-gain", "Coverage gain in sq. ft that counts as progress.", "sqft", "1"});
+    parser.addOption({"stuck", "When the vacuum is stuck or oscillating: report, recover or abort.", "action", "report"});
+    parser.addOption({"profile", "Tuned strategy profile to run with.", "file"});
+    parser.addOption({"spot", "Spiral spot cleans the worst under-cleaned pockets."});
+}
+
+bool readSpec(const QCommandLineParser &parser, SweepSpec &spec)
+{
+    QString error;
+    spec.housePath = parser.value("plan");
+    if (spec.housePath.isEmpty()) {
+        err << "--plan is required" << Qt::endl;
+        return false;
+    }
+    if (!SweepSpec::parseAxis(parser.value("battery"), 90, 200, spec.batteryLives, &error) ||
+        !SweepSpec::parseAxis(parser.value("vacuum"), 10, 90, spec.vacuumEfficiencies, &error) ||
+        !SweepSpec::parseAxis(parser.value("whisker"), 10, 50, spec.whiskerEfficiencies, &error) ||
+        !SweepSpec::parseAxis(parser.value("speed"), 6, 18, spec.speeds, &error)) {
+        err << error << Qt::endl;
+        return false;
+    }
+    spec.algorithms = parser.value("algorithms").split(',', Qt::SkipEmptyParts);
+    for (QString &algorithm : spec.algorithms) algorithm = algorithm.trimmed();
+    spec.seeds = parser.value("seeds").toInt();
+    spec.baseSeed = parser.value("base-seed").toULongLong();
+    spec.threadCount = parser.value("threads").toInt();
+    spec.cachePath = parser.value("cache");
+    spec.cacheMaxBytes = parser.value("cache-size").toLongLong() * 1024 * 1024;
+    spec.plateauWindow = parser.value("plateau-window").toInt();
+    spec.plateauMinGain = parser.value("plateau-gain").toDouble();
+    if (!stuckActionFromName(parser.value("stuck").toStdString(), spec.stuckAction)) {
+        err << "--stuck must be report, recover or abort" << Qt::endl;
+        return false;
+    }
+    if (spec.algorithms.isEmpty() || spec.seeds <= 0) {
+        err << "Need at least one algorithm and one seed" << Qt::endl;
+        return false;
+    }
+    if (parser.isSet("profile")) {
+        StrategyProfile profile;
+        if (!StrategyProfile::load(parser.value("profile"), profile, &error)) {
+            err << error << Qt::endl;
+            return false;
+        }
+        spec.strategyParams = profile.params;
+    }
+    if (parser.isSet("spot")) spec.strategyParams.spiral.spotCleaning = true;
+    return true;
+}
+
+int runSweep(const QStringList &arguments)
+{
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Run the Cartesian product of the given settings and write one row per run.");
+    parser.addHelpOption();
+    addRobotOptions(parser);
+    parser.addOption({"out", "Columnar results file.", "file", "sweep.rscf"});
+    parser.process(arguments);
+
+    SweepSpec spec;
+    if (!readSpec(parser, spec)) return 1;
+    spec.outputPath = parser.value("out");
+
+    err << "Running " << spec.getJobCount() << " jobs" << Qt::endl;
+    qint64 lastPercent = -1;
+    QString error;
+    SweepRunner runner;
+    bool ok = runner.run(spec, [&](qint64 done, qint64 total) {
+        qint64 percent = done * 100 / total;
+        if (percent != lastPercent) {
+            lastPercent = percent;
+            err << "\r" << done << "/" << total << Qt::flush;
+        }
+    }, &error);
+    err << Qt::endl;
+
+    if (!ok) {
+        err << error << Qt::endl;
+        return 1;
+    }
+    err << "Results written to " << spec.outputPath << Qt::endl;
+    return 0;
+}
+
+int runEnsemble(const QStringList &arguments)
+{
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Run many seeds per algorithm and print aggregate statistics.");
+    parser.addHelpOption();
+    addRobotOptions(parser);
+    parser.process(arguments);
+
+    SweepSpec spec;
+    if (!readSpec(parser, spec)) return 1;
+
+    EnsembleSettings settings;
+    settings.housePath = spec.housePath;
+    settings.algorithms = spec.algorithms;
+    settings.seedsPerAlgorithm = spec.seeds;
+    settings.baseSeed = spec.baseSeed;
+    settings.batteryLife = spec.batteryLives.first();
+    settings.vacuumEfficiency = spec.vacuumEfficiencies.first();
+    settings.whiskerEfficiency = spec.whiskerEfficiencies.first();
+    settings.speed = spec.speeds.first();
+    settings.threadCount = spec.threadCount;
+    settings.cachePath = spec.cachePath;
+    settings.cacheMaxBytes = spec.cacheMaxBytes;
+    settings.plateauWindow = spec.plateauWindow;
+    settings.plateauMinGain = spec.plateauMinGain;
+    settings.stuckAction = spec.stuckAction;
+    settings.strategyParams = spec.strategyParams;
+
+    EnsembleRunner runner;
+    if (!runner.start(settings)) return 1;
+    runner.wait();
+
+    out << "algorithm,metric,runs,mean,stddev,min,p10,median,p90,max" << Qt::endl;
+    for (const EnsembleSummary &summary : runner.getSummaries()) {
+        const QList<QPair<QString, const RunningStats*>> metrics = {
+            {"coverage", &summary.coverage},
+            {"runtime", &summary.runtime},
+            {"reclean_ratio", &summary.recleanRatio},
+            {"stuck_ticks", &summary.stuckTicks}
+        };
+        for (const auto &metric : metrics) {
+            const RunningStats &s = *metric.second;
+            out << summary.algorithm << "," << metric.first << "," << s.getCount() << ","
+                << s.getMean() << "," << s.getStdDev() << "," << s.getMin() << ","
+                << s.getQuantile(0.1) << "," << s.getMedian() << "," << s.getQuantile(0.9) << ","
+                << s.getMax() << Qt::endl;
+        }
+    }
+    return 0;
+}
+
+int runExperiment(const QStringList &arguments)
+{
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Run an experiment file, resuming from its journal.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("file", "Experiment JSON file.");
+    parser.process(arguments);
+    if (parser.positionalArguments().isEmpty()) {
+        parser.showHelp(1);
+    }
+
+    ExperimentSpec spec;
+    QString error;
+    if (!ExperimentSpec::load(parser.positionalArguments().first(), spec, &error)) {
+        err << error << Qt::endl;
+        return 1;
+    }
+
+    std::signal(SIGINT, onInterrupt);
+
+    ExperimentRunner runner;
+    qint64 lastPercent = -1;
+    bool ok = runner.run(spec, [&](qint64 done, qint64 total) {
+        qint64 percent = done * 100 / total;
+        if (percent != lastPercent) {
+            lastPercent = percent;
+            err << "\r" << spec.name << ": " << done << "/" << total << Qt::flush;
+        }
+    }, interrupted, &error);
+    err << Qt::endl;
+
+    if (runner.getSkipped() > 0) {
+        err << "Resumed, skipped " << runner.getSkipped() << " finished jobs" << Qt::endl;
+    }
+    if (!ok) {
+        err << error << Qt::endl;
+        return interrupted.isCancelled() ? 130 : 1;
+    }
+    err << "Results written to " << spec.resultsPath << Qt::endl;
+    return 0;
+}
+
+void printRun(const EnsembleRunResult &result, int visitedCells)
+{
+    const StuckTelemetry &stuck = result.stuck;
+    out << "algorithm,seed,coverage,runtime,reclean_ratio,plateau_time,stuck_events,oscillation_events,"
+           "stuck_ticks,stuck_recoveries,stuck_aborted,visited_cells" << Qt::endl;
+    out << result.algorithm << "," << result.seed << "," << result.coverage << ","
+        << result.runtime << "," << result.recleanRatio << "," << result.plateauTime << ","
+        << stuck.stuckEvents << "," << stuck.oscillationEvents << "," << stuck.stuckTicks << ","
+        << stuck.recoveries << "," << int(stuck.aborted) << "," << visitedCells << Qt::endl;
+}
+
+// A run saved to the checkpoint file every `interval` simulated seconds and
+// on Ctrl-C. An existing checkpoint is resumed, with the settings it was
+// started with; it is removed once the run is over.
+int runCheckpointed(const SweepSpec &spec, const EnsembleSettings &settings, const QString &path, int interval)
+{
+    Vacuum vacuum(nullptr);
+    QString housePath = spec.housePath;
+    vacuum.setHousePath(housePath);
+    CheckpointedRun run(vacuum);
+
+    QString error;
+    if (QFile::exists(path)) {
+        if (!run.load(path, &error)) {
+            err << error << Qt::endl;
+            return 1;
+        }
+        err << "Resuming " << path << " at " << run.getTick() << " s" << Qt::endl;
+    } else {
+        run.start(spec.algorithms.first(), spec.baseSeed, settings);
+    }
+
+    std::signal(SIGINT, onInterrupt);
+    while (run.step(interval, interrupted)) {
+        if (!run.save(path, &error)) {
+            err << error << Qt::endl;
+            return 1;
+        }
+    }
+    if (interrupted.isCancelled()) {
+        if (!run.save(path, &error)) {
+            err << error << Qt::endl;
+            return 1;
+        }
+        err << "Interrupted at " << run.getTick() << " s; rerun to resume" << Qt::endl;
+        return 130;
+    }
+
+    QFile::remove(path);
+    printRun(run.getResult(), vacuum.getVisitGrid().getVisitedCells());
+    return 0;
+}
+
+// One run of the first algorithm with the base seed, through the cache
+int runSimulate(const QStringList &arguments)
+{
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Run one simulation, or fetch it from the result cache.");
+    parser.addHelpOption();
+    addRobotOptions(parser);
+    parser.addOption({"trajectory", "Write the run's trajectory for replay.", "file"});
+    parser.addOption({"checkpoint", "Save the run here as it goes and resume from it; bypasses the cache.", "file"});
+    parser.addOption({"checkpoint-every", "Simulated seconds between checkpoints.", "seconds", "600"});
+    parser.process(arguments);
+
+    SweepSpec spec;
+    if (!readSpec(parser, spec)) return 1;
+
+    EnsembleSettings settings;
+    settings.batteryLife = spec.batteryLives.first();
+    settings.vacuumEfficiency = spec.vacuumEfficiencies.first();
+    settings.whiskerEfficiency = spec.whiskerEfficiencies.first();
+    settings.speed = spec.speeds.first();
+    settings.plateauWindow = spec.plateauWindow;
+    settings.plateauMinGain = spec.plateauMinGain;
+    settings.stuckAction = spec.stuckAction;
+    settings.strategyParams = spec.strategyParams;
+
+    const QString trajectoryPath = parser.value("trajectory");
+    const QString checkpointPath = parser.value("checkpoint");
+    if (!checkpointPath.isEmpty()) {
+        if (!trajectoryPath.isEmpty()) {
+            err << "--trajectory cannot be combined with --checkpoint" << Qt::endl;
+            return 1;
+        }
+        return runCheckpointed(spec, settings, checkpointPath, std::max(1, parser.value("checkpoint-every").toInt()));
+    }
+
+    std::unique_ptr<ResultCache> cache;
+    if (!spec.cachePath.isEmpty()) cache = std::make_unique<ResultCache>(spec.cachePath, spec.cacheMaxBytes);
+
+    Vacuum vacuum(nullptr);
+    vacuum.setHousePath(spec.housePath);
+    CachedRun run;
+    EnsembleRunner::recordCached(vacuum, spec.algorithms.first(), spec.baseSeed, settings, cache.get(), run);
+
+    printRun(run.metrics, run.coverage.getVisitedCells());
+
+    if (!trajectoryPath.isEmpty()) {
+        QFile file(trajectoryPath);
+        if (!file.open(QIODevice::WriteOnly)) {
+            err << "Cannot write " << trajectoryPath << Qt::endl;
+            return 1;
+        }
+        file.write(reinterpret_cast<const char*>(run.trajectory.data()), qint64(run.trajectory.size()));
+    }
+    return 0;
+}
+
+// Tunes the first algorithm's parameters on one or more plans and writes
+// the profile; --seeds is the runs per candidate and plan in a generation
+int runTune(const QStringList &arguments)
+{
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Tune a strategy's parameters for coverage per battery minute.");
+    parser.addHelpOption();
+    addRobotOptions(parser);
+    parser.addOption({"generations", "CMA-ES generations.", "count", "20"});
+    parser.addOption({"population", "Candidates per generation, 0 to size it from the parameters.", "count", "0"});
+    parser.addOption({"validation-seeds", "Seeds per plan for the final comparison.", "count", "16"});
+    parser.addOption({"search-seed", "Seed of the search itself.", "seed", "1"});
+    parser.addOption({"name", "Profile name.", "name"});
+    parser.addOption({"out", "Profile file.", "file", "profile.json"});
+    parser.process(arguments);
+
+    SweepSpec spec;
+    if (!readSpec(parser, spec)) return 1;
+
+    TunerSettings settings;
+    settings.plans = spec.housePath.split(',', Qt::SkipEmptyParts);
+    for (QString &plan : settings.plans) plan = plan.trimmed();
+    settings.algorithm = spec.algorithms.first();
+    settings.robot.batteryLife = spec.batteryLives.first();
+    settings.robot.vacuumEfficiency = spec.vacuumEfficiencies.first();
+    settings.robot.whiskerEfficiency = spec.whiskerEfficiencies.first();
+    settings.robot.speed = spec.speeds.first();
+    settings.robot.plateauWindow = spec.plateauWindow;
+    settings.robot.plateauMinGain = spec.plateauMinGain;
+    settings.robot.stuckAction = spec.stuckAction;
+    settings.robot.strategyParams = spec.strategyParams;
+    settings.generations = parser.value("generations").toInt();
+    settings.population = parser.value("population").toInt();
+    settings.seedsPerPlan = spec.seeds;
+    settings.validationSeeds = parser.value("validation-seeds").toInt();
+    settings.baseSeed = spec.baseSeed;
+    settings.searchSeed = parser.value("search-seed").toULongLong();
+    settings.threadCount = spec.threadCount;
+
+    std::signal(SIGINT, onInterrupt);
+
+    StrategyProfile profile;
+    QString error;
+    ParameterTuner tuner;
+    bool ok = tuner.run(settings, profile, [&](const TunerProgress &progress) {
+        err << "generation " << progress.generation << "/" << settings.generations
+            << ": best " << progress.bestScore << ", mean " << progress.meanScore
+            << ", step " << progress.stepSize << Qt::endl;
+    }, interrupted, &error);
+    if (!ok) {
+        err << error << Qt::endl;
+        return interrupted.isCancelled() ? 130 : 1;
+    }
+
+    profile.name = parser.value("name");
+    if (profile.name.isEmpty()) profile.name = QFileInfo(parser.value("out")).completeBaseName();
+    if (!profile.save(parser.value("out"), &error)) {
+        err << error << Qt::endl;
+        return 1;
+    }
+    err << "Validation: " << profile.score << " sq. ft per battery minute, starting parameters "
+        << profile.baselineScore << Qt::endl;
+    out << QJsonDocument(profile.params.toJson()).toJson();
+    out.flush();
+    return 0;
+}
+
+// K robots cleaning one plan together, one row per robot and one for the
+// fleet for every algorithm and seed
+int runFleet(const QStringList &arguments)
+{
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Run several vacuums together in one plan.");
+    parser.addHelpOption();
+    addRobotOptions(parser);
+    parser.addOption({"robots", "Vacuums in the plan.", "count", "2"});
+    parser.addOption({"partition", "Split the rooms among the vacuums."});
+    parser.process(arguments);
+
+    SweepSpec spec;
+    if (!readSpec(parser, spec)) return 1;
+    const int robotCount = parser.value("robots").toInt();
+    if (robotCount <= 0) {
+        err << "--robots must be at least 1" << Qt::endl;
+        return 1;
+    }
+    if (spec.plateauWindow > 0) err << "--plateau-window is ignored in fleet runs" << Qt::endl;
+
+    EnsembleSettings settings;
+    settings.batteryLife = spec.batteryLives.first();
+    settings.vacuumEfficiency = spec.vacuumEfficiencies.first();
+    settings.whiskerEfficiency = spec.whiskerEfficiencies.first();
+    settings.speed = spec.speeds.first();
+    settings.stuckAction = spec.stuckAction;
+    settings.strategyParams = spec.strategyParams;
+
+    Fleet fleet(spec.threadCount);
+    if (!fleet.load(spec.housePath, robotCount)) {
+        err << "Cannot load " << spec.housePath << Qt::endl;
+        return 1;
+    }
+    fleet.setPartitioned(parser.isSet("partition"));
+
+    std::signal(SIGINT, onInterrupt);
+
+    out << "algorithm,seed,robot,coverage,runtime,reclean_ratio,robot_contacts,stuck_ticks,idle_ticks,rooms"
+        << Qt::endl;
+    for (const QString &algorithm : spec.algorithms) {
+        for (int i = 0; i < spec.seeds; i++) {
+            const quint64 seed = spec.baseSeed + quint64(i);
+            const FleetResult result = fleet.run(algorithm, seed, settings, interrupted);
+            if (interrupted.isCancelled()) return 130;
+            int stuckTicks = 0;
+            int idleTicks = 0;
+            for (int robot = 0; robot < int(result.robots.size()); robot++) {
+                const FleetRobotResult &r = result.robots[robot];
+                QStringList rooms;
+                for (int room : r.rooms) rooms << QString::number(room);
+                out << algorithm << "," << seed << "," << robot << "," << r.coverage << ","
+                    << result.runtime << ",," << r.robotContacts << "," << r.stuck.stuckTicks << ","
+                    << r.idleTicks << "," << rooms.join(' ') << Qt::endl;
+                stuckTicks += r.stuck.stuckTicks;
+                idleTicks += r.idleTicks;
+            }
+            out << algorithm << "," << seed << ",all," << result.coverage << "," << result.runtime << ","
+                << result.recleanRatio << "," << result.robotContacts << "," << stuckTicks << ","
+                << idleTicks << "," << Qt::endl;
+        }
+    }
+    return 0;
+}
+
+// Multi-charge missions to a coverage target, one row per algorithm and
+// seed, then the median time to the target per algorithm
+int runMission(const QStringList &arguments)
+{
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Clean over several charges, returning to the dock, until a coverage target.");
+    parser.addHelpOption();
+    addRobotOptions(parser);
+    parser.addOption({"target", "Percent of the open floor that completes the mission.", "percent", "90"});
+    parser.addOption({"reserve", "Seconds of battery kept over the way home.", "seconds", "60"});
+    parser.addOption({"recharge", "Minutes on the dock between charges.", "minutes", "120"});
+    parser.addOption({"max-charges", "Batteries a mission may use.", "count", "5"});
+    parser.process(arguments);
+
+    SweepSpec spec;
+    if (!readSpec(parser, spec)) return 1;
+    if (spec.plateauWindow > 0) err << "--plateau-window is ignored in missions" << Qt::endl;
+
+    MissionSettings settings;
+    settings.robot.housePath = spec.housePath;
+    settings.robot.algorithms = spec.algorithms;
+    settings.robot.seedsPerAlgorithm = spec.seeds;
+    settings.robot.baseSeed = spec.baseSeed;
+    settings.robot.batteryLife = spec.batteryLives.first();
+    settings.robot.vacuumEfficiency = spec.vacuumEfficiencies.first();
+    settings.robot.whiskerEfficiency = spec.whiskerEfficiencies.first();
+    settings.robot.speed = spec.speeds.first();
+    settings.robot.threadCount = spec.threadCount;
+    settings.robot.stuckAction = spec.stuckAction;
+    settings.robot.strategyParams = spec.strategyParams;
+    settings.targetCoverage = parser.value("target").toDouble() / 100.0;
+    settings.reserveSeconds = parser.value("reserve").toInt();
+    settings.rechargeMinutes = parser.value("recharge").toInt();
+    settings.maxCharges = parser.value("max-charges").toInt();
+    if (!(settings.targetCoverage > 0.0 && settings.targetCoverage <= 1.0)) {
+        err << "--target must be in (0, 100]" << Qt::endl;
+        return 1;
+    }
+    if (settings.maxCharges <= 0) {
+        err << "--max-charges must be at least 1" << Qt::endl;
+        return 1;
+    }
+    if (settings.reserveSeconds < 0) {
+        err << "--reserve cannot be negative" << Qt::endl;
+        return 1;
+    }
+    if (settings.rechargeMinutes < 0) {
+        err << "--recharge cannot be negative" << Qt::endl;
+        return 1;
+    }
+
+    std::signal(SIGINT, onInterrupt);
+    const std::vector<MissionResult> results = MissionRunner::runAll(settings, interrupted);
+    if (interrupted.isCancelled()) return 130;
+
+    out << "algorithm,seed,charges,mission_time,time_to_target,floor_coverage,coverage,docked" << Qt::endl;
+    for (const MissionResult &r : results) {
+        out << r.algorithm << "," << r.seed << "," << r.charges << "," << r.missionTime << ","
+            << r.timeToTarget << "," << r.floorCoverage << "," << r.coverage << "," << (r.docked ? 1 : 0) << Qt::endl;
+    }
+    for (const QString &algorithm : spec.algorithms) {
+        RunningStats times;
+        int missions = 0;
+        for (const MissionResult &r : results) {
+            if (r.algorithm != algorithm) continue;
+            missions++;
+            if (r.timeToTarget >= 0) times.add(r.timeToTarget);
+        }
+        err << algorithm << ": " << times.getCount() << "/" << missions << " reached "
+            << parser.value("target") << "%";
+        if (times.getCount() > 0) err << ", median " << times.getMedian() / 60.0 << " min";
+        err << Qt::endl;
+    }
+    return 0;
+}
+
+int runCache(const QStringList &arguments)
+{
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Show or clear a result cache.");
+    parser.addHelpOption();
+    parser.addOption({"cache", "Result cache directory.", "dir", ResultCache::defaultDirectory()});
+    parser.addOption({"clear", "Delete every cached run."});
+    parser.process(arguments);
+
+    ResultCache cache(parser.value("cache"));
+    if (parser.isSet("clear")) cache.clear();
+    out << cache.getDirectory() << ": " << cache.getEntryCount() << " runs, "
+        << cache.getSize() / 1024 << " KB" << Qt::endl;
+    return 0;
+}
+
+// Prints a columnar results file as CSV, algorithm indices resolved to names
+int runDump(const QStringList &arguments)
+{
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Print a results file as CSV.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("file", "Columnar results file.");
+    parser.process(arguments);
+    if (parser.positionalArguments().isEmpty()) {
+        parser.showHelp(1);
+    }
+
+    const QString path = parser.positionalArguments().first();
+    ColumnarReader reader;
+    if (!reader.open(path.toStdString())) {
+        err << "Cannot read " << path << Qt::endl;
+        return 1;
+    }
+
+    QJsonObject metadata = QJsonDocument::fromJson(QByteArray::fromStdString(reader.getMetadata())).object();
+    QJsonArray algorithms = metadata["algorithms"].toArray();
+    const int algorithmColumn = reader.findColumn("algorithm");
+
+    const std::vector<ColumnInfo> &columns = reader.getColumns();
+    for (size_t i = 0; i < columns.size(); i++) {
+        out << (i ? "," : "") << QString::fromStdString(columns[i].name);
+    }
+    out << Qt::endl;
+
+    ColumnarRowGroup group;
+    while (reader.nextRowGroup(group)) {
+        for (size_t row = 0; row < group.rowCount; row++) {
+            for (size_t i = 0; i < columns.size(); i++) {
+                if (i) out << ",";
+                if (columns[i].type == ColumnType::Double) {
+                    out << group.doubles[i][row];
+                } else if (int(i) == algorithmColumn && group.ints[i][row] < algorithms.size()) {
+                    out << algorithms[int(group.ints[i][row])].toString();
+                } else {
+                    out << group.ints[i][row];
+                }
+            }
+            out << "\n";
+        }
+    }
+    out.flush();
+    return 0;
+}
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("robosim-cli");
+
+    QStringList arguments = app.arguments();
+    QString command = arguments.size() > 1 ? arguments[1] : QString();
+    if (arguments.size() > 1) arguments.removeAt(1);
+
+    if (command == "sweep") return runSweep(arguments);
+    if (command == "ensemble") return runEnsemble(arguments);
+    if (command == "run") return runExperiment(arguments);
+    if (command == "dump") return runDump(arguments);
+    if (command == "simulate") return runSimulate(arguments);
+    if (command == "cache") return runCache(arguments);
+    if (command == "tune") return runTune(arguments);
+    if (command == "fleet") return runFleet(arguments);
+    if (command == "mission") return runMission(arguments);
+
+    err << "Usage: robosim-cli <sweep|ensemble|run|dump|simulate|cache|tune|fleet|mission> [options]" << Qt::endl;
+    return 1;
+}
@@ -0,0 +1,137 @@
+#include "colormap.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+// The gather pass is compiled for AVX2 on its own and picked at run time,
+// so builds without -mavx2 still use it on CPUs that have it
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define COLORMAP_AVX2_DISPATCH 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+struct ColorStop
+{
+    double t;
+    int r, g, b;
+};
+
+// Nine evenly spaced stops sampled from the matplotlib maps
+const ColorStop viridisStops[] = {
+    {0.000,  68,   1,  84}, {0.125,  71,  44, 122}, {0.250,  59,  81, 139},
+    {0.375,  44, 113, 142}, {0.500,  33, 144, 141}, {0.625,  39, 173, 129},
+    {0.750,  92, 200,  99}, {0.875, 170, 220,  50}, {1.000, 253, 231,  37},
+};
+
+const ColorStop infernoStops[] = {
+    {0.000,   0,   0,   4}, {0.125,  31,  12,  72}, {0.250,  85,  15, 109},
+    {0.375, 136,  34, 106}, {0.500, 186,  54,  85}, {0.625, 227,  89,  51},
+    {0.750, 249, 140,  10}, {0.875, 249, 201,  50}, {1.000, 252, 255, 164},
+};
+
+uint32_t packArgb(int a, int r, int g, int b)
+{
+    return (uint32_t(a) << 24) | (uint32_t(r) << 16) | (uint32_t(g) << 8) | uint32_t(b);
+}
+
+#ifdef COLORMAP_AVX2_DISPATCH
+bool hasAvx2()
+{
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+}
+
+// Maps whole blocks of sixteen cells; returns how many cells it mapped
+__attribute__((target("avx2")))
+size_t mapCountsAvx2(const uint16_t* counts, size_t n, const uint32_t* table, uint16_t maxCount, uint32_t* out)
+{
+    const __m256i limit = _mm256_set1_epi16(short(maxCount));
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(counts + i));
+        c = _mm256_min_epu16(c, limit);
+
+        __m256i lo = _mm256_cvtepu16_epi32(_mm256_castsi256_si128(c));
+        __m256i hi = _mm256_cvtepu16_epi32(_mm256_extracti128_si256(c, 1));
+        __m256i colorsLo = _mm256_i32gather_epi32(reinterpret_cast<const int*>(table), lo, 4);
+        __m256i colorsHi = _mm256_i32gather_epi32(reinterpret_cast<const int*>(table), hi, 4);
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), colorsLo);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i + 8), colorsHi);
+    }
+    return i;
+}
+#endif
+
+}
+
+ColorLut buildColorLut(ColorMap map)
+{
+    const ColorStop* stops = map == ColorMap::Inferno ? infernoStops : viridisStops;
+    const int numStops = 9;
+
+    ColorLut lut;
+    for (int i = 0; i < 256; ++i) {
+        double t = i / 255.0;
+        int s = std::min(numStops - 2, int(t * (numStops - 1)));
+        double f = (t - stops[s].t) / (stops[s + 1].t - stops[s].t);
+
+        int r = int(std::lround(stops[s].r + f * (stops[s + 1].r - stops[s].r)));
+        int g = int(std::lround(stops[s].g + f * (stops[s + 1].g - stops[s].g)));
+        int b = int(std::lround(stops[s].b + f * (stops[s + 1].b - stops[s].b)));
+        lut[i] = packArgb(255, r, g, b);
+    }
+    return lut;
+}
+
+void buildCountLut(const ColorLut& lut, uint16_t maxCount, std::vector<uint32_t>& countLut)
+{
+    countLut.resize(size_t(maxCount) + 1);
+    countLut[0] = 0;
+    for (int c = 1; c <= maxCount; ++c) {
+        int index = maxCount > 1 ? (c - 1) * 255 / (maxCount - 1) : 255;
+        countLut[c] = lut[index];
+    }
+}
+
+void mapCountsToArgb(const uint16_t* counts, size_t n, const std::vector<uint32_t>& countLut, uint32_t* out)
+{
+    if (countLut.empty()) return;
+
+    const uint32_t* table = countLut.data();
+    const uint16_t maxCount = uint16_t(countLut.size() - 1);
+    size_t i = 0;
+
+#ifdef COLORMAP_AVX2_DISPATCH
+    if (hasAvx2()) i = mapCountsAvx2(counts, n, table, maxCount, out);
+#endif
+#if defined(__SSE2__) || defined(_M_X64)
+    // SSE2 has no unsigned 16-bit min, so use c - max(c - limit, 0)
+    const __m128i limit = _mm_set1_epi16(short(maxCount));
+    alignas(16) uint16_t clamped[8];
+    for (; i + 8 <= n; i += 8) {
+        __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(counts + i));
+        c = _mm_sub_epi16(c, _mm_subs_epu16(c, limit));
+        _mm_store_si128(reinterpret_cast<__m128i*>(clamped), c);
+
+        out[i + 0] = table[clamped[0]];
+        out[i + 1] = table[clamped[1]];
+        out[i + 2] = table[clamped[2]];
+        out[i + 3] = table[clamped[3]];
+        out[i + 4] = table[clamped[4]];
+        out[i + 5] = table[clamped[5]];
+        out[i + 6] = table[clamped[6]];
+        out[i + 7] = table[clamped[7]];
+    }
+#endif
+
+    for (; i < n; ++i) {
+        out[i] = table[std::min(counts[i], maxCount)];
+    }
+}
@@ -0,0 +1,31 @@
+#ifndef COLORMAP_H
+#define COLORMAP_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Perceptual colour maps for the visit-density heatmap. Colours are packed
+// as 0xAARRGGBB, the same layout as QRgb / QImage::Format_ARGB32.
+enum class ColorMap
+{
+    Viridis,
+    Inferno
+};
+
+using ColorLut = std::array<uint32_t, 256>;
+
+// 256 opaque samples of the colour map from low (index 0) to high (255)
+ColorLut buildColorLut(ColorMap map);
+
+// Table indexed directly by visit count 0..maxCount. Count 0 is transparent,
+// 1..maxCount are spread linearly over the colour LUT.
+void buildCountLut(const ColorLut& lut, uint16_t maxCount, std::vector<uint32_t>& countLut);
+
+// out[i] = countLut[min(counts[i], maxCount)] for n cells, sixteen at a
+// time with an AVX2 gather on CPUs that have it (checked at run time), else
+// clamped eight at a time with SSE2 and looked up one by one.
+void mapCountsToArgb(const uint16_t* counts, size_t n, const std::vector<uint32_t>& countLut, uint32_t* out);
+
+#endif // COLORMAP_H
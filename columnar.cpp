@@ -0,0 +1,302 @@
+#include "columnar.h"
+#include "bytestream.h"
+
+#include <filesystem>
+
+namespace {
+const char magic[4] = {'R', 'S', 'C', 'F'};
+const uint64_t formatVersion = 1;
+
+bool writeAll(std::FILE* file, const std::vector<uint8_t>& bytes)
+{
+    return std::fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+}
+
+// Varint straight from the file, for the header and group prefixes
+bool readVarint(std::FILE* file, uint64_t& value)
+{
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        int c = std::fgetc(file);
+        if (c == EOF) return false;
+        value |= uint64_t(c & 0x7F) << shift;
+        if (!(c & 0x80)) return true;
+    }
+    return false;
+}
+
+bool readBytes(std::FILE* file, std::vector<uint8_t>& bytes, size_t size)
+{
+    bytes.resize(size);
+    return std::fread(bytes.data(), 1, size, file) == size;
+}
+}
+
+ColumnarWriter::ColumnarWriter(size_t rowGroupSize)
+    : rowGroupSize(rowGroupSize > 0 ? rowGroupSize : 1)
+{
+}
+
+ColumnarWriter::~ColumnarWriter()
+{
+    close();
+}
+
+bool ColumnarWriter::open(const std::string& path, const std::vector<ColumnInfo>& newColumns, const std::string& metadata)
+{
+    close();
+    file = std::fopen(path.c_str(), "wb");
+    if (!file) return false;
+
+    columns = newColumns;
+    resetBuffers();
+
+    ByteWriter header;
+    header.putRaw(magic, sizeof magic);
+    header.putVarint(formatVersion);
+    header.putString(metadata);
+    header.putVarint(columns.size());
+    for (const ColumnInfo& column : columns) {
+        header.putString(column.name);
+        header.putByte(uint8_t(column.type));
+    }
+    if (!writeAll(file, header.data())) {
+        close();
+        return false;
+    }
+    std::fflush(file);
+    return true;
+}
+
+bool ColumnarWriter::openAppend(const std::string& path, const std::vector<ColumnInfo>& newColumns, const std::string& metadata)
+{
+    close();
+
+    std::error_code ec;
+    if (!std::filesystem::exists(path, ec)) return open(path, newColumns, metadata);
+
+    size_t existingCount = 0;
+    {
+        ColumnarReader reader;
+        if (!reader.open(path)) return false;
+
+        const std::vector<ColumnInfo>& existing = reader.getColumns();
+        if (existing.size() > newColumns.size()) return false;
+        for (size_t i = 0; i < existing.size(); i++) {
+            if (existing[i].name != newColumns[i].name || existing[i].type != newColumns[i].type) return false;
+        }
+        existingCount = existing.size();
+    }
+    if (existingCount < newColumns.size() && !addColumns(path, newColumns)) return false;
+
+    long validEnd = 0;
+    {
+        ColumnarReader reader;
+        if (!reader.open(path)) return false;
+        validEnd = reader.getOffset();
+        ColumnarRowGroup skipped;
+        while (reader.nextRowGroup(skipped)) validEnd = reader.getOffset();
+    }
+
+    std::filesystem::resize_file(path, uintmax_t(validEnd), ec);
+    if (ec) return false;
+
+    file = std::fopen(path.c_str(), "ab");
+    if (!file) return false;
+    columns = newColumns;
+    resetBuffers();
+    return true;
+}
+
+// Copies the complete row groups into a file with the new header, then
+// moves it over the old one, so a crash midway leaves the old file intact
+bool ColumnarWriter::addColumns(const std::string& path, const std::vector<ColumnInfo>& newColumns)
+{
+    const std::string upgraded = path + ".upgrade";
+    {
+        ColumnarReader reader;
+        if (!reader.open(path)) return false;
+        const size_t existingCount = reader.getColumns().size();
+
+        ColumnarWriter writer;
+        if (!writer.open(upgraded, newColumns, reader.getMetadata())) return false;
+        ColumnarRowGroup rows;
+        while (reader.nextRowGroup(rows)) {
+            rows.ints.resize(newColumns.size());
+            rows.doubles.resize(newColumns.size());
+            for (size_t i = existingCount; i < newColumns.size(); i++) {
+                if (newColumns[i].type == ColumnType::Int64) {
+                    rows.ints[i].assign(rows.rowCount, int64_t(newColumns[i].fill));
+                } else {
+                    rows.doubles[i].assign(rows.rowCount, newColumns[i].fill);
+                }
+            }
+            writer.group = std::move(rows);
+            if (!writer.flush()) return false;
+        }
+        writer.close();
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(upgraded, path, ec);
+    return !ec;
+}
+
+void ColumnarWriter::resetBuffers()
+{
+    group = ColumnarRowGroup();
+    group.ints.resize(columns.size());
+    group.doubles.resize(columns.size());
+    rowInts.assign(columns.size(), 0);
+    rowDoubles.assign(columns.size(), 0.0);
+}
+
+void ColumnarWriter::close()
+{
+    if (!file) return;
+    flush();
+    std::fclose(file);
+    file = nullptr;
+}
+
+void ColumnarWriter::setInt(int column, int64_t value)
+{
+    rowInts[column] = value;
+}
+
+void ColumnarWriter::setDouble(int column, double value)
+{
+    rowDoubles[column] = value;
+}
+
+void ColumnarWriter::commitRow()
+{
+    for (size_t i = 0; i < columns.size(); i++) {
+        if (columns[i].type == ColumnType::Int64) group.ints[i].push_back(rowInts[i]);
+        else group.doubles[i].push_back(rowDoubles[i]);
+    }
+    group.rowCount++;
+    if (group.rowCount >= rowGroupSize) flush();
+}
+
+bool ColumnarWriter::flush()
+{
+    if (!file || group.rowCount == 0) return true;
+
+    ByteWriter body;
+    for (size_t i = 0; i < columns.size(); i++) {
+        if (columns[i].type == ColumnType::Int64) {
+            for (int64_t value : group.ints[i]) body.putSigned(value);
+            group.ints[i].clear();
+        } else {
+            for (double value : group.doubles[i]) body.putDouble(value);
+            group.doubles[i].clear();
+        }
+    }
+
+    ByteWriter prefix;
+    prefix.putVarint(body.size());
+    prefix.putVarint(group.rowCount);
+    group.rowCount = 0;
+
+    bool ok = writeAll(file, prefix.data()) && writeAll(file, body.data());
+    std::fflush(file);
+    return ok;
+}
+
+ColumnarReader::~ColumnarReader()
+{
+    close();
+}
+
+bool ColumnarReader::open(const std::string& path)
+{
+    close();
+    file = std::fopen(path.c_str(), "rb");
+    if (!file) return false;
+
+    char fileMagic[4];
+    uint64_t version = 0;
+    if (std::fread(fileMagic, 1, 4, file) != 4 || std::memcmp(fileMagic, magic, 4) != 0 ||
+        !readVarint(file, version) || version != formatVersion) {
+        close();
+        return false;
+    }
+
+    uint64_t size = 0;
+    std::vector<uint8_t> bytes;
+    if (!readVarint(file, size) || !readBytes(file, bytes, size)) {
+        close();
+        return false;
+    }
+    metadata.assign(bytes.begin(), bytes.end());
+
+    uint64_t columnCount = 0;
+    if (!readVarint(file, columnCount)) {
+        close();
+        return false;
+    }
+    columns.clear();
+    for (uint64_t i = 0; i < columnCount; i++) {
+        ColumnInfo column;
+        if (!readVarint(file, size) || !readBytes(file, bytes, size)) {
+            close();
+            return false;
+        }
+        column.name.assign(bytes.begin(), bytes.end());
+        int type = std::fgetc(file);
+        if (type == EOF) {
+            close();
+            return false;
+        }
+        column.type = ColumnType(type);
+        columns.push_back(column);
+    }
+    return true;
+}
+
+void ColumnarReader::close()
+{
+    if (file) std::fclose(file);
+    file = nullptr;
+}
+
+long ColumnarReader::getOffset() const
+{
+    return file ? std::ftell(file) : 0;
+}
+
+int ColumnarReader::findColumn(const std::string& name) const
+{
+    for (size_t i = 0; i < columns.size(); i++) {
+        if (columns[i].name == name) return int(i);
+    }
+    return -1;
+}
+
+bool ColumnarReader::nextRowGroup(ColumnarRowGroup& group)
+{
+    if (!file) return false;
+
+    uint64_t size = 0, rows = 0;
+    std::vector<uint8_t> body;
+    if (!readVarint(file, size) || !readVarint(file, rows) || !readBytes(file, body, size)) {
+        return false;
+    }
+
+    group.rowCount = rows;
+    group.ints.assign(columns.size(), {});
+    group.doubles.assign(columns.size(), {});
+
+    ByteReader in(body);
+    for (size_t i = 0; i < columns.size(); i++) {
+        if (columns[i].type == ColumnType::Int64) {
+            group.ints[i].resize(rows);
+            for (uint64_t r = 0; r < rows; r++) group.ints[i][r] = in.getSigned();
+        } else {
+            group.doubles[i].resize(rows);
+            for (uint64_t r = 0; r < rows; r++) group.doubles[i][r] = in.getDouble();
+        }
+    }
+    return in.ok();
+}
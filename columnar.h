@@ -0,0 +1,100 @@
+#ifndef COLUMNAR_H
+#define COLUMNAR_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Column-oriented results file for sweeps.
+//
+// Header: "RSCF" magic, format version, a free-form metadata string (the
+// sweep writes JSON there) and the column names and types. The body is a
+// sequence of row groups, each prefixed with its byte length and row count
+// and holding every column of those rows contiguously: integer columns as
+// zigzag varints, double columns as raw little-endian 8 byte values.
+// Row groups are written whole and flushed, so a file cut short by a crash
+// loses at most the group being written.
+enum class ColumnType : uint8_t
+{
+    Int64 = 0,
+    Double = 1
+};
+
+struct ColumnInfo
+{
+    std::string name;
+    ColumnType type = ColumnType::Int64;
+    double fill = 0.0;      // value given to rows written before the column was added
+};
+
+struct ColumnarRowGroup
+{
+    size_t rowCount = 0;
+    // One entry per column; only the vector matching the column type is filled
+    std::vector<std::vector<int64_t>> ints;
+    std::vector<std::vector<double>> doubles;
+};
+
+class ColumnarWriter
+{
+public:
+    explicit ColumnarWriter(size_t rowGroupSize = 4096);
+    ~ColumnarWriter();
+
+    bool open(const std::string& path, const std::vector<ColumnInfo>& columns, const std::string& metadata);
+    // Continues an existing file with the same columns, dropping a trailing
+    // group cut short by a crash; creates the file if it does not exist.
+    // A file whose columns are a prefix of these, written before columns
+    // were added at the end, is first rewritten with the new columns
+    // holding their fill value.
+    bool openAppend(const std::string& path, const std::vector<ColumnInfo>& columns, const std::string& metadata);
+    void close();
+    bool isOpen() const { return file != nullptr; }
+
+    // Fill every column of the current row, then commit it
+    void setInt(int column, int64_t value);
+    void setDouble(int column, double value);
+    void commitRow();
+
+    // Writes the buffered rows as one row group
+    bool flush();
+    size_t getBufferedRows() const { return group.rowCount; }
+
+private:
+    void resetBuffers();
+    bool addColumns(const std::string& path, const std::vector<ColumnInfo>& columns);
+
+    std::FILE* file = nullptr;
+    size_t rowGroupSize;
+    std::vector<ColumnInfo> columns;
+    ColumnarRowGroup group;
+    std::vector<int64_t> rowInts;
+    std::vector<double> rowDoubles;
+};
+
+class ColumnarReader
+{
+public:
+    ~ColumnarReader();
+
+    bool open(const std::string& path);
+    void close();
+
+    const std::vector<ColumnInfo>& getColumns() const { return columns; }
+    const std::string& getMetadata() const { return metadata; }
+    int findColumn(const std::string& name) const;
+
+    // Reads the next complete row group; false at the end of the file or at
+    // a truncated trailing group
+    bool nextRowGroup(ColumnarRowGroup& group);
+    // File offset just past the last row group read
+    long getOffset() const;
+
+private:
+    std::FILE* file = nullptr;
+    std::vector<ColumnInfo> columns;
+    std::string metadata;
+};
+
+#endif // COLUMNAR_H
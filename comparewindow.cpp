@@ -0,0 +1,172 @@
+#include "comparewindow.h"
+#include "ui_comparewindow.h"
+
+#include <QFile>
+#include <QJsonDocument>
+#include <QMessageBox>
+
+#include "planlayer.h"
+
+CompareWindow::CompareWindow(QWidget *parent)
+    : QMainWindow(parent)
+    , ui(new Ui::CompareWindow)
+{
+    ui->setupUi(this);
+
+    playTimer = new QTimer(this);
+    playTimer->setInterval(30);
+    connect(playTimer, &QTimer::timeout, this, &CompareWindow::advanceTimeline);
+
+    ui->timelineSlider->setRange(0, 0);
+}
+
+CompareWindow::~CompareWindow()
+{
+    for (ComparedRun &run : runs) {
+        delete run.replay;
+    }
+    delete sharedPlan;
+    delete ui;
+}
+
+bool CompareWindow::addRun(const QString &label, const QString &trajectoryPath)
+{
+    if (runs.size() >= maxRuns) return false;
+
+    QFile file(trajectoryPath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qDebug() << "Failed to open trajectory" << trajectoryPath;
+        return false;
+    }
+
+    ComparedRun run;
+    run.label = label;
+    run.scene = new QGraphicsScene(this);
+    run.replay = new RunReplay(run.scene);
+    if (!run.replay->load(file.readAll(), false)) {
+        delete run.replay;
+        delete run.scene;
+        return false;
+    }
+
+    // Lockstep only makes sense on one floorplan
+    QString runPlan = QString::fromStdString(run.replay->getReader().getPlanJson());
+    if (runs.isEmpty()) {
+        planJson = runPlan;
+        sharedPlan = PlanLayer::fromJson(QJsonDocument::fromJson(planJson.toUtf8()).object());
+    } else if (runPlan != planJson) {
+        QMessageBox::warning(this, "Compare Runs", label + " was recorded on a different floorplan and cannot be compared.");
+        delete run.replay;
+        delete run.scene;
+        return false;
+    }
+
+    run.view = new ReplayView(run.scene, this);
+    run.view->setRenderHint(QPainter::Antialiasing);
+    run.view->setSceneRect(run.replay->getPlanBounds());
+    run.view->setStyleSheet("background: rgb(235,255,235);");
+
+    run.caption = new QLabel(label, this);
+    run.caption->setAlignment(Qt::AlignCenter);
+
+    // Two runs side by side, three or four in a 2x2 grid
+    int index = runs.size();
+    int row = (index / 2) * 2;
+    int column = index % 2;
+    ui->replayGrid->addWidget(run.caption, row, column);
+    ui->replayGrid->addWidget(run.view, row + 1, column);
+
+    runs.append(run);
+
+    int longest = 0;
+    for (const ComparedRun &r : runs) {
+        longest = qMax(longest, r.replay->getTickCount());
+    }
+    ui->timelineSlider->setRange(0, qMax(0, longest - 1));
+    ui->timelineSlider->setValue(0);
+
+    refreshSharedPlan();
+    updateCaptions();
+    return true;
+}
+
+int CompareWindow::getRunCount() const
+{
+    return runs.size();
+}
+
+// Renders the plan once at the size of the largest view and hands the same
+// pixmap to every view; only a resize (zoom) renders it again
+void CompareWindow::refreshSharedPlan()
+{
+    if (!sharedPlan || runs.isEmpty()) return;
+
+    QSize largest;
+    for (ComparedRun &run : runs) {
+        run.view->fitInView(run.replay->getPlanBounds(), Qt::KeepAspectRatio);
+        QRect mapped = run.view->mapFromScene(run.replay->getPlanBounds()).boundingRect();
+        largest = largest.expandedTo(mapped.size());
+    }
+    if (largest.isEmpty()) return;
+
+    QPixmap plan = sharedPlan->toPixmap(largest * devicePixelRatioF());
+    plan.setDevicePixelRatio(devicePixelRatioF());
+    for (ComparedRun &run : runs) {
+        run.view->setPlanPixmap(plan, run.replay->getPlanBounds());
+    }
+}
+
+void CompareWindow::updateCaptions()
+{
+    for (ComparedRun &run : runs) {
+        // House reports square feet as plan area / 280
+        double coveredSF = run.replay->getGrid().getVisitedArea() / 280.0;
+        run.caption->setText(run.label + "  -  " + QString::number(coveredSF, 'f', 0) + " sq. ft");
+    }
+}
+
+void CompareWindow::resizeEvent(QResizeEvent *event)
+{
+    QMainWindow::resizeEvent(event);
+    refreshSharedPlan();
+}
+
+void CompareWindow::on_playButton_clicked()
+{
+    if (playTimer->isActive()) {
+        playTimer->stop();
+        ui->playButton->setText("Play");
+        return;
+    }
+
+    if (ui->timelineSlider->value() >= ui->timelineSlider->maximum()) {
+        ui->timelineSlider->setValue(0);
+    }
+    playTimer->start();
+    ui->playButton->setText("Pause");
+}
+
+void CompareWindow::advanceTimeline()
+{
+    int step = qMax(1, ui->timelineSlider->maximum() / 600);
+    int next = ui->timelineSlider->value() + step;
+    if (next >= ui->timelineSlider->maximum()) {
+        next = ui->timelineSlider->maximum();
+        playTimer->stop();
+        ui->playButton->setText("Play");
+    }
+    ui->timelineSlider->setValue(next);
+}
+
+void CompareWindow::on_timelineSlider_valueChanged(int tick)
+{
+    // Every run advances to the same tick; shorter runs hold their last frame
+    for (ComparedRun &run : runs) {
+        run.replay->setTick(tick);
+    }
+    updateCaptions();
+
+    ui->timeLabel->setText(QString("%1:%2:%3").arg(tick / 3600, 2, 10, QChar('0'))
+                               .arg((tick / 60) % 60, 2, 10, QChar('0'))
+                               .arg(tick % 60, 2, 10, QChar('0')));
+}
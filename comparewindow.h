@@ -0,0 +1,60 @@
+#ifndef COMPAREWINDOW_H
+#define COMPAREWINDOW_H
+
+#include <QMainWindow>
+#include <QLabel>
+#include <QTimer>
+#include <QList>
+
+#include "replay.h"
+
+namespace Ui {
+class CompareWindow;
+}
+
+// Replays two to four recorded runs of the same floorplan side by side on a
+// shared timeline. The plan is rendered once into a pixmap that every view
+// paints as its background; each run only owns its coverage layer and robot.
+class CompareWindow : public QMainWindow
+{
+    Q_OBJECT
+
+public:
+    explicit CompareWindow(QWidget *parent = nullptr);
+    ~CompareWindow();
+
+    static const int maxRuns = 4;
+
+    bool addRun(const QString &label, const QString &trajectoryPath);
+    int getRunCount() const;
+
+protected:
+    void resizeEvent(QResizeEvent *event) override;
+
+private slots:
+    void on_playButton_clicked();
+    void on_timelineSlider_valueChanged(int tick);
+    void advanceTimeline();
+
+private:
+    struct ComparedRun
+    {
+        QString label;
+        QGraphicsScene *scene;
+        RunReplay *replay;
+        ReplayView *view;
+        QLabel *caption;
+    };
+
+    Ui::CompareWindow *ui;
+    QList<ComparedRun> runs;
+
+    PlanLayer *sharedPlan = nullptr;
+    QString planJson;
+    QTimer *playTimer;
+
+    void refreshSharedPlan();
+    void updateCaptions();
+};
+
+#endif // COMPAREWINDOW_H
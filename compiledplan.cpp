@@ -0,0 +1,556 @@
+#include "compiledplan.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <queue>
+
+namespace {
+const double epsilon = 1e-9;
+const double edgeInset = 0.5;       // lanes and door points stay this far inside their cell
+
+double distance(const Vector2D& a, const Vector2D& b)
+{
+    return std::hypot(a.x - b.x, a.y - b.y);
+}
+
+// One pass of the Felzenszwalb-Huttenlocher distance transform: the lower
+// envelope of the parabolas rooted at f, n samples strided by stride, in
+// place. v and z are scratch for n and n + 1 entries.
+void squaredDistance1D(float* f, int n, size_t stride, std::vector<float>& out, std::vector<int>& v,
+                       std::vector<float>& z)
+{
+    const float inf = std::numeric_limits<float>::infinity();
+    int k = -1;
+    for (int q = 0; q < n; q++) {
+        const float fq = f[q * stride];
+        if (fq == inf) continue;
+        float s = -inf;
+        while (k >= 0) {
+            const int p = v[k];
+            s = ((fq + float(q) * q) - (f[p * stride] + float(p) * p)) / (2.0f * (q - p));
+            if (s > z[k]) break;
+            k--;
+        }
+        k++;
+        v[k] = q;
+        z[k] = k == 0 ? -inf : s;
+        z[k + 1] = inf;
+    }
+    if (k < 0) return;      // no roots: stays infinite
+    for (int q = 0, j = 0; q < n; q++) {
+        while (z[j + 1] < q) j++;
+        const float d = float(q - v[j]);
+        out[q] = d * d + f[v[j] * stride];
+    }
+    for (int q = 0; q < n; q++) f[q * stride] = out[q];
+}
+}
+
+CompiledPlan::CompiledPlan(const CollisionSystem& plan, double robotRadius)
+    : robotRadius(robotRadius)
+    , rooms(plan.getRooms())
+{
+    for (size_t i = 0; i < rooms.size(); i++) {
+        decomposeRoom(int(i), rooms[i], plan.getObstructions());
+    }
+    findDoors(plan);
+    linksFrom.resize(cells.size());
+    linkCells();
+    rasterize(plan);
+}
+
+void CompiledPlan::rasterize(const CollisionSystem& plan)
+{
+    Vector2D topLeft;
+    Vector2D bottomRight;
+    if (!plan.getBounds(topLeft, bottomRight)) return;
+
+    gridLeft = topLeft.x;
+    gridTop = topLeft.y;
+    gridWidth = int(std::ceil((bottomRight.x - topLeft.x) / gridCellSize));
+    gridHeight = int(std::ceil((bottomRight.y - topLeft.y) / gridCellSize));
+    freeMask.assign(size_t(gridWidth) * gridHeight, 0);
+
+    // Squares where the robot centre itself is clear...
+    std::vector<uint8_t> clear(freeMask.size(), 0);
+    for (int y = 0; y < gridHeight; y++) {
+        for (int x = 0; x < gridWidth; x++) {
+            Vector2D centre = gridCentre(y * gridWidth + x);
+            if (!plan.getCurrentRoom(centre)) continue;
+            clear[size_t(y) * gridWidth + x] = !plan.handleCollision(centre, robotRadius);
+        }
+    }
+    // ...eroded by one square. Growing the radius instead would not do:
+    // handleCollision widens door gaps by the radius it is given.
+    for (int y = 1; y + 1 < gridHeight; y++) {
+        for (int x = 1; x + 1 < gridWidth; x++) {
+            bool free = true;
+            for (int dy = -1; dy <= 1 && free; dy++) {
+                for (int dx = -1; dx <= 1 && free; dx++) {
+                    free = clear[size_t(y + dy) * gridWidth + x + dx];
+                }
+            }
+            freeMask[size_t(y) * gridWidth + x] = free;
+        }
+    }
+    computeStraightJumps();
+    computeWallDistances(clear);
+}
+
+void CompiledPlan::computeWallDistances(const std::vector<uint8_t>& clear)
+{
+    // Exact Euclidean transform in two separable linear passes, columns
+    // then rows, over squared distances in squares
+    wallDistances.assign(clear.size(), 0.0f);
+    for (size_t i = 0; i < clear.size(); i++) {
+        if (clear[i]) wallDistances[i] = std::numeric_limits<float>::infinity();
+    }
+    const int longest = std::max(gridWidth, gridHeight);
+    std::vector<float> out(longest);
+    std::vector<int> v(longest);
+    std::vector<float> z(longest + 1);
+    for (int x = 0; x < gridWidth; x++) {
+        squaredDistance1D(&wallDistances[x], gridHeight, gridWidth, out, v, z);
+    }
+    for (int y = 0; y < gridHeight; y++) {
+        squaredDistance1D(&wallDistances[size_t(y) * gridWidth], gridWidth, 1, out, v, z);
+    }
+    for (float& d : wallDistances) d = std::sqrt(d) * float(gridCellSize);
+}
+
+double CompiledPlan::wallDistanceAt(const Vector2D& pos, Vector2D* gradient) const
+{
+    if (gradient) *gradient = {0.0, 0.0};
+    if (gridWidth < 2 || gridHeight < 2) return 0.0;
+    // Bilinear between the four surrounding square centres
+    const double fx = std::clamp((pos.x - gridLeft) / gridCellSize - 0.5, 0.0, gridWidth - 1.000001);
+    const double fy = std::clamp((pos.y - gridTop) / gridCellSize - 0.5, 0.0, gridHeight - 1.000001);
+    const int x = int(fx);
+    const int y = int(fy);
+    const double tx = fx - x;
+    const double ty = fy - y;
+    const float* row = &wallDistances[size_t(y) * gridWidth + x];
+    const double d00 = row[0], d10 = row[1], d01 = row[gridWidth], d11 = row[gridWidth + 1];
+    if (gradient) {
+        *gradient = {((d10 - d00) * (1 - ty) + (d11 - d01) * ty) / gridCellSize,
+                     ((d01 - d00) * (1 - tx) + (d11 - d10) * tx) / gridCellSize};
+    }
+    return (d00 * (1 - tx) + d10 * tx) * (1 - ty) + (d01 * (1 - tx) + d11 * tx) * ty;
+}
+
+void CompiledPlan::computeStraightJumps()
+{
+    straightJumps.assign(freeMask.size() * 4, 0);
+    const int steps[4][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+    for (int direction = 0; direction < 4; direction++) {
+        const int dx = steps[direction][0];
+        const int dy = steps[direction][1];
+        // A square entered moving (dx, dy) has a forced neighbour when a
+        // side square is free but the one diagonally behind it is not
+        auto isJumpPoint = [&](int x, int y) {
+            if (dx != 0) {
+                return (isFree(x, y - 1) && !isFree(x - dx, y - 1)) || (isFree(x, y + 1) && !isFree(x - dx, y + 1));
+            }
+            return (isFree(x - 1, y) && !isFree(x - 1, y - dy)) || (isFree(x + 1, y) && !isFree(x + 1, y - dy));
+        };
+        // Walk each line against the direction so the square ahead is done first
+        const int lines = dx != 0 ? gridHeight : gridWidth;
+        const int length = dx != 0 ? gridWidth : gridHeight;
+        for (int line = 0; line < lines; line++) {
+            for (int k = 0; k < length; k++) {
+                const int along = (dx + dy) > 0 ? length - 1 - k : k;
+                const int x = dx != 0 ? along : line;
+                const int y = dx != 0 ? line : along;
+                if (!isFree(x, y)) continue;
+                int jump = 0;
+                if (isFree(x + dx, y + dy)) {
+                    if (isJumpPoint(x + dx, y + dy)) {
+                        jump = 1;
+                    } else {
+                        const int ahead = straightJumps[(size_t(y + dy) * gridWidth + x + dx) * 4 + direction];
+                        jump = ahead > 0 ? ahead + 1 : ahead - 1;
+                    }
+                }
+                straightJumps[(size_t(y) * gridWidth + x) * 4 + direction] = jump;
+            }
+        }
+    }
+}
+
+void CompiledPlan::decomposeRoom(int roomIndex, const Room2D& room, const std::vector<Obstruction2D>& obstructions)
+{
+    const double left = room.topLeft.x + robotRadius;
+    const double right = room.bottomRight.x - robotRadius;
+    const double top = room.topLeft.y + robotRadius;
+    const double bottom = room.bottomRight.y - robotRadius;
+    if (left > right || top > bottom) return;       // the robot does not fit
+
+    // Chests as the robot centre sees them: handleCollision tests the
+    // robot's bounding square, so each chest grows by the radius on all sides
+    struct Box { double left, top, right, bottom; };
+    std::vector<Box> boxes;
+    std::vector<double> events = {left, right};
+    for (const Obstruction2D& obs : obstructions) {
+        if (!obs.isChest) continue;
+        Box box = {obs.topLeft.x - robotRadius, obs.topLeft.y - robotRadius,
+                   obs.bottomRight.x + robotRadius, obs.bottomRight.y + robotRadius};
+        if (box.right <= left || box.left >= right || box.bottom <= top || box.top >= bottom) continue;
+        boxes.push_back(box);
+        events.push_back(std::max(box.left, left));
+        events.push_back(std::min(box.right, right));
+    }
+    std::sort(events.begin(), events.end());
+    events.erase(std::unique(events.begin(), events.end(),
+                             [](double a, double b) { return b - a < epsilon; }), events.end());
+
+    // Cells of the previous slab, which the next slab may extend
+    std::vector<int> open;
+    for (size_t k = 0; k + 1 < events.size(); k++) {
+        const double x0 = events[k];
+        const double x1 = events[k + 1];
+        const double middle = (x0 + x1) / 2.0;
+
+        std::vector<std::pair<double, double>> blocked;
+        for (const Box& box : boxes) {
+            if (box.left < middle && box.right > middle) blocked.emplace_back(box.top, box.bottom);
+        }
+        std::sort(blocked.begin(), blocked.end());
+
+        std::vector<int> current;
+        auto addInterval = [&](double y0, double y1) {
+            if (y1 - y0 < epsilon) return;
+            for (int c : open) {
+                PlanCell& cell = cells[c];
+                if (std::abs(cell.top - y0) < epsilon && std::abs(cell.bottom - y1) < epsilon) {
+                    cell.right = x1;
+                    current.push_back(c);
+                    return;
+                }
+            }
+            cells.push_back({roomIndex, x0, y0, x1, y1});
+            current.push_back(int(cells.size()) - 1);
+        };
+
+        double y = top;
+        for (const auto& interval : blocked) {
+            if (interval.first > y) addInterval(y, std::min(interval.first, bottom));
+            y = std::max(y, interval.second);
+        }
+        if (y < bottom) addInterval(y, bottom);
+        open.swap(current);
+    }
+}
+
+void CompiledPlan::addLink(int from, int to, std::vector<Vector2D> points)
+{
+    linksFrom[from].push_back(int(links.size()));
+    links.push_back({from, to, std::move(points)});
+}
+
+void CompiledPlan::findDoors(const CollisionSystem& plan)
+{
+    // A door joins the two rooms whose shared wall it lies on
+    auto spans = [&](double low, double high, double value) {
+        return value >= low + robotRadius && value <= high - robotRadius;
+    };
+    const double clearance = robotRadius + edgeInset;
+    for (const Door2D& door : plan.getDoors()) {
+        const double gapX = door.origin.x + CollisionSystem::doorWidth / 2.0;
+        const double gapY = door.origin.y + CollisionSystem::doorWidth / 2.0;
+        for (size_t a = 0; a < rooms.size(); a++) {
+            for (size_t b = 0; b < rooms.size(); b++) {
+                const Room2D& first = rooms[a];
+                const Room2D& second = rooms[b];
+                if (std::abs(first.bottomRight.y - door.origin.y) < epsilon &&
+                    std::abs(second.topLeft.y - door.origin.y) < epsilon &&
+                    spans(first.topLeft.x, first.bottomRight.x, gapX) &&
+                    spans(second.topLeft.x, second.bottomRight.x, gapX)) {
+                    doors.push_back({{gapX, door.origin.y}, int(a), int(b),
+                                     {gapX, door.origin.y - clearance}, {gapX, door.origin.y + clearance}});
+                } else if (std::abs(first.bottomRight.x - door.origin.x) < epsilon &&
+                           std::abs(second.topLeft.x - door.origin.x) < epsilon &&
+                           spans(first.topLeft.y, first.bottomRight.y, gapY) &&
+                           spans(second.topLeft.y, second.bottomRight.y, gapY)) {
+                    doors.push_back({{door.origin.x, gapY}, int(a), int(b),
+                                     {door.origin.x - clearance, gapY}, {door.origin.x + clearance, gapY}});
+                }
+            }
+        }
+    }
+}
+
+void CompiledPlan::linkCells()
+{
+    // Neighbouring cells of one room meet along a vertical event line
+    for (size_t i = 0; i < cells.size(); i++) {
+        for (size_t j = 0; j < cells.size(); j++) {
+            const PlanCell& a = cells[i];
+            const PlanCell& b = cells[j];
+            if (a.room != b.room || std::abs(a.right - b.left) >= epsilon) continue;
+            const double top = std::max(a.top, b.top);
+            const double bottom = std::min(a.bottom, b.bottom);
+            if (bottom - top < epsilon) continue;
+            const Vector2D point = {a.right, (top + bottom) / 2.0};
+            addLink(int(i), int(j), {point});
+            addLink(int(j), int(i), {point});
+        }
+    }
+
+    auto cellIn = [&](int room, const Vector2D& pos) {
+        for (size_t c = 0; c < cells.size(); c++) {
+            const PlanCell& cell = cells[c];
+            if (cell.room == room && pos.x >= cell.left && pos.x <= cell.right &&
+                pos.y >= cell.top && pos.y <= cell.bottom) {
+                return int(c);
+            }
+        }
+        return -1;
+    };
+    for (const PlanDoor& door : doors) {
+        const int from = cellIn(door.firstRoom, door.firstSide);
+        const int to = cellIn(door.secondRoom, door.secondSide);
+        if (from < 0 || to < 0) continue;       // a chest blocks the doorway
+        addLink(from, to, {door.firstSide, door.secondSide});
+        addLink(to, from, {door.secondSide, door.firstSide});
+    }
+}
+
+int CompiledPlan::cellAt(const Vector2D& pos) const
+{
+    for (size_t c = 0; c < cells.size(); c++) {
+        const PlanCell& cell = cells[c];
+        if (pos.x >= cell.left - epsilon && pos.x <= cell.right + epsilon &&
+            pos.y >= cell.top - epsilon && pos.y <= cell.bottom + epsilon) {
+            return int(c);
+        }
+    }
+    return -1;
+}
+
+int CompiledPlan::roomAt(const Vector2D& pos) const
+{
+    for (size_t r = 0; r < rooms.size(); r++) {
+        const Room2D& room = rooms[r];
+        if (pos.x >= room.topLeft.x && pos.x <= room.bottomRight.x &&
+            pos.y >= room.topLeft.y && pos.y <= room.bottomRight.y) {
+            return int(r);
+        }
+    }
+    return -1;
+}
+
+int CompiledPlan::roomNear(const Vector2D& pos) const
+{
+    const int room = roomAt(pos);
+    if (room >= 0) return room;
+    const int square = nearestFree(pos, robotRadius + 4 * gridCellSize);
+    return square >= 0 ? roomAt(gridCentre(square)) : -1;
+}
+
+int CompiledPlan::gridIndex(const Vector2D& pos) const
+{
+    const int x = int(std::floor((pos.x - gridLeft) / gridCellSize));
+    const int y = int(std::floor((pos.y - gridTop) / gridCellSize));
+    if (x < 0 || y < 0 || x >= gridWidth || y >= gridHeight) return -1;
+    return y * gridWidth + x;
+}
+
+Vector2D CompiledPlan::gridCentre(int index) const
+{
+    return {gridLeft + (index % gridWidth + 0.5) * gridCellSize,
+            gridTop + (index / gridWidth + 0.5) * gridCellSize};
+}
+
+int CompiledPlan::nearestFree(const Vector2D& pos, double maxDistance) const
+{
+    if (gridWidth == 0) return -1;
+    const int cx = std::clamp(int(std::floor((pos.x - gridLeft) / gridCellSize)), 0, gridWidth - 1);
+    const int cy = std::clamp(int(std::floor((pos.y - gridTop) / gridCellSize)), 0, gridHeight - 1);
+    const int rings = int(std::ceil(maxDistance / gridCellSize));
+
+    // Ring r holds the squares at Chebyshev distance r; one ring beyond the
+    // first hit can still hold a closer square in Euclidean terms
+    int best = -1;
+    double bestDistance = std::numeric_limits<double>::infinity();
+    int lastRing = rings;
+    for (int r = 0; r <= lastRing; r++) {
+        for (int y = cy - r; y <= cy + r; y++) {
+            const int step = (y == cy - r || y == cy + r) ? 1 : 2 * r;
+            for (int x = cx - r; x <= cx + r; x += std::max(step, 1)) {
+                if (!isFree(x, y)) continue;
+                const int index = y * gridWidth + x;
+                const double d = distance(pos, gridCentre(index));
+                if (d < bestDistance && d <= maxDistance) {
+                    bestDistance = d;
+                    best = index;
+                    lastRing = std::min(lastRing, r + 1);
+                }
+            }
+        }
+    }
+    return best;
+}
+
+void CompiledPlan::appendLanes(int cellIndex, const Vector2D& from, double laneSpacing,
+                               std::vector<RouteWaypoint>& route) const
+{
+    const PlanCell& cell = cells[cellIndex];
+
+    // Lanes along the longer side turn less often
+    const bool vertical = cell.bottom - cell.top >= cell.right - cell.left;
+    auto inset = [](double low, double high, double& insetLow, double& insetHigh) {
+        const double margin = std::min(edgeInset, (high - low) / 2.0);
+        insetLow = low + margin;
+        insetHigh = high - margin;
+    };
+    double acrossLow, acrossHigh, alongLow, alongHigh;
+    if (vertical) {
+        inset(cell.left, cell.right, acrossLow, acrossHigh);
+        inset(cell.top, cell.bottom, alongLow, alongHigh);
+    } else {
+        inset(cell.top, cell.bottom, acrossLow, acrossHigh);
+        inset(cell.left, cell.right, alongLow, alongHigh);
+    }
+    auto point = [vertical](double across, double along) {
+        return vertical ? Vector2D{across, along} : Vector2D{along, across};
+    };
+
+    // Evenly spaced, no further apart than laneSpacing, the outer ones on the cell edges
+    const int lanes = 1 + int(std::ceil((acrossHigh - acrossLow) / laneSpacing - epsilon));
+    const double step = lanes > 1 ? (acrossHigh - acrossLow) / (lanes - 1) : 0.0;
+
+    // Start in the corner closest to where the robot comes in
+    bool acrossFromLow = true;
+    bool alongFromLow = true;
+    double best = std::numeric_limits<double>::infinity();
+    for (int corner = 0; corner < 4; corner++) {
+        const bool lowAcross = (corner & 1) == 0;
+        const bool lowAlong = (corner & 2) == 0;
+        const double d = distance(from, point(lowAcross ? acrossLow : acrossHigh, lowAlong ? alongLow : alongHigh));
+        if (d < best) {
+            best = d;
+            acrossFromLow = lowAcross;
+            alongFromLow = lowAlong;
+        }
+    }
+
+    for (int k = 0; k < lanes; k++) {
+        const double across = acrossFromLow ? acrossLow + k * step : acrossHigh - k * step;
+        route.push_back({point(across, alongFromLow ? alongLow : alongHigh), cellIndex});
+        route.push_back({point(across, alongFromLow ? alongHigh : alongLow), cellIndex});
+        alongFromLow = !alongFromLow;
+    }
+}
+
+std::vector<RouteWaypoint> CompiledPlan::boustrophedonRoute(const Vector2D& from, double laneSpacing,
+                                                           const std::vector<int>& roomOrder,
+                                                           bool onlyListed) const
+{
+    std::vector<RouteWaypoint> route;
+    if (cells.empty()) return route;
+
+    Vector2D at = from;
+    int current = cellAt(from);
+    if (current < 0) {
+        // Pressed against a wall or chest: begin at the closest cell
+        double best = std::numeric_limits<double>::infinity();
+        for (size_t c = 0; c < cells.size(); c++) {
+            const PlanCell& cell = cells[c];
+            const Vector2D nearest = {std::clamp(from.x, cell.left, cell.right), std::clamp(from.y, cell.top, cell.bottom)};
+            const double d = distance(from, nearest);
+            if (d < best) {
+                best = d;
+                current = int(c);
+                at = nearest;
+            }
+        }
+        route.push_back({at, -1});
+    }
+
+    const size_t count = cells.size();
+    std::vector<char> swept(count, 0);
+    std::vector<double> cost(count);
+    std::vector<Vector2D> entry(count);
+    std::vector<int> via(count);
+    std::vector<int> unswept(rooms.size(), 0);
+    for (const PlanCell& cell : cells) unswept[cell.room]++;
+    if (onlyListed) {
+        // Rooms left out count as swept from the start
+        std::vector<char> listed(rooms.size(), 0);
+        for (int room : roomOrder) listed[room] = 1;
+        for (size_t c = 0; c < count; c++) {
+            if (!listed[cells[c].room]) swept[c] = 1;
+        }
+        for (size_t r = 0; r < rooms.size(); r++) {
+            if (!listed[r]) unswept[r] = 0;
+        }
+    }
+    using Item = std::pair<double, int>;
+
+    while (current >= 0) {
+        if (!swept[current]) {
+            appendLanes(current, at, laneSpacing, route);
+            swept[current] = 1;
+            unswept[cells[current].room]--;
+            at = route.back().position;
+        }
+
+        // The room to sweep next: this one until it is done, then the
+        // first in the order with cells left; -1 for any
+        int room = -1;
+        if (!roomOrder.empty()) {
+            if (unswept[cells[current].room] > 0) room = cells[current].room;
+            for (size_t r = 0; r < roomOrder.size() && room < 0; r++) {
+                if (unswept[roomOrder[r]] > 0) room = roomOrder[r];
+            }
+        }
+
+        // Dijkstra over the cells, measured between the points where the
+        // route enters each one; stops at the first cell not yet swept
+        std::fill(cost.begin(), cost.end(), std::numeric_limits<double>::infinity());
+        std::fill(via.begin(), via.end(), -1);
+        std::priority_queue<Item, std::vector<Item>, std::greater<Item>> queue;
+        cost[current] = 0.0;
+        entry[current] = at;
+        queue.push({0.0, current});
+        int next = -1;
+        int fallback = -1;      // closest unswept cell of any room
+        while (!queue.empty()) {
+            const Item item = queue.top();
+            queue.pop();
+            const int u = item.second;
+            if (item.first > cost[u]) continue;
+            if (!swept[u] && fallback < 0) fallback = u;
+            if (!swept[u] && (room < 0 || cells[u].room == room)) {
+                next = u;
+                break;
+            }
+            for (int l : linksFrom[u]) {
+                const PlanLink& link = links[l];
+                double d = item.first + distance(entry[u], link.points.front());
+                d += distance(link.points.front(), link.points.back());
+                if (d < cost[link.to]) {
+                    cost[link.to] = d;
+                    entry[link.to] = link.points.back();
+                    via[link.to] = l;
+                    queue.push({d, link.to});
+                }
+            }
+        }
+        if (next < 0) next = fallback;
+        if (next < 0) break;
+
+        std::vector<int> chain;
+        for (int c = next; c != current; c = links[via[c]].from) chain.push_back(via[c]);
+        for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+            const PlanLink& link = links[*it];
+            route.push_back({link.points.front(), link.from});
+            if (link.points.size() > 1) route.push_back({link.points.back(), -1});
+        }
+        at = route.back().position;
+        current = next;
+    }
+    return route;
+}
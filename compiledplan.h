@@ -0,0 +1,145 @@
+#ifndef COMPILEDPLAN_H
+#define COMPILEDPLAN_H
+
+#include <cstdint>
+#include <vector>
+
+#include "vacuum.h"
+
+// A rectangle of one room's free space in robot-centre coordinates: a
+// centre anywhere inside keeps the robot clear of the walls and chests
+struct PlanCell
+{
+    int room;
+    double left;
+    double top;
+    double right;
+    double bottom;
+};
+
+// A way from one cell into another: one point on the edge two cells of a
+// room share, or the points either side of a door
+struct PlanLink
+{
+    int from;
+    int to;
+    std::vector<Vector2D> points;
+};
+
+// A door and the rooms it joins. The robot crosses through the middle of
+// the gap, from a point just inside one room to one just inside the other.
+struct PlanDoor
+{
+    Vector2D centre;
+    int firstRoom;
+    int secondRoom;
+    Vector2D firstSide;
+    Vector2D secondSide;
+};
+
+struct RouteWaypoint
+{
+    Vector2D position;
+    int cell;       // the cell the leg ending here runs through, -1 through a door
+};
+
+// What the planning strategies need from a plan, derived once when the plan
+// is loaded instead of from collision probes every tick. Immutable after
+// construction, so forks and worker threads share one.
+//
+// Each room's free space is decomposed boustrophedon style: the room,
+// shrunk by the robot radius, is swept left to right, every chest edge
+// (grown by the radius) is an event, and the free vertical intervals
+// between events form rectangular cells, merged across events that leave
+// them unchanged. Tables do not collide and are not obstacles.
+//
+// The plan is also rasterized into an occupancy grid of gridCellSize
+// squares: a square is free when a robot centred on it or on any of its
+// eight neighbours is inside a room and clear of handleCollision. The
+// one-square margin keeps straight moves between free squares clear.
+// Path planning runs on that mask. A Euclidean distance transform of the
+// unshrunk clear squares gives the distance field wall following traces.
+class CompiledPlan
+{
+public:
+    static constexpr double gridCellSize = 2.0;
+
+    CompiledPlan(const CollisionSystem& plan, double robotRadius);
+
+    double getRobotRadius() const { return robotRadius; }
+    const std::vector<PlanCell>& getCells() const { return cells; }
+    const std::vector<PlanLink>& getLinks() const { return links; }
+    const std::vector<Room2D>& getRooms() const { return rooms; }
+    const std::vector<PlanDoor>& getDoors() const { return doors; }
+
+    // The cell containing pos, -1 if none does
+    int cellAt(const Vector2D& pos) const;
+    // The room pos belongs to, as CollisionSystem::getCurrentRoom picks it; -1 outside
+    int roomAt(const Vector2D& pos) const;
+    // roomAt, or for a robot in a doorway or pressed against a wall the
+    // room of the closest free square; -1 if there is none nearby
+    int roomNear(const Vector2D& pos) const;
+
+    // Occupancy grid, squares indexed y * width + x
+    int getGridWidth() const { return gridWidth; }
+    int getGridHeight() const { return gridHeight; }
+    bool isFree(int x, int y) const
+    {
+        return x >= 0 && y >= 0 && x < gridWidth && y < gridHeight && freeMask[size_t(y) * gridWidth + x];
+    }
+    // Square containing pos, -1 off the grid
+    int gridIndex(const Vector2D& pos) const;
+    Vector2D gridCentre(int index) const;
+    // The free square closest to pos, searching rings out to maxDistance; -1 if none
+    int nearestFree(const Vector2D& pos, double maxDistance) const;
+
+    // Precomputed straight jumps for jump-point search, direction 0..3 being
+    // +x, -x, +y, -y. From free square index, n > 0 means the n-th square
+    // on is the first with a forced neighbour; n <= 0 means the run ends at
+    // a wall after -n free squares.
+    int getStraightJump(int index, int direction) const { return straightJumps[size_t(index) * 4 + direction]; }
+
+    // Distance field of the robot centre's free space: from each square's
+    // centre to the nearest square where a centred robot would collide (a
+    // wall, a chest, or outside every room). Zero on those squares.
+    double getWallDistance(int x, int y) const { return wallDistances[size_t(y) * gridWidth + x]; }
+    // The field interpolated at pos, and its gradient there, which points
+    // away from the closest wall; clamped to the grid
+    double wallDistanceAt(const Vector2D& pos, Vector2D* gradient = nullptr) const;
+
+    // Sweeps every cell reachable from pos with lanes laneSpacing apart,
+    // laid along each cell's longer side. After a cell it goes on to the
+    // closest unswept cell through the links. Given a room order, it
+    // finishes a room before leaving it and takes the rooms in that order;
+    // with onlyListed, rooms not in the order are crossed but not swept.
+    std::vector<RouteWaypoint> boustrophedonRoute(const Vector2D& from, double laneSpacing,
+                                                  const std::vector<int>& roomOrder = {},
+                                                  bool onlyListed = false) const;
+
+private:
+    void rasterize(const CollisionSystem& plan);
+    void computeStraightJumps();
+    void computeWallDistances(const std::vector<uint8_t>& clear);
+    void decomposeRoom(int roomIndex, const Room2D& room, const std::vector<Obstruction2D>& obstructions);
+    void findDoors(const CollisionSystem& plan);
+    void linkCells();
+    void addLink(int from, int to, std::vector<Vector2D> points);
+    void appendLanes(int cell, const Vector2D& from, double laneSpacing, std::vector<RouteWaypoint>& route) const;
+
+    double robotRadius;
+    std::vector<Room2D> rooms;
+    std::vector<PlanDoor> doors;
+    std::vector<PlanCell> cells;
+    std::vector<PlanLink> links;
+    std::vector<std::vector<int>> linksFrom;    // link indices by cell
+
+    double gridLeft = 0.0;
+    double gridTop = 0.0;
+    int gridWidth = 0;
+    int gridHeight = 0;
+    std::vector<uint8_t> freeMask;
+    std::vector<int32_t> straightJumps;
+    std::vector<float> wallDistances;
+};
+
+#endif // COMPILEDPLAN_H
@@ -0,0 +1,81 @@
+#include "coveragechart.h"
+
+#include <QPainter>
+#include <QPainterPath>
+
+CoverageChart::CoverageChart(QWidget *parent)
+    : QWidget(parent)
+{
+    setMinimumHeight(120);
+}
+
+void CoverageChart::setHistory(const CoverageHistory *history)
+{
+    m_history = history;
+    update();
+}
+
+void CoverageChart::setMaximumCoverage(double maximum)
+{
+    m_maximumCoverage = maximum;
+    update();
+}
+
+void CoverageChart::paintEvent(QPaintEvent *)
+{
+    QPainter painter(this);
+    painter.setRenderHint(QPainter::Antialiasing);
+
+    QFont font("Verdana", 8);
+    painter.setFont(font);
+
+    const int labelWidth = 40;
+    const int labelHeight = 16;
+    QRectF plot(labelWidth, 4, width() - labelWidth - 8, height() - labelHeight - 8);
+
+    painter.fillRect(plot, QColor(235, 255, 235));
+    painter.setPen(QPen(QColor(86, 171, 145), 1));
+    painter.drawRect(plot);
+
+    if (!m_history || m_history->isEmpty() || plot.width() < 2) return;
+
+    std::vector<CoverageBucket> buckets = m_history->downsample(int(plot.width()));
+
+    double yMax = m_maximumCoverage;
+    for (const CoverageBucket &bucket : buckets) {
+        yMax = qMax(yMax, bucket.maxCoverage);
+    }
+    if (yMax <= 0.0) yMax = 1.0;
+
+    const int startTime = m_history->at(0).time;
+    const int endTime = m_history->at(m_history->size() - 1).time;
+    const double span = qMax(1, endTime - startTime);
+
+    auto toX = [&](int time) { return plot.left() + (time - startTime) / span * plot.width(); };
+    auto toY = [&](double coverage) { return plot.bottom() - coverage / yMax * plot.height(); };
+
+    // Min/max band of each bucket, then the curve through the bucket maxima
+    painter.setPen(QPen(QColor(103, 185, 154), 1));
+    for (const CoverageBucket &bucket : buckets) {
+        qreal x = toX(bucket.startTime);
+        painter.drawLine(QPointF(x, toY(bucket.minCoverage)), QPointF(x, toY(bucket.maxCoverage)));
+    }
+
+    QPainterPath curve;
+    curve.moveTo(toX(buckets.front().startTime), toY(buckets.front().maxCoverage));
+    for (const CoverageBucket &bucket : buckets) {
+        curve.lineTo(toX(bucket.endTime), toY(bucket.maxCoverage));
+    }
+    painter.setPen(QPen(QColor(0, 90, 70), 2));
+    painter.drawPath(curve);
+
+    painter.setPen(Qt::black);
+    painter.drawText(QRectF(0, plot.top(), labelWidth - 4, labelHeight),
+                     Qt::AlignRight | Qt::AlignVCenter, QString::number(yMax, 'g', 4));
+    painter.drawText(QRectF(0, plot.bottom() - labelHeight, labelWidth - 4, labelHeight),
+                     Qt::AlignRight | Qt::AlignVCenter, "0");
+
+    QString endLabel = QString("%1:%2").arg(endTime / 60, 2, 10, QChar('0')).arg(endTime % 60, 2, 10, QChar('0'));
+    painter.drawText(QRectF(plot.left(), plot.bottom() + 2, plot.width(), labelHeight),
+                     Qt::AlignRight | Qt::AlignTop, endLabel);
+}
@@ -0,0 +1,29 @@
+#ifndef COVERAGECHART_H
+#define COVERAGECHART_H
+
+#include <QWidget>
+
+#include "coveragehistory.h"
+
+// Lightweight coverage-over-time plot. The history is reduced to one min/max
+// bucket per horizontal pixel before drawing, so repainting stays cheap no
+// matter how many samples the run produced.
+class CoverageChart : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit CoverageChart(QWidget *parent = nullptr);
+
+    void setHistory(const CoverageHistory *history);
+    void setMaximumCoverage(double maximum);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+
+private:
+    const CoverageHistory *m_history = nullptr;
+    double m_maximumCoverage = 0.0;
+};
+
+#endif // COVERAGECHART_H
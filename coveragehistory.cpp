@@ -0,0 +1,80 @@
+#include "coveragehistory.h"
+
+#include <algorithm>
+
+CoverageHistory::CoverageHistory(int capacity)
+    : samples(size_t(std::max(1, capacity)))
+{
+}
+
+void CoverageHistory::setSampleInterval(int seconds)
+{
+    if (seconds >= 1)
+    {
+        sampleInterval = seconds;
+    }
+}
+
+int CoverageHistory::getSampleInterval() const
+{
+    return sampleInterval;
+}
+
+void CoverageHistory::record(int time, double coverage)
+{
+    if (!samples.empty() && time - lastSampleTime < sampleInterval) return;
+    append({time, coverage});
+}
+
+void CoverageHistory::append(const CoverageSample& sample)
+{
+    samples.push(sample);
+    lastSampleTime = sample.time;
+}
+
+void CoverageHistory::clear()
+{
+    samples.clear();
+    lastSampleTime = 0;
+}
+
+int CoverageHistory::size() const
+{
+    return int(samples.size());
+}
+
+const CoverageSample& CoverageHistory::at(int i) const
+{
+    return samples.at(size_t(i));
+}
+
+bool CoverageHistory::isEmpty() const
+{
+    return samples.empty();
+}
+
+std::vector<CoverageBucket> CoverageHistory::downsample(int numBuckets) const
+{
+    std::vector<CoverageBucket> buckets;
+    if (samples.empty() || numBuckets <= 0) return buckets;
+
+    const int start = samples.front().time;
+    const long long span = std::max(1, samples.back().time - start + 1);
+    int currentBucket = -1;
+
+    for (size_t i = 0; i < samples.size(); ++i) {
+        const CoverageSample& s = samples.at(i);
+        int b = int((s.time - start) * (long long)numBuckets / span);
+
+        if (b != currentBucket) {
+            buckets.push_back({s.time, s.time, s.coverage, s.coverage});
+            currentBucket = b;
+        } else {
+            CoverageBucket& bucket = buckets.back();
+            bucket.endTime = s.time;
+            bucket.minCoverage = std::min(bucket.minCoverage, s.coverage);
+            bucket.maxCoverage = std::max(bucket.maxCoverage, s.coverage);
+        }
+    }
+    return buckets;
+}
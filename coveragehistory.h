@@ -0,0 +1,54 @@
+#ifndef COVERAGEHISTORY_H
+#define COVERAGEHISTORY_H
+
+#include <vector>
+
+#include "ringbuffer.h"
+
+struct CoverageSample
+{
+    int time;        // simulated seconds since the run started
+    double coverage; // covered area at that time
+};
+
+// Min/max of the samples that fall into one display bucket
+struct CoverageBucket
+{
+    int startTime;
+    int endTime;
+    double minCoverage;
+    double maxCoverage;
+};
+
+// Coverage-over-time signal of a single run, sampled every sampleInterval
+// simulated seconds into a fixed-size ring buffer.
+class CoverageHistory
+{
+public:
+    // 200 minutes of battery at one sample per second
+    static constexpr int defaultCapacity = 12000;
+
+    explicit CoverageHistory(int capacity = defaultCapacity);
+
+    void setSampleInterval(int seconds);
+    int getSampleInterval() const;
+
+    // Records a sample when at least sampleInterval seconds passed since the last one
+    void record(int time, double coverage);
+    void append(const CoverageSample& sample);
+    void clear();
+
+    int size() const;
+    const CoverageSample& at(int i) const;
+    bool isEmpty() const;
+
+    // Splits the held time span into at most numBuckets buckets of min/max coverage
+    std::vector<CoverageBucket> downsample(int numBuckets) const;
+
+private:
+    RingBuffer<CoverageSample> samples;
+    int sampleInterval = 5;
+    int lastSampleTime = 0;
+};
+
+#endif // COVERAGEHISTORY_H
@@ -0,0 +1,226 @@
+#include "ensemble.h"
+#include "plateau.h"
+#include "resultcache.h"
+#include "trajectory.h"
+#include "vacuum.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QJsonDocument>
+
+#include <algorithm>
+
+EnsembleRunner::EnsembleRunner() {}
+
+EnsembleRunner::~EnsembleRunner()
+{
+    cancel();
+    wait();
+}
+
+void EnsembleRunner::setProgressCallback(JobGroup::ProgressCallback callback)
+{
+    progress = std::move(callback);
+}
+
+bool EnsembleRunner::start(const EnsembleSettings &newSettings)
+{
+    if (isRunning() || newSettings.algorithms.isEmpty() || newSettings.seedsPerAlgorithm <= 0) {
+        return false;
+    }
+
+    settings = newSettings;
+    total = settings.algorithms.size() * settings.seedsPerAlgorithm;
+
+    summaries.clear();
+    for (const QString &algorithm : settings.algorithms) {
+        EnsembleSummary summary;
+        summary.algorithm = algorithm;
+        summaries.append(summary);
+    }
+
+    int threads = settings.threadCount > 0 ? settings.threadCount : int(std::thread::hardware_concurrency());
+    scheduler = std::make_unique<JobScheduler>(std::max(1, std::min(threads, total)));
+    vacuums.clear();
+    vacuums.resize(scheduler->getThreadCount());
+    cache.reset();
+    if (!settings.cachePath.isEmpty()) {
+        cache = std::make_unique<ResultCache>(settings.cachePath, settings.cacheMaxBytes);
+    }
+
+    group = std::make_unique<JobGroup>();
+    group->setProgressCallback(progress);
+    for (int job = 0; job < total; job++) {
+        scheduler->submit(*group, [this, job](const CancellationToken &token) { runJob(job, token); });
+    }
+    return true;
+}
+
+void EnsembleRunner::cancel()
+{
+    if (group) group->cancel();
+}
+
+void EnsembleRunner::wait()
+{
+    if (group) group->wait();
+}
+
+bool EnsembleRunner::isRunning() const
+{
+    return group && !group->isFinished();
+}
+
+int EnsembleRunner::getCompleted() const
+{
+    return group ? int(group->getDone()) : 0;
+}
+
+int EnsembleRunner::getTotal() const
+{
+    return total;
+}
+
+QList<EnsembleSummary> EnsembleRunner::getSummaries() const
+{
+    std::lock_guard<std::mutex> lock(summaryMutex);
+    return summaries;
+}
+
+void EnsembleRunner::runJob(int job, const CancellationToken &token)
+{
+    std::unique_ptr<Vacuum> &vacuum = vacuums[JobScheduler::currentWorker()];
+    if (!vacuum) {
+        QString housePath = settings.housePath;
+        vacuum = std::make_unique<Vacuum>(nullptr);
+        vacuum->setHousePath(housePath);
+    }
+
+    // Jobs are interleaved by algorithm so partial results cover all of them
+    const int algorithmCount = settings.algorithms.size();
+    int algorithmIndex = job % algorithmCount;
+    quint64 seed = settings.baseSeed + quint64(job / algorithmCount);
+    EnsembleRunResult result = runCached(*vacuum, settings.algorithms[algorithmIndex], seed, settings, cache.get(), token);
+    if (token.isCancelled()) return;
+
+    std::lock_guard<std::mutex> lock(summaryMutex);
+    EnsembleSummary &summary = summaries[algorithmIndex];
+    summary.coverage.add(result.coverage);
+    summary.runtime.add(result.runtime);
+    summary.recleanRatio.add(result.recleanRatio);
+    summary.stuckTicks.add(result.stuck.stuckTicks);
+}
+
+void EnsembleRunner::prepare(Vacuum &vacuum, const QString &algorithm, quint64 seed,
+                             const EnsembleSettings &settings)
+{
+    // Same order as SimWindow::resetScene
+    vacuum.reset();
+    vacuum.setSeed(seed);
+    vacuum.setBatteryLife(settings.batteryLife);
+    vacuum.setVacuumEfficiency(settings.vacuumEfficiency);
+    vacuum.setWhiskerEfficiency(settings.whiskerEfficiency);
+    vacuum.setSpeed(settings.speed);
+    vacuum.setPathingAlgorithm(algorithm);
+    vacuum.setStuckAction(settings.stuckAction);
+    vacuum.setStrategyParams(settings.strategyParams);
+}
+
+EnsembleRunResult EnsembleRunner::resultOf(const Vacuum &vacuum, const QString &algorithm, quint64 seed,
+                                           const EnsembleSettings &settings, int plateauTime)
+{
+    EnsembleRunResult result;
+    result.algorithm = algorithm;
+    result.seed = seed;
+    result.coverage = vacuum.getCoveredArea();
+    result.runtime = settings.batteryLife * 60 - vacuum.getBatteryLife();
+    result.plateauTime = plateauTime;
+    result.stuck = vacuum.getStuckTelemetry();
+
+    const VisitGrid &grid = vacuum.getVisitGrid();
+    if (grid.getVisitedCells() > 0) {
+        result.recleanRatio = double(grid.getRevisitedCells()) / grid.getVisitedCells();
+    }
+    return result;
+}
+
+EnsembleRunResult EnsembleRunner::runOnce(Vacuum &vacuum, const QString &algorithm, quint64 seed,
+                                          const EnsembleSettings &settings, const CancellationToken &token)
+{
+    prepare(vacuum, algorithm, seed, settings);
+    PlateauDetector plateau(settings.plateauWindow, settings.plateauMinGain);
+    plateau.add(vacuum.getCoveredArea());
+    while (!vacuum.isFinished()) {
+        if (token.isCancelled()) break;
+        vacuum.updateMovementandTrail(nullptr);
+        if (plateau.add(vacuum.getCoveredArea())) break;
+    }
+    return resultOf(vacuum, algorithm, seed, settings, plateau.getPlateauTime());
+}
+
+bool EnsembleRunner::record(Vacuum &vacuum, const QString &algorithm, quint64 seed,
+                            const EnsembleSettings &settings, CachedRun &run, const CancellationToken &token)
+{
+    // The plan is embedded so the replay does not depend on the floorplan file
+    QFile planFile(vacuum.getHousePath());
+    QByteArray planJson;
+    if (planFile.open(QIODevice::ReadOnly)) {
+        planJson = QJsonDocument::fromJson(planFile.readAll()).toJson(QJsonDocument::Compact);
+    }
+
+    prepare(vacuum, algorithm, seed, settings);
+    TrajectoryWriter writer;
+    writer.begin(planJson.toStdString(), algorithm.toStdString());
+    auto append = [&]() {
+        std::vector<uint8_t> state;
+        if (writer.nextIsKeyframe()) state = vacuum.saveStrategyState();
+        const Vector2D &pos = vacuum.getPosition();
+        writer.append(pos.x, pos.y, vacuum.getStepEvents(), state);
+    };
+
+    PlateauDetector plateau(settings.plateauWindow, settings.plateauMinGain);
+    plateau.add(vacuum.getCoveredArea());
+    append();
+    while (!vacuum.isFinished()) {
+        if (token.isCancelled()) return false;
+        vacuum.updateMovementandTrail(nullptr);
+        append();
+        if (plateau.add(vacuum.getCoveredArea())) break;
+    }
+
+    run.metrics = resultOf(vacuum, algorithm, seed, settings, plateau.getPlateauTime());
+    run.coverage = vacuum.getVisitGrid();
+    run.trajectory = writer.finish();
+    return true;
+}
+
+bool EnsembleRunner::recordCached(Vacuum &vacuum, const QString &algorithm, quint64 seed,
+                                  const EnsembleSettings &settings, ResultCache *cache, CachedRun &run,
+                                  const CancellationToken &token)
+{
+    QString key;
+    if (cache) {
+        key = ResultCache::makeKey(vacuum.getPlanHash(), algorithm, seed, settings);
+        if (cache->load(key, run)) {
+            // The key ignores the name's case; report the name asked for
+            run.metrics.algorithm = algorithm;
+            return true;
+        }
+    }
+    if (!record(vacuum, algorithm, seed, settings, run, token)) return false;
+    if (cache) cache->store(key, run);
+    return true;
+}
+
+EnsembleRunResult EnsembleRunner::runCached(Vacuum &vacuum, const QString &algorithm, quint64 seed,
+                                            const EnsembleSettings &settings, ResultCache *cache,
+                                            const CancellationToken &token)
+{
+    if (!cache) return runOnce(vacuum, algorithm, seed, settings, token);
+
+    CachedRun run;
+    if (!recordCached(vacuum, algorithm, seed, settings, cache, run, token)) {
+        return EnsembleRunResult();     // cancelled; callers drop the result
+    }
+    return run.metrics;
+}
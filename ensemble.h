@@ -0,0 +1,130 @@
+#ifndef ENSEMBLE_H
+#define ENSEMBLE_H
+
+#include <QString>
+#include <QStringList>
+#include <QList>
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "jobscheduler.h"
+#include "runstats.h"
+#include "strategyparams.h"
+#include "stuckdetector.h"
+
+class Vacuum;
+class ResultCache;
+struct CachedRun;
+
+struct EnsembleSettings
+{
+    QString housePath;
+    QStringList algorithms;
+    int seedsPerAlgorithm = 100;
+    quint64 baseSeed = 1;
+
+    int batteryLife = 150;      // minutes
+    int vacuumEfficiency = 90;
+    int whiskerEfficiency = 30;
+    int speed = 12;
+
+    int threadCount = 0;        // 0 uses every core
+
+    // Ends a run early once the last plateauWindow simulated seconds added
+    // less than plateauMinGain sq. ft of coverage; 0 runs to an empty battery
+    int plateauWindow = 0;
+    double plateauMinGain = 1.0;
+
+    StuckAction stuckAction = StuckAction::Report;
+    StrategyParams strategyParams;      // tuned constants of the heuristic strategies
+
+    QString cachePath;          // result cache directory; empty runs everything
+    qint64 cacheMaxBytes = 512ll * 1024 * 1024;
+};
+
+struct EnsembleRunResult
+{
+    QString algorithm;
+    quint64 seed = 0;
+    double coverage = 0.0;      // sq. ft, as SimWindow reports it
+    int runtime = 0;            // simulated seconds
+    double recleanRatio = 0.0;  // share of covered cells passed over more than once
+    int plateauTime = -1;       // simulated seconds until coverage plateaued, -1 if it did not
+    StuckTelemetry stuck;
+};
+
+struct EnsembleSummary
+{
+    QString algorithm;
+    RunningStats coverage;
+    RunningStats runtime;
+    RunningStats recleanRatio;
+    RunningStats stuckTicks;
+};
+
+// Runs seedsPerAlgorithm headless simulations of every selected algorithm on
+// a JobScheduler. Each worker owns one Vacuum and loads the plan once;
+// results are folded into streaming statistics as runs finish, so summaries
+// can be read while the ensemble is still running.
+// Algorithm k with seed index i always uses seed baseSeed + i, so every
+// algorithm sees the same set of seeds.
+class EnsembleRunner
+{
+public:
+    EnsembleRunner();
+    ~EnsembleRunner();
+
+    // Runs on worker threads after each finished run; set before start()
+    void setProgressCallback(JobGroup::ProgressCallback callback);
+
+    bool start(const EnsembleSettings &settings);
+    void cancel();
+    void wait();
+
+    bool isRunning() const;
+    int getCompleted() const;
+    int getTotal() const;
+    QList<EnsembleSummary> getSummaries() const;
+
+    // Resets the vacuum and applies the settings, as SimWindow::resetScene does
+    static void prepare(Vacuum &vacuum, const QString &algorithm, quint64 seed, const EnsembleSettings &settings);
+    // Metrics of the vacuum's run so far
+    static EnsembleRunResult resultOf(const Vacuum &vacuum, const QString &algorithm, quint64 seed,
+                                      const EnsembleSettings &settings, int plateauTime = -1);
+
+    // One complete run on an already loaded vacuum
+    static EnsembleRunResult runOnce(Vacuum &vacuum, const QString &algorithm, quint64 seed,
+                                     const EnsembleSettings &settings,
+                                     const CancellationToken &token = CancellationToken());
+    // runOnce, also keeping the coverage raster and the trajectory; false if cancelled
+    static bool record(Vacuum &vacuum, const QString &algorithm, quint64 seed,
+                       const EnsembleSettings &settings, CachedRun &run,
+                       const CancellationToken &token = CancellationToken());
+    // record(), read from the cache when it holds the run and stored there
+    // otherwise; cache may be null
+    static bool recordCached(Vacuum &vacuum, const QString &algorithm, quint64 seed,
+                             const EnsembleSettings &settings, ResultCache *cache, CachedRun &run,
+                             const CancellationToken &token = CancellationToken());
+    // Metrics through the cache; a null cache makes this runOnce
+    static EnsembleRunResult runCached(Vacuum &vacuum, const QString &algorithm, quint64 seed,
+                                       const EnsembleSettings &settings, ResultCache *cache,
+                                       const CancellationToken &token = CancellationToken());
+
+private:
+    void runJob(int job, const CancellationToken &token);
+
+    EnsembleSettings settings;
+    JobGroup::ProgressCallback progress;
+    std::unique_ptr<JobScheduler> scheduler;
+    std::unique_ptr<JobGroup> group;
+    std::vector<std::unique_ptr<Vacuum>> vacuums;   // one per worker
+    std::unique_ptr<ResultCache> cache;
+    int total = 0;
+
+    mutable std::mutex summaryMutex;
+    QList<EnsembleSummary> summaries;
+};
+
+#endif // ENSEMBLE_H
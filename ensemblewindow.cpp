@@ -0,0 +1,109 @@
+#include "ensemblewindow.h"
+#include "ui_ensemblewindow.h"
+#include "resultcache.h"
+
+#include <QHeaderView>
+#include <QTableWidgetItem>
+
+EnsembleWindow::EnsembleWindow(QWidget *parent)
+    : QMainWindow(parent)
+    , ui(new Ui::EnsembleWindow)
+{
+    ui->setupUi(this);
+
+    ui->threadsLabel->setText(QString("Threads: %1").arg(std::thread::hardware_concurrency()));
+
+    QStringList headers = {"Algorithm", "Metric", "Runs", "Mean", "Std Dev", "Min", "P10", "Median", "P90", "Max"};
+    ui->resultsTable->setColumnCount(headers.size());
+    ui->resultsTable->setHorizontalHeaderLabels(headers);
+    ui->resultsTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    ui->resultsTable->verticalHeader()->setVisible(false);
+
+    // Progress arrives from worker threads; queue it onto the GUI thread
+    runner.setProgressCallback([this](int64_t done, int64_t) {
+        QMetaObject::invokeMethod(ui->progressBar, "setValue", Qt::QueuedConnection, Q_ARG(int, int(done)));
+    });
+
+    refreshTimer = new QTimer(this);
+    refreshTimer->setInterval(250);
+    connect(refreshTimer, &QTimer::timeout, this, &EnsembleWindow::updateResults);
+}
+
+EnsembleWindow::~EnsembleWindow()
+{
+    runner.cancel();
+    runner.wait();
+    delete ui;
+}
+
+void EnsembleWindow::setup(const QString &housePath, int batteryLife, int vacuumEfficiency,
+                           int whiskerEfficiency, int speed, const QStringList &algorithms,
+                           const StrategyParams &strategyParams)
+{
+    settings.housePath = housePath;
+    settings.batteryLife = batteryLife;
+    settings.vacuumEfficiency = vacuumEfficiency;
+    settings.whiskerEfficiency = whiskerEfficiency;
+    settings.speed = speed;
+    settings.algorithms = algorithms;
+    settings.strategyParams = strategyParams;
+    // Re-running an ensemble on an unchanged plan reads the seeds back
+    settings.cachePath = ResultCache::defaultDirectory();
+}
+
+void EnsembleWindow::on_startButton_clicked()
+{
+    if (runner.isRunning()) {
+        runner.cancel();
+        return;
+    }
+
+    settings.seedsPerAlgorithm = ui->seedsSpinBox->value();
+    if (!runner.start(settings)) return;
+
+    ui->progressBar->setRange(0, runner.getTotal());
+    ui->progressBar->setValue(0);
+    ui->startButton->setText("Cancel");
+    ui->seedsSpinBox->setEnabled(false);
+    refreshTimer->start();
+}
+
+void EnsembleWindow::updateResults()
+{
+    QList<EnsembleSummary> summaries = runner.getSummaries();
+
+    ui->resultsTable->setRowCount(summaries.size() * 3);
+    int row = 0;
+    for (const EnsembleSummary &summary : summaries) {
+        addStatsRow(row++, summary.algorithm, "Coverage (sq. ft)", summary.coverage, 1);
+        addStatsRow(row++, summary.algorithm, "Runtime (s)", summary.runtime, 0);
+        addStatsRow(row++, summary.algorithm, "Re-clean ratio", summary.recleanRatio, 3);
+    }
+
+    if (!runner.isRunning()) {
+        refreshTimer->stop();
+        runner.wait();
+        ui->startButton->setText("Start");
+        ui->seedsSpinBox->setEnabled(true);
+    }
+}
+
+void EnsembleWindow::addStatsRow(int row, const QString &algorithm, const QString &metric,
+                                 const RunningStats &stats, int precision)
+{
+    QStringList cells = {
+        algorithm,
+        metric,
+        QString::number(stats.getCount()),
+        QString::number(stats.getMean(), 'f', precision),
+        QString::number(stats.getStdDev(), 'f', precision),
+        QString::number(stats.getMin(), 'f', precision),
+        QString::number(stats.getQuantile(0.1), 'f', precision),
+        QString::number(stats.getMedian(), 'f', precision),
+        QString::number(stats.getQuantile(0.9), 'f', precision),
+        QString::number(stats.getMax(), 'f', precision)
+    };
+    for (int column = 0; column < cells.size(); column++) {
+        ui->resultsTable->setItem(row, column, new QTableWidgetItem(cells[column]));
+    }
+}
@@ -0,0 +1,42 @@
+#ifndef ENSEMBLEWINDOW_H
+#define ENSEMBLEWINDOW_H
+
+#include <QMainWindow>
+#include <QTimer>
+
+#include "ensemble.h"
+
+namespace Ui {
+class EnsembleWindow;
+}
+
+// Runs many seeds of the selected algorithms headlessly and shows the
+// aggregated coverage, runtime and re-clean statistics as they stream in.
+class EnsembleWindow : public QMainWindow
+{
+    Q_OBJECT
+
+public:
+    explicit EnsembleWindow(QWidget *parent = nullptr);
+    ~EnsembleWindow();
+
+    void setup(const QString &housePath, int batteryLife, int vacuumEfficiency,
+               int whiskerEfficiency, int speed, const QStringList &algorithms,
+               const StrategyParams &strategyParams = StrategyParams());
+
+private slots:
+    void on_startButton_clicked();
+    void updateResults();
+
+private:
+    Ui::EnsembleWindow *ui;
+
+    EnsembleSettings settings;
+    EnsembleRunner runner;
+    QTimer *refreshTimer;
+
+    void addStatsRow(int row, const QString &algorithm, const QString &metric,
+                     const RunningStats &stats, int precision);
+};
+
+#endif // ENSEMBLEWINDOW_H
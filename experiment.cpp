@@ -0,0 +1,334 @@
+#include "experiment.h"
+#include "columnar.h"
+#include "ensemble.h"
+#include "journal.h"
+#include "resultcache.h"
+#include "vacuum.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <memory>
+#include <mutex>
+
+namespace {
+enum ExperimentColumn
+{
+    ColumnJob,
+    ColumnPlan,
+    ColumnAlgorithm,
+    ColumnSeed,
+    ColumnBatteryLife,
+    ColumnVacuumEfficiency,
+    ColumnWhiskerEfficiency,
+    ColumnSpeed,
+    ColumnCoverage,
+    ColumnRuntime,
+    ColumnRecleanRatio,
+    ColumnPlateauTime,
+    ColumnStuckEvents,
+    ColumnOscillationEvents,
+    ColumnStuckTicks,
+    ColumnStuckRecoveries,
+    ColumnStuckAborted
+};
+
+// New columns go at the end: a results file from before them is carried
+// over on resume with the new columns at their fill (ColumnarWriter::openAppend)
+std::vector<ColumnInfo> resultColumns()
+{
+    return {
+        {"job", ColumnType::Int64},
+        {"plan", ColumnType::Int64},
+        {"algorithm", ColumnType::Int64},
+        {"seed", ColumnType::Int64},
+        {"battery_life", ColumnType::Int64},
+        {"vacuum_efficiency", ColumnType::Int64},
+        {"whisker_efficiency", ColumnType::Int64},
+        {"speed", ColumnType::Int64},
+        {"coverage", ColumnType::Double},
+        {"runtime", ColumnType::Int64},
+        {"reclean_ratio", ColumnType::Double},
+        {"plateau_time", ColumnType::Int64, -1.0},
+        {"stuck_events", ColumnType::Int64},
+        {"oscillation_events", ColumnType::Int64},
+        {"stuck_ticks", ColumnType::Int64},
+        {"stuck_recoveries", ColumnType::Int64},
+        {"stuck_aborted", ColumnType::Int64}
+    };
+}
+
+// Small groups keep the journal close behind the results
+const size_t resultRowGroupSize = 64;
+
+// A parameter may be given as 150, [90, 150] or "90:200:10"
+QString axisText(const QJsonValue &value)
+{
+    if (value.isDouble()) return QString::number(value.toInt());
+    if (value.isArray()) {
+        QStringList items;
+        for (const QJsonValue &item : value.toArray()) items << QString::number(item.toInt());
+        return items.join(',');
+    }
+    return value.toString();
+}
+
+QString axisString(const QList<int> &values)
+{
+    QStringList items;
+    for (int value : values) items << QString::number(value);
+    return items.join(',');
+}
+}
+
+bool ExperimentSpec::load(const QString &path, ExperimentSpec &spec, QString *error)
+{
+    auto fail = [&](const QString &message) {
+        if (error) *error = message;
+        return false;
+    };
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return fail("Cannot open " + path);
+    }
+    QJsonParseError parseError;
+    QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &parseError);
+    if (parseError.error != QJsonParseError::NoError) {
+        return fail(path + ": " + parseError.errorString());
+    }
+    QJsonObject root = doc.object();
+    QDir base = QFileInfo(path).absoluteDir();
+
+    ExperimentSpec loaded;
+    loaded.name = root.value("name").toString(QFileInfo(path).completeBaseName());
+
+    for (const QJsonValue &plan : root.value("plans").toArray()) {
+        loaded.plans << QDir::cleanPath(base.absoluteFilePath(plan.toString()));
+    }
+    if (loaded.plans.isEmpty()) return fail("The experiment lists no plans");
+
+    struct Axis { const char *key; int min; int max; QList<int> *values; };
+    const Axis axes[] = {
+        {"battery", 90, 200, &loaded.sweep.batteryLives},
+        {"vacuum", 10, 90, &loaded.sweep.vacuumEfficiencies},
+        {"whisker", 10, 50, &loaded.sweep.whiskerEfficiencies},
+        {"speed", 6, 18, &loaded.sweep.speeds}
+    };
+    for (const Axis &axis : axes) {
+        if (!root.contains(axis.key)) continue;
+        QString axisError;
+        if (!SweepSpec::parseAxis(axisText(root.value(axis.key)), axis.min, axis.max, *axis.values, &axisError)) {
+            return fail(QString(axis.key) + ": " + axisError);
+        }
+    }
+
+    if (root.contains("algorithms")) {
+        loaded.sweep.algorithms.clear();
+        for (const QJsonValue &algorithm : root.value("algorithms").toArray()) {
+            loaded.sweep.algorithms << algorithm.toString();
+        }
+    }
+    loaded.sweep.seeds = root.value("seeds").toInt(1);
+    loaded.sweep.baseSeed = quint64(root.value("base_seed").toDouble(1));
+    if (loaded.sweep.algorithms.isEmpty() || loaded.sweep.seeds <= 0) {
+        return fail("The experiment needs at least one algorithm and one seed");
+    }
+    loaded.sweep.plateauWindow = root.value("plateau_window").toInt(0);
+    loaded.sweep.plateauMinGain = root.value("plateau_min_gain").toDouble(1.0);
+    if (loaded.sweep.plateauWindow < 0) return fail("plateau_window must not be negative");
+    if (root.contains("stuck_action") &&
+        !stuckActionFromName(root.value("stuck_action").toString().toStdString(), loaded.sweep.stuckAction)) {
+        return fail("stuck_action must be report, recover or abort");
+    }
+    if (root.contains("profile")) {
+        StrategyProfile profile;
+        QString profileError;
+        if (!StrategyProfile::load(base.absoluteFilePath(root.value("profile").toString()), profile, &profileError)) {
+            return fail(profileError);
+        }
+        loaded.sweep.strategyParams = profile.params;
+    }
+
+    loaded.resultsPath = base.absoluteFilePath(root.value("results").toString(loaded.name + ".rscf"));
+    if (root.contains("journal")) {
+        loaded.journalPath = base.absoluteFilePath(root.value("journal").toString());
+    }
+    if (root.contains("cache")) {
+        loaded.cachePath = base.absoluteFilePath(root.value("cache").toString());
+        loaded.cacheMaxBytes = qint64(root.value("cache_size_mb").toDouble(512)) * 1024 * 1024;
+    }
+    loaded.threadCount = root.value("threads").toInt(0);
+
+    spec = loaded;
+    return true;
+}
+
+qint64 ExperimentSpec::getJobsPerPlan() const
+{
+    return sweep.getJobCount();
+}
+
+qint64 ExperimentSpec::getJobCount() const
+{
+    return getJobsPerPlan() * plans.size();
+}
+
+QString ExperimentSpec::getId() const
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    for (const QString &plan : plans) {
+        QFile file(plan);
+        if (file.open(QIODevice::ReadOnly)) hash.addData(file.readAll());
+        hash.addData(plan.toUtf8());
+    }
+    QStringList parts = {
+        axisString(sweep.batteryLives), axisString(sweep.vacuumEfficiencies),
+        axisString(sweep.whiskerEfficiencies), axisString(sweep.speeds),
+        sweep.algorithms.join(','), QString::number(sweep.seeds), QString::number(sweep.baseSeed)
+    };
+    if (sweep.plateauWindow > 0) {
+        parts << QString::number(sweep.plateauWindow) << QString::number(sweep.plateauMinGain, 'g', 17);
+    }
+    if (sweep.stuckAction != StuckAction::Report) parts << stuckActionName(sweep.stuckAction);
+    if (!sweep.strategyParams.isDefault()) parts << sweep.strategyParams.describe();
+    hash.addData(parts.join('|').toUtf8());
+    return QString::fromLatin1(hash.result().toHex());
+}
+
+bool ExperimentRunner::run(const ExperimentSpec &spec, const ProgressCallback &progress,
+                           const CancellationToken &token, QString *error)
+{
+    auto fail = [&](const QString &message) {
+        if (error) *error = message;
+        return false;
+    };
+
+    skipped = 0;
+    const qint64 perPlan = spec.getJobsPerPlan();
+    const qint64 total = spec.getJobCount();
+    if (total <= 0) return fail("The experiment has no jobs");
+
+    QJsonObject metadata;
+    metadata["name"] = spec.name;
+    metadata["plans"] = QJsonArray::fromStringList(spec.plans);
+    metadata["algorithms"] = QJsonArray::fromStringList(spec.sweep.algorithms);
+    metadata["jobs"] = total;
+    const std::string metadataJson = QJsonDocument(metadata).toJson(QJsonDocument::Compact).toStdString();
+
+    // Resume: the journal plus any rows that reached the results file before
+    // their group was journaled
+    RunJournal journal;
+    ColumnarWriter writer(resultRowGroupSize);
+    const bool resumable = !spec.journalPath.isEmpty();
+    if (resumable) {
+        std::string journalError;
+        if (!journal.open(spec.journalPath.toStdString(), spec.getId().toStdString(), total, &journalError)) {
+            return fail(QString::fromStdString(journalError));
+        }
+        ColumnarReader existing;
+        if (existing.open(spec.resultsPath.toStdString())) {
+            int jobColumn = existing.findColumn("job");
+            ColumnarRowGroup group;
+            while (jobColumn >= 0 && existing.nextRowGroup(group)) {
+                for (int64_t job : group.ints[jobColumn]) journal.markCompleted(job);
+            }
+        }
+        if (!writer.openAppend(spec.resultsPath.toStdString(), resultColumns(), metadataJson)) {
+            return fail("Cannot append to " + spec.resultsPath);
+        }
+    } else if (!writer.open(spec.resultsPath.toStdString(), resultColumns(), metadataJson)) {
+        return fail("Cannot write " + spec.resultsPath);
+    }
+
+    skipped = journal.getCompletedCount();
+    qint64 done = skipped;
+    if (progress) progress(done, total);
+
+    std::unique_ptr<ResultCache> cache;
+    if (!spec.cachePath.isEmpty()) {
+        cache = std::make_unique<ResultCache>(spec.cachePath, spec.cacheMaxBytes);
+    }
+
+    JobScheduler scheduler(spec.threadCount);
+    JobGroup group(token);
+
+    // One vacuum per worker, reloaded only when its jobs move to the next plan
+    struct WorkerVacuum { std::unique_ptr<Vacuum> vacuum; int plan = -1; };
+    std::vector<WorkerVacuum> vacuums(scheduler.getThreadCount());
+
+    std::mutex writerMutex;
+    std::vector<int64_t> unjournaled;
+
+    for (qint64 index = 0; index < total; index++) {
+        if (resumable && journal.isCompleted(index)) continue;
+
+        scheduler.submit(group, [&, index](const CancellationToken &cancel) {
+            const int plan = int(index / perPlan);
+            WorkerVacuum &worker = vacuums[JobScheduler::currentWorker()];
+            if (!worker.vacuum) worker.vacuum = std::make_unique<Vacuum>(nullptr);
+            if (worker.plan != plan) {
+                QString housePath = spec.plans[plan];
+                worker.vacuum->setHousePath(housePath);
+                worker.plan = plan;
+            }
+
+            SweepJob job = spec.sweep.jobAt(index % perPlan);
+            EnsembleSettings settings;
+            settings.batteryLife = job.batteryLife;
+            settings.vacuumEfficiency = job.vacuumEfficiency;
+            settings.whiskerEfficiency = job.whiskerEfficiency;
+            settings.speed = job.speed;
+            settings.plateauWindow = spec.sweep.plateauWindow;
+            settings.plateauMinGain = spec.sweep.plateauMinGain;
+            settings.stuckAction = spec.sweep.stuckAction;
+            settings.strategyParams = spec.sweep.strategyParams;
+            EnsembleRunResult result = EnsembleRunner::runCached(*worker.vacuum, job.algorithm, job.seed, settings,
+                                                                 cache.get(), cancel);
+            if (cancel.isCancelled()) return;     // a cut-short run is not a result
+
+            std::lock_guard<std::mutex> lock(writerMutex);
+            writer.setInt(ColumnJob, index);
+            writer.setInt(ColumnPlan, plan);
+            writer.setInt(ColumnAlgorithm, job.algorithmIndex);
+            writer.setInt(ColumnSeed, qint64(job.seed));
+            writer.setInt(ColumnBatteryLife, job.batteryLife);
+            writer.setInt(ColumnVacuumEfficiency, job.vacuumEfficiency);
+            writer.setInt(ColumnWhiskerEfficiency, job.whiskerEfficiency);
+            writer.setInt(ColumnSpeed, job.speed);
+            writer.setDouble(ColumnCoverage, result.coverage);
+            writer.setInt(ColumnRuntime, result.runtime);
+            writer.setDouble(ColumnRecleanRatio, result.recleanRatio);
+            writer.setInt(ColumnPlateauTime, result.plateauTime);
+            writer.setInt(ColumnStuckEvents, result.stuck.stuckEvents);
+            writer.setInt(ColumnOscillationEvents, result.stuck.oscillationEvents);
+            writer.setInt(ColumnStuckTicks, result.stuck.stuckTicks);
+            writer.setInt(ColumnStuckRecoveries, result.stuck.recoveries);
+            writer.setInt(ColumnStuckAborted, result.stuck.aborted);
+            writer.commitRow();
+
+            unjournaled.push_back(index);
+            if (writer.getBufferedRows() == 0) {
+                // The group holding these rows was just written
+                if (resumable) journal.append(unjournaled);
+                unjournaled.clear();
+            }
+
+            done++;
+            if (progress) progress(done, total);
+        });
+    }
+
+    group.wait();
+    writer.flush();
+    if (resumable) journal.append(unjournaled);
+    writer.close();
+
+    if (token.isCancelled()) return fail("Interrupted; rerun to resume");
+    return true;
+}
@@ -0,0 +1,83 @@
+#ifndef EXPERIMENT_H
+#define EXPERIMENT_H
+
+#include <QString>
+#include <QStringList>
+
+#include "jobscheduler.h"
+#include "sweep.h"
+
+// A batch of sweeps described by a JSON file, in the same spirit as the
+// floorplan files:
+//
+// {
+//     "name": "speed-vs-battery",
+//     "plans": ["default_plan.json"],
+//     "battery": "90:200:10",
+//     "vacuum": 90,
+//     "whisker": [10, 30, 50],
+//     "speed": "6,12,18",
+//     "algorithms": ["Random", "Spiral"],
+//     "seeds": 20,
+//     "base_seed": 1,
+//     "results": "speed-vs-battery.rscf",
+//     "journal": "speed-vs-battery.journal",
+//     "cache": "result-cache",
+//     "cache_size_mb": 512,
+//     "plateau_window": 600,
+//     "plateau_min_gain": 5,
+//     "stuck_action": "recover",
+//     "profile": "spiral-tuned.json",
+//     "threads": 0
+// }
+//
+// Parameters take a number, an array or a range string (see
+// SweepSpec::parseAxis). Relative paths are resolved against the spec file.
+// With a cache directory, runs already in the result cache (resultcache.h)
+// are read back instead of simulated. With a plateau window (simulated
+// seconds) a run ends once that long added less than plateau_min_gain sq. ft
+// of coverage, and the plateau_time column records when the flat stretch began.
+// stuck_action says what a vacuum caught stuck or oscillating does: "report"
+// (the default), "recover" or "abort"; the stuck_* columns count the cases.
+// profile names a tuned strategy profile (strategyparams.h) to run with.
+// The same sweep is run on every plan; job indices run through the plans in
+// order.
+struct ExperimentSpec
+{
+    QString name;
+    QStringList plans;
+    SweepSpec sweep;            // axes, algorithms and seeds; housePath is set per plan
+    QString resultsPath;
+    QString journalPath;        // empty: no journal, nothing to resume
+    QString cachePath;          // empty: no result cache
+    qint64 cacheMaxBytes = 512ll * 1024 * 1024;
+    int threadCount = 0;
+
+    static bool load(const QString &path, ExperimentSpec &spec, QString *error = nullptr);
+
+    qint64 getJobsPerPlan() const;
+    qint64 getJobCount() const;
+    // Identifies the work, not where it is written or how many threads run
+    // it; a journal is only resumed by a spec with the same id
+    QString getId() const;
+};
+
+// Runs an experiment, skipping jobs already in its journal. Rows go to the
+// results file in small row groups and each group's jobs are journaled once
+// the group is on disk, so an interrupted run loses at most the jobs that
+// were in flight. Cancelling the token stops the run after the running jobs.
+class ExperimentRunner
+{
+public:
+    using ProgressCallback = std::function<void(qint64 done, qint64 total)>;
+
+    bool run(const ExperimentSpec &spec, const ProgressCallback &progress = nullptr,
+             const CancellationToken &token = CancellationToken(), QString *error = nullptr);
+
+    qint64 getSkipped() const { return skipped; }
+
+private:
+    qint64 skipped = 0;
+};
+
+#endif // EXPERIMENT_H
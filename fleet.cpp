@@ -0,0 +1,311 @@
+#include "fleet.h"
+#include "compiledplan.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+void RobotIndex::reset(double left, double top, double right, double bottom, double size)
+{
+    bucketSize = size > 0.0 ? size : 1.0;
+    originX = std::min(left, right);
+    originY = std::min(top, bottom);
+    width = std::max(1, int(std::ceil(std::abs(right - left) / bucketSize)));
+    height = std::max(1, int(std::ceil(std::abs(bottom - top) / bucketSize)));
+    positions.clear();
+    entries.clear();
+    bucketStarts.assign(size_t(width) * height + 1, 0);
+}
+
+int RobotIndex::bucketOf(double x, double y) const
+{
+    // Robots off the grid share its edge buckets
+    const int bx = std::clamp(int(std::floor((x - originX) / bucketSize)), 0, width - 1);
+    const int by = std::clamp(int(std::floor((y - originY) / bucketSize)), 0, height - 1);
+    return by * width + bx;
+}
+
+void RobotIndex::rebuild(const std::vector<Vector2D>& newPositions, double radius)
+{
+    positions = newPositions;
+    robotRadius = radius;
+
+    // Counting sort of the robots by bucket
+    std::fill(bucketStarts.begin(), bucketStarts.end(), 0);
+    for (const Vector2D& pos : positions) bucketStarts[bucketOf(pos.x, pos.y) + 1]++;
+    for (size_t b = 1; b < bucketStarts.size(); b++) bucketStarts[b] += bucketStarts[b - 1];
+    entries.assign(positions.size(), 0);
+    std::vector<int> fill(bucketStarts.begin(), bucketStarts.end() - 1);
+    for (int robot = 0; robot < int(positions.size()); robot++) {
+        entries[fill[bucketOf(positions[robot].x, positions[robot].y)]++] = robot;
+    }
+}
+
+int RobotIndex::blocker(const Vector2D& from, const Vector2D& to, double radius, int self) const
+{
+    const double reach = radius + robotRadius;
+    const int home = bucketOf(to.x, to.y);
+    const int hx = home % width;
+    const int hy = home / width;
+    const int span = int(std::ceil(reach / bucketSize));
+    int found = -1;
+    for (int by = std::max(0, hy - span); by <= std::min(height - 1, hy + span); by++) {
+        for (int bx = std::max(0, hx - span); bx <= std::min(width - 1, hx + span); bx++) {
+            const int bucket = by * width + bx;
+            for (int e = bucketStarts[bucket]; e < bucketStarts[bucket + 1]; e++) {
+                const int robot = entries[e];
+                if (robot == self || (found >= 0 && robot > found)) continue;
+                const Vector2D& other = positions[robot];
+                const double after = (other.x - to.x) * (other.x - to.x) + (other.y - to.y) * (other.y - to.y);
+                const double before = (other.x - from.x) * (other.x - from.x) + (other.y - from.y) * (other.y - from.y);
+                if (after < reach * reach && after < before) found = robot;
+            }
+        }
+    }
+    return found;
+}
+
+Fleet::Fleet(int threadCount)
+{
+    const int threads = threadCount > 0 ? threadCount : int(std::thread::hardware_concurrency());
+    if (threads > 1) scheduler = std::make_unique<JobScheduler>(threads);
+}
+
+Fleet::~Fleet() {}
+
+quint64 Fleet::robotSeed(quint64 seed, int robot)
+{
+    return seed + quint64(robot) * 0x9E3779B97F4A7C15ull;
+}
+
+bool Fleet::load(const QString& housePath, int robotCount)
+{
+    if (robotCount <= 0) return false;
+    robots.clear();
+    QString path = housePath;
+    robots.push_back(std::make_unique<Vacuum>(nullptr));
+    robots[0]->setHousePath(path);
+    if (!robots[0]->getCompiledPlan()) return false;
+    // The others share the first one's plan
+    for (int robot = 1; robot < robotCount; robot++) robots.push_back(robots[0]->fork());
+
+    placeStarts(robotCount);
+    for (int robot = 0; robot < robotCount; robot++) {
+        robots[robot]->setStartPosition(starts[robot]);
+        robots[robot]->setSharedCoverage(&coverage);
+        robots[robot]->setRobotIndex(&robotIndex, robot);
+    }
+    robotContacts.assign(robotCount, 0);
+    idleTicks.assign(robotCount, 0);
+    return true;
+}
+
+void Fleet::placeStarts(int robotCount)
+{
+    const CompiledPlan& plan = *robots[0]->getCompiledPlan();
+    const CollisionSystem& system = robots[0]->getCollisionSystem();
+    starts.assign(1, system.getVacuumStartPosition());
+    for (const Vector2D& start : system.getAdditionalStartPositions()) {
+        if (int(starts.size()) == robotCount) break;
+        starts.push_back(start);
+    }
+    if (int(starts.size()) == robotCount) return;
+
+    // Free squares reachable from the first start
+    const int width = plan.getGridWidth();
+    const int height = plan.getGridHeight();
+    std::vector<uint8_t> reachable(size_t(width) * height, 0);
+    std::vector<int> stack;
+    const int first = plan.nearestFree(starts[0], plan.getRobotRadius() + 4 * CompiledPlan::gridCellSize);
+    if (first >= 0) {
+        reachable[first] = 1;
+        stack.push_back(first);
+    }
+    while (!stack.empty()) {
+        const int index = stack.back();
+        stack.pop_back();
+        const int x = index % width;
+        const int y = index / width;
+        const int next[4][2] = {{x + 1, y}, {x - 1, y}, {x, y + 1}, {x, y - 1}};
+        for (const auto& n : next) {
+            if (!plan.isFree(n[0], n[1]) || reachable[size_t(n[1]) * width + n[0]]) continue;
+            reachable[size_t(n[1]) * width + n[0]] = 1;
+            stack.push_back(n[1] * width + n[0]);
+        }
+    }
+
+    // Farthest-point placement; ties go to the lower square
+    std::vector<double> nearest(reachable.size(), std::numeric_limits<double>::infinity());
+    auto account = [&](const Vector2D& start) {
+        for (size_t index = 0; index < reachable.size(); index++) {
+            if (!reachable[index]) continue;
+            const Vector2D centre = plan.gridCentre(int(index));
+            nearest[index] = std::min(nearest[index], std::hypot(centre.x - start.x, centre.y - start.y));
+        }
+    };
+    for (const Vector2D& start : starts) account(start);
+    while (int(starts.size()) < robotCount) {
+        int best = -1;
+        for (size_t index = 0; index < reachable.size(); index++) {
+            if (reachable[index] && (best < 0 || nearest[index] > nearest[best])) best = int(index);
+        }
+        // Nowhere left to go: stack the rest on the first start
+        const Vector2D start = best >= 0 ? plan.gridCentre(best) : starts[0];
+        starts.push_back(start);
+        account(start);
+    }
+}
+
+void Fleet::forEach(int count, const std::function<void(int)>& job)
+{
+    if (!scheduler || count <= 1) {
+        for (int i = 0; i < count; i++) job(i);
+        return;
+    }
+    JobGroup group;
+    for (int i = 0; i < count; i++) {
+        scheduler->submit(group, [&job, i](const CancellationToken&) { job(i); });
+    }
+    group.wait();
+}
+
+void Fleet::start(const QString& newAlgorithm, quint64 newSeed, const EnsembleSettings& newSettings)
+{
+    algorithm = newAlgorithm;
+    seed = newSeed;
+    settings = newSettings;
+    ticks = 0;
+    std::fill(robotContacts.begin(), robotContacts.end(), 0);
+    std::fill(idleTicks.begin(), idleTicks.end(), 0);
+
+    partition = RoomPartition();
+    if (partitioned) {
+        const Vacuum& first = *robots[0];
+        RoomPartitioner partitioner(*first.getCompiledPlan(), *first.getRoomGraph());
+        // Lanes as boustrophedon lays them. The planning strategies cross
+        // other rooms between theirs; the others keep to their rooms.
+        const bool planning = Vacuum::isPlanningStrategy(algorithm, settings.strategyParams);
+        partition = partitioner.partition(starts, 2.0 * first.getCompiledPlan()->getRobotRadius() - 1.0, !planning);
+    }
+    for (int robot = 0; robot < getRobotCount(); robot++) {
+        EnsembleRunner::prepare(*robots[robot], algorithm, robotSeed(seed, robot), settings);
+        robots[robot]->setRoomPartition(partitioned ? partition.rooms[robot] : std::vector<int>());
+    }
+
+    // Same geometry as the robots' own rasters
+    coverage = robots[0]->getVisitGrid();
+    coverage.clear();
+    const double radius = robots[0]->getCompiledPlan()->getRobotRadius();
+    for (const Vector2D& start : starts) coverage.stampDisc(start.x, start.y, radius);
+    cleanedPoints.reset(coverage.getOriginX(), coverage.getOriginY(),
+                        coverage.getOriginX() + coverage.getWidth() * coverage.getCellSize(),
+                        coverage.getOriginY() + coverage.getHeight() * coverage.getCellSize());
+
+    robotIndex.reset(coverage.getOriginX(), coverage.getOriginY(),
+                     coverage.getOriginX() + coverage.getWidth() * coverage.getCellSize(),
+                     coverage.getOriginY() + coverage.getHeight() * coverage.getCellSize(), 4.0 * radius);
+}
+
+void Fleet::step()
+{
+    if (isFinished()) return;
+    const int count = getRobotCount();
+    const double radius = robots[0]->getCompiledPlan()->getRobotRadius();
+
+    // 1) Everyone moves against where the others stood
+    positions.resize(count);
+    for (int robot = 0; robot < count; robot++) positions[robot] = robots[robot]->getPosition();
+    robotIndex.rebuild(positions, radius);
+    forEach(count, [&](int robot) { robots[robot]->updateMovementandTrail(nullptr); });
+
+    // 2) Stamp the swept paths, a band of tile rows per job, with a tally
+    //    per band and robot
+    const int bandRows = TiledRaster<uint16_t>::tileSize;
+    const int bands = (coverage.getHeight() + bandRows - 1) / bandRows;
+    std::vector<VisitGrid::Tally> tallies(size_t(bands) * count);
+    forEach(bands, [&](int band) {
+        const int firstRow = band * bandRows;
+        const int lastRow = std::min(coverage.getHeight(), firstRow + bandRows) - 1;
+        const double top = coverage.getOriginY() + firstRow * coverage.getCellSize() - radius;
+        const double bottom = coverage.getOriginY() + (lastRow + 1) * coverage.getCellSize() + radius;
+        for (int robot = 0; robot < count; robot++) {
+            const std::vector<Vector2D>& path = robots[robot]->getTickPath();
+            for (size_t i = 1; i < path.size(); i++) {
+                if (std::max(path[i - 1].y, path[i].y) < top || std::min(path[i - 1].y, path[i].y) > bottom) continue;
+                coverage.stampSegment(path[i - 1].x, path[i - 1].y, path[i].x, path[i].y, radius,
+                                      firstRow, lastRow, tallies[size_t(band) * count + robot]);
+            }
+        }
+    });
+    std::vector<int> sweptCells(count, 0);
+    for (size_t i = 0; i < tallies.size(); i++) {
+        coverage.addTally(tallies[i]);
+        sweptCells[i % count] += tallies[i].visitedCells;
+    }
+
+    // 3) Everyone catches up with what the others swept
+    struct Box { double left, top, right, bottom; };
+    std::vector<Box> boxes;
+    const double margin = radius + coverage.getCellSize();
+    for (int robot = 0; robot < count; robot++) {
+        if (sweptCells[robot] == 0) idleTicks[robot]++;
+        const std::vector<Vector2D>& path = robots[robot]->getTickPath();
+        if (path.empty()) continue;
+        Box box = {path[0].x, path[0].y, path[0].x, path[0].y};
+        for (const Vector2D& p : path) {
+            box.left = std::min(box.left, p.x);
+            box.top = std::min(box.top, p.y);
+            box.right = std::max(box.right, p.x);
+            box.bottom = std::max(box.bottom, p.y);
+        }
+        boxes.push_back({box.left - margin, box.top - margin, box.right + margin, box.bottom + margin});
+
+        // Covered area, counted as one vacuum counts it, robots in order
+        const Vector2D& at = robots[robot]->getPosition();
+        cleanedPoints.add(at.x, at.y);
+        if (robots[robot]->wasBlockedByRobot()) robotContacts[robot]++;
+    }
+    forEach(count, [&](int robot) {
+        for (const Box& box : boxes) robots[robot]->refreshCoverage(box.left, box.top, box.right, box.bottom);
+    });
+    ticks++;
+}
+
+bool Fleet::isFinished() const
+{
+    for (const auto& robot : robots) {
+        if (!robot->isFinished()) return false;
+    }
+    return true;
+}
+
+FleetResult Fleet::getResult() const
+{
+    FleetResult result;
+    result.algorithm = algorithm;
+    result.seed = seed;
+    result.coverage = getCoveredArea();
+    result.runtime = ticks;
+    if (coverage.getVisitedCells() > 0) {
+        result.recleanRatio = double(coverage.getRevisitedCells()) / coverage.getVisitedCells();
+    }
+    for (int robot = 0; robot < getRobotCount(); robot++) {
+        FleetRobotResult robotResult;
+        robotResult.coverage = robots[robot]->getCoveredArea();
+        robotResult.robotContacts = robotContacts[robot];
+        robotResult.idleTicks = idleTicks[robot];
+        robotResult.rooms = robots[robot]->getRoomPartition();
+        robotResult.stuck = robots[robot]->getStuckTelemetry();
+        result.robotContacts += robotContacts[robot];
+        result.robots.push_back(robotResult);
+    }
+    return result;
+}
+
+FleetResult Fleet::run(const QString& newAlgorithm, quint64 newSeed, const EnsembleSettings& newSettings,
+                       const CancellationToken& token)
+{
+    start(newAlgorithm, newSeed, newSettings);
+    while (!isFinished() && !token.isCancelled()) step();
+    return getResult();
+}
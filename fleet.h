@@ -0,0 +1,143 @@
+#ifndef FLEET_H
+#define FLEET_H
+
+#include <QString>
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "cleanedpoints.h"
+#include "ensemble.h"
+#include "jobscheduler.h"
+#include "partitioner.h"
+#include "vacuum.h"
+#include "visitgrid.h"
+
+// Where the robots of a fleet stand, bucketed on a coarse grid so a move is
+// checked against the robots near it rather than every robot. Rebuilt once
+// a tick and only read while the robots step.
+class RobotIndex
+{
+public:
+    void reset(double left, double top, double right, double bottom, double bucketSize);
+    void rebuild(const std::vector<Vector2D>& positions, double robotRadius);
+    // Lowest-numbered robot other than self that a disc of radius moving
+    // from -> to would run into, or -1. Moving away from a robot it already
+    // overlaps is allowed, so robots placed on top of each other can part.
+    int blocker(const Vector2D& from, const Vector2D& to, double radius, int self) const;
+
+private:
+    int bucketOf(double x, double y) const;
+
+    double originX = 0.0;
+    double originY = 0.0;
+    double bucketSize = 1.0;
+    int width = 1;
+    int height = 1;
+    double robotRadius = 0.0;
+    std::vector<Vector2D> positions;
+    std::vector<int> bucketStarts;      // robots of bucket b: entries[bucketStarts[b] .. bucketStarts[b + 1])
+    std::vector<int> entries;
+};
+
+struct FleetRobotResult
+{
+    double coverage = 0.0;      // sq. ft this robot alone would report
+    int robotContacts = 0;      // ticks another robot blocked its move
+    // Ticks before the fleet stopped in which it swept no floor the fleet
+    // had not: waiting with an empty battery, or going over clean floor
+    int idleTicks = 0;
+    std::vector<int> rooms;     // its partition, empty when not partitioned
+    StuckTelemetry stuck;
+};
+
+struct FleetResult
+{
+    QString algorithm;
+    quint64 seed = 0;
+    double coverage = 0.0;      // sq. ft the fleet covered together
+    int runtime = 0;            // simulated seconds until the last robot stopped
+    double recleanRatio = 0.0;  // of the shared coverage raster
+    int robotContacts = 0;
+    std::vector<FleetRobotResult> robots;
+};
+
+// K vacuums cleaning one plan together. Every robot runs the same strategy
+// with its own seed and battery; they share the plan and one coverage
+// raster, which the strategies read, and block each other as walls do.
+// When two robots meet, the higher-numbered one gives way with a short
+// random walk, so two planners heading for the same spot cannot deadlock.
+//
+// A tick runs in three parallel passes on a JobScheduler, in an order that
+// makes the result independent of the thread count:
+//   1. every robot steps, seeing the others where they stood when the tick
+//      began (RobotIndex) and the shared raster as the last tick left it;
+//   2. the paths the robots swept are stamped into the shared raster, one
+//      job per band of tile rows, each band taking the robots in order, so
+//      no two jobs write the same tile;
+//   3. every robot re-reads the parts of the raster the others changed.
+// Robot k starts at the plan's vacuum_pos for k = 0, then at its
+// additional_vacuum_pos entries; any further robots start on free floor as
+// far as possible from the ones placed before them. With one robot a fleet
+// run is the single-vacuum run with the same seed.
+//
+// Partitioned, the plan's rooms are split among the robots by a
+// RoomPartitioner from their starts, and each robot cleans only its own;
+// for the heuristic strategies, which never leave their rooms, each robot's
+// rooms are kept joined by doors. Otherwise every robot cleans everywhere.
+class Fleet
+{
+public:
+    explicit Fleet(int threadCount = 0);
+    ~Fleet();
+
+    bool load(const QString& housePath, int robotCount);
+    // Takes effect at the next start()
+    void setPartitioned(bool enabled) { partitioned = enabled; }
+    bool isPartitioned() const { return partitioned; }
+    // The last start()'s partition; empty when not partitioned
+    const RoomPartition& getPartition() const { return partition; }
+    int getRobotCount() const { return int(robots.size()); }
+    const Vacuum& getRobot(int robot) const { return *robots[robot]; }
+    const std::vector<Vector2D>& getStarts() const { return starts; }
+
+    void start(const QString& algorithm, quint64 seed, const EnsembleSettings& settings);
+    void step();
+    // Every robot's battery is empty or its run aborted
+    bool isFinished() const;
+
+    const VisitGrid& getCoverage() const { return coverage; }
+    double getCoveredArea() const { return cleanedPoints.size(); }
+    FleetResult getResult() const;
+
+    // start(), then steps until finished or cancelled
+    FleetResult run(const QString& algorithm, quint64 seed, const EnsembleSettings& settings,
+                    const CancellationToken& token = CancellationToken());
+
+    // Seed of robot k in a fleet run with seed; robot 0 keeps it
+    static quint64 robotSeed(quint64 seed, int robot);
+
+private:
+    void placeStarts(int robotCount);
+    void forEach(int count, const std::function<void(int)>& job);
+
+    std::unique_ptr<JobScheduler> scheduler;    // null when stepping on the calling thread
+    std::vector<std::unique_ptr<Vacuum>> robots;
+    std::vector<Vector2D> starts;
+    RobotIndex robotIndex;
+    std::vector<Vector2D> positions;
+
+    VisitGrid coverage;
+    CleanedPoints cleanedPoints;
+    std::vector<int> robotContacts;
+    std::vector<int> idleTicks;
+    bool partitioned = false;
+    RoomPartition partition;
+    QString algorithm;
+    quint64 seed = 0;
+    EnsembleSettings settings;
+    int ticks = 0;
+};
+
+#endif // FLEET_H
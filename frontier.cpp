@@ -0,0 +1,222 @@
+#include "frontier.h"
+#include "roomgraph.h"
+#include "visitgrid.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+const int stepX[4] = {1, -1, 0, 0};
+const int stepY[4] = {0, 0, 1, -1};
+}
+
+FrontierMap::FrontierMap(std::shared_ptr<const CompiledPlan> compiled)
+    : plan(std::move(compiled))
+    , width(plan->getGridWidth())
+    , height(plan->getGridHeight())
+    , covered(size_t(width) * height, 0)
+    , slots(size_t(width) * height, -1)
+    , components(size_t(width) * height, -1)
+    , rooms(size_t(width) * height, -1)
+{
+    // Label the components by flood fill
+    int label = 0;
+    std::vector<int> stack;
+    for (int start = 0; start < width * height; start++) {
+        if (components[start] >= 0 || !plan->isFree(start % width, start / width)) continue;
+        components[start] = label;
+        stack.push_back(start);
+        while (!stack.empty()) {
+            const int index = stack.back();
+            stack.pop_back();
+            for (int d = 0; d < 4; d++) {
+                const int nx = index % width + stepX[d];
+                const int ny = index / width + stepY[d];
+                const int next = ny * width + nx;
+                if (plan->isFree(nx, ny) && components[next] < 0) {
+                    components[next] = label;
+                    stack.push_back(next);
+                }
+            }
+        }
+        label++;
+    }
+
+    for (int index = 0; index < width * height; index++) {
+        if (components[index] >= 0) rooms[index] = int16_t(plan->roomAt(plan->gridCentre(index)));
+    }
+    roomFrontiers.assign(plan->getRooms().size() + 1, 0);
+}
+
+void FrontierMap::rebuild(const VisitGrid& grid)
+{
+    reread(grid, 0, 0, width - 1, height - 1);
+}
+
+void FrontierMap::update(const VisitGrid& grid, double left, double top, double right, double bottom)
+{
+    // Squares whose centres fall inside the box
+    const Vector2D origin = plan->gridCentre(0);
+    const double size = CompiledPlan::gridCellSize;
+    reread(grid, std::max(0, int(std::ceil((left - origin.x) / size))),
+           std::max(0, int(std::ceil((top - origin.y) / size))),
+           std::min(width - 1, int(std::floor((right - origin.x) / size))),
+           std::min(height - 1, int(std::floor((bottom - origin.y) / size))));
+}
+
+void FrontierMap::reread(const VisitGrid& grid, int x0, int y0, int x1, int y1)
+{
+    const Vector2D origin = plan->gridCentre(0);
+    const double size = CompiledPlan::gridCellSize;
+    for (int y = y0; y <= y1; y++) {
+        for (int x = x0; x <= x1; x++) {
+            const int index = y * width + x;
+            if (components[index] < 0) continue;
+            const Vector2D centre = {origin.x + x * size, origin.y + y * size};
+            const uint8_t now = grid.getCountAt(centre.x, centre.y) > 0;
+            if (now == covered[index]) continue;
+            covered[index] = now;
+            if (now) flips++;
+            refresh(index);
+            for (int d = 0; d < 4; d++) {
+                const int nx = x + stepX[d];
+                const int ny = y + stepY[d];
+                if (plan->isFree(nx, ny)) refresh(ny * width + nx);
+            }
+        }
+    }
+}
+
+bool FrontierMap::isOpen(int x, int y) const
+{
+    return plan->isFree(x, y) && !covered[size_t(y) * width + x];
+}
+
+void FrontierMap::refresh(int index)
+{
+    const int x = index % width;
+    const int y = index / width;
+    bool frontier = false;
+    if (covered[index]) {
+        for (int d = 0; d < 4 && !frontier; d++) {
+            frontier = isOpen(x + stepX[d], y + stepY[d]);
+        }
+    }
+
+    if (frontier && slots[index] < 0) {
+        slots[index] = int32_t(frontiers.size());
+        frontiers.push_back(index);
+        roomFrontiers[rooms[index] + 1]++;
+    } else if (!frontier && slots[index] >= 0) {
+        // Swap the last entry into the hole
+        const int moved = frontiers.back();
+        frontiers[slots[index]] = moved;
+        slots[moved] = slots[index];
+        frontiers.pop_back();
+        slots[index] = -1;
+        roomFrontiers[rooms[index] + 1]--;
+    }
+}
+
+int FrontierMap::nearest(const Vector2D& pos, const RoomGraph* graph, const std::vector<char>* allowedRooms) const
+{
+    const int from = plan->nearestFree(pos, plan->getRobotRadius() + 4 * CompiledPlan::gridCellSize);
+    if (from < 0) return -1;
+    const int component = components[from];
+    const int room = rooms[from];
+    const int x = from % width;
+    const int y = from / width;
+    auto allowed = [&](int r) { return !allowedRooms || (r >= 0 && (*allowedRooms)[r]); };
+
+    // Compared as (squared grid distance, index)
+    int best = -1;
+    int64_t bestScore = std::numeric_limits<int64_t>::max();
+    auto consider = [&](int index) {
+        const int64_t dx = index % width - x;
+        const int64_t dy = index / width - y;
+        const int64_t score = dx * dx + dy * dy;
+        if (score < bestScore || (score == bestScore && index < best)) {
+            bestScore = score;
+            best = index;
+        }
+    };
+
+    // Finishing the current room first saves crossing back for its
+    // leftovers. Its frontiers are usually a few squares off, so search
+    // rings outwards; a ring past the first hit can still hold a closer one.
+    if (roomFrontiers[room + 1] > 0 && allowed(room)) {
+        int lastRing = std::max(width, height);
+        for (int r = 0; r <= lastRing; r++) {
+            for (int sy = y - r; sy <= y + r; sy++) {
+                if (sy < 0 || sy >= height) continue;
+                const int step = (sy == y - r || sy == y + r) ? 1 : 2 * r;
+                for (int sx = x - r; sx <= x + r; sx += std::max(1, step)) {
+                    if (sx < 0 || sx >= width) continue;
+                    const int index = sy * width + sx;
+                    if (slots[index] < 0 || components[index] != component || rooms[index] != room) continue;
+                    consider(index);
+                    lastRing = std::min(lastRing, int(std::ceil(r * std::sqrt(2.0))));
+                }
+            }
+        }
+        if (best >= 0) return best;
+    }
+
+    if (graph && room >= 0) {
+        std::vector<int> open;
+        for (int r = 0; r + 1 < int(roomFrontiers.size()); r++) {
+            if (roomFrontiers[r + 1] > 0 && allowed(r)) open.push_back(r);
+        }
+        for (int next : graph->tour(room, open)) {
+            for (int index : frontiers) {
+                if (components[index] == component && rooms[index] == next) consider(index);
+            }
+            if (best >= 0) return best;
+        }
+    }
+
+    for (int index : frontiers) {
+        if (components[index] == component && allowed(rooms[index])) consider(index);
+    }
+    return best;
+}
+
+int FrontierMap::runLength(int x, int y, int dx, int dy, int limit) const
+{
+    int n = 0;
+    while (n < limit && isOpen(x + dx * (n + 1), y + dy * (n + 1))) n++;
+    return n;
+}
+
+Vector2D FrontierMap::target(int frontier, double maxLength) const
+{
+    const int fx = frontier % width;
+    const int fy = frontier / width;
+    int d = 0;
+    while (d < 3 && !isOpen(fx + stepX[d], fy + stepY[d])) d++;
+
+    // Step off the covered edge until the swath just meets it
+    const int inset = std::max(0, int(plan->getRobotRadius() / CompiledPlan::gridCellSize) - 1);
+    const int x = fx + stepX[d];
+    const int y = fy + stepY[d];
+    const int in = runLength(x, y, stepX[d], stepY[d], inset);
+    const int px = x + stepX[d] * in;
+    const int py = y + stepY[d] * in;
+
+    // Then run along the edge, the longer way, or straight on if the
+    // edge leaves no room
+    const int limit = std::max(1, int(maxLength / CompiledPlan::gridCellSize));
+    const int side = d < 2 ? 2 : 0;
+    int bestDirection = d;
+    int bestRun = runLength(px, py, stepX[d], stepY[d], limit);
+    const int minimumRun = 2;
+    for (int s = side; s < side + 2; s++) {
+        const int run = runLength(px, py, stepX[s], stepY[s], limit);
+        if (run >= minimumRun && (bestDirection == d || run > bestRun)) {
+            bestDirection = s;
+            bestRun = run;
+        }
+    }
+    return plan->gridCentre((py + stepY[bestDirection] * bestRun) * width + px + stepX[bestDirection] * bestRun);
+}
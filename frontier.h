@@ -0,0 +1,75 @@
+#ifndef FRONTIER_H
+#define FRONTIER_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "compiledplan.h"
+
+class VisitGrid;
+class RoomGraph;
+
+// Coverage frontiers on a compiled plan's occupancy grid. A free square is
+// covered when the visit raster has a pass at its centre; a frontier is a
+// covered free square with an uncovered free square beside it (4-connected).
+//
+// The map is kept up to date incrementally: after a tick only the squares
+// under the box the robot swept are re-read, and a square that flips
+// re-judges itself and its four neighbours. Frontiers sit in a list with a
+// slot per square, so adding and removing one is O(1). Since the covered
+// flags are a function of the visit raster alone, a map rebuilt from the
+// raster equals one updated tick by tick.
+class FrontierMap
+{
+public:
+    explicit FrontierMap(std::shared_ptr<const CompiledPlan> plan);
+
+    // Re-reads every free square
+    void rebuild(const VisitGrid& grid);
+    // Re-reads the squares whose centres lie in the box, in plan coordinates
+    void update(const VisitGrid& grid, double left, double top, double right, double bottom);
+
+    const CompiledPlan& getPlan() const { return *plan; }
+    bool isCovered(int index) const { return covered[index] != 0; }
+    bool isFrontier(int index) const { return slots[index] >= 0; }
+    const std::vector<int>& getFrontiers() const { return frontiers; }
+    // Free squares joined by 4-connected free squares share a component; -1 off the mask
+    int getComponent(int index) const { return components[index]; }
+    // Room of a square's centre, -1 outside every room
+    int getRoom(int index) const { return rooms[index]; }
+    // Squares that changed from uncovered to covered since construction
+    int getFlips() const { return flips; }
+
+    // The frontier closest to pos in the same component, those in pos's room
+    // before any other; ties go to the lower index. -1 when none is left.
+    // With a room graph, a finished room is followed by the first room of
+    // the shortest tour through the rooms that still have frontiers. Given
+    // allowedRooms (a flag per room), only frontiers in those rooms count.
+    int nearest(const Vector2D& pos, const RoomGraph* graph = nullptr,
+                const std::vector<char>* allowedRooms = nullptr) const;
+
+    // Where to head to clean past frontier: a lane through the uncovered
+    // squares beside it, inset so the robot's swath meets the covered edge,
+    // laid along that edge where there is room. Ends within maxLength.
+    Vector2D target(int frontier, double maxLength) const;
+
+private:
+    void reread(const VisitGrid& grid, int x0, int y0, int x1, int y1);
+    void refresh(int index);
+    bool isOpen(int x, int y) const;     // free and uncovered
+    int runLength(int x, int y, int dx, int dy, int limit) const;
+
+    std::shared_ptr<const CompiledPlan> plan;
+    int width;
+    int height;
+    std::vector<uint8_t> covered;
+    std::vector<int32_t> slots;          // position in frontiers, -1 if not a frontier
+    std::vector<int> frontiers;
+    std::vector<int32_t> components;
+    std::vector<int16_t> rooms;          // room of each square's centre, -1 outside
+    std::vector<int> roomFrontiers;      // frontiers per room, outside ones first
+    int flips = 0;
+};
+
+#endif // FRONTIER_H
@@ -0,0 +1,81 @@
+#include "heatmap.h"
+
+#include <QLinearGradient>
+
+HeatmapRenderer::HeatmapRenderer()
+{
+    lut = buildColorLut(colorMap);
+}
+
+void HeatmapRenderer::setColorMap(ColorMap map)
+{
+    colorMap = map;
+    lut = buildColorLut(colorMap);
+    countLutMax = -1;
+}
+
+ColorMap HeatmapRenderer::getColorMap() const
+{
+    return colorMap;
+}
+
+const QImage& HeatmapRenderer::render(const VisitGrid& grid)
+{
+    if (image.width() != grid.getWidth() || image.height() != grid.getHeight()) {
+        image = QImage(grid.getWidth(), grid.getHeight(), QImage::Format_ARGB32);
+    }
+
+    if (countLutMax != grid.getMaxCount()) {
+        countLutMax = grid.getMaxCount();
+        buildCountLut(lut, uint16_t(countLutMax), countLut);
+    }
+
+    // One tile-row run at a time; unvisited tiles read as a shared zero run
+    for (int iy = 0; iy < grid.getHeight(); ++iy) {
+        uint32_t* line = reinterpret_cast<uint32_t*>(image.scanLine(iy));
+        for (int ix = 0, length = 0; ix < grid.getWidth(); ix += length) {
+            const uint16_t* run = grid.readRun(ix, iy, length);
+            mapCountsToArgb(run, size_t(length), countLut, line + ix);
+        }
+    }
+    return image;
+}
+
+void HeatmapRenderer::drawLegend(QPainter* painter, const QRectF& rect, int maxCount) const
+{
+    const qreal labelHeight = 18;
+    QRectF bar(rect.left(), rect.top() + labelHeight, rect.width() / 3, rect.height() - 2 * labelHeight);
+
+    // Highest count at the top of the bar
+    QLinearGradient gradient(bar.bottomLeft(), bar.topLeft());
+    for (int i = 0; i < 256; i += 15) {
+        gradient.setColorAt(i / 255.0, QColor::fromRgba(lut[i]));
+    }
+    gradient.setColorAt(1.0, QColor::fromRgba(lut[255]));
+
+    painter->save();
+    painter->setPen(QPen(Qt::black, 1));
+    painter->setBrush(gradient);
+    painter->drawRect(bar);
+
+    QFont font("Verdana", 8);
+    painter->setFont(font);
+    painter->drawText(QRectF(rect.left(), rect.top(), rect.width(), labelHeight),
+                      Qt::AlignLeft | Qt::AlignVCenter, "Visits");
+    painter->drawText(QRectF(bar.right() + 4, bar.top(), rect.width() - bar.width() - 4, labelHeight),
+                      Qt::AlignLeft | Qt::AlignTop, QString::number(qMax(1, maxCount)));
+    painter->drawText(QRectF(bar.right() + 4, bar.bottom() - labelHeight, rect.width() - bar.width() - 4, labelHeight),
+                      Qt::AlignLeft | Qt::AlignBottom, "1");
+    painter->restore();
+}
+
+QStringList HeatmapRenderer::colorMapNames()
+{
+    return {"Viridis", "Inferno"};
+}
+
+ColorMap HeatmapRenderer::colorMapFromName(const QString& name)
+{
+    if (name.toLower() == "inferno") return ColorMap::Inferno;
+    return ColorMap::Viridis;
+}
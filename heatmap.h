@@ -0,0 +1,36 @@
+#ifndef HEATMAP_H
+#define HEATMAP_H
+
+#include <QImage>
+#include <QPainter>
+#include <QStringList>
+
+#include "colormap.h"
+#include "visitgrid.h"
+
+// Turns a VisitGrid into a colour-mapped image for the live coverage layer
+// and the report heatmap. The image and the count lookup table are kept
+// between calls so refreshing every tick does not reallocate.
+class HeatmapRenderer
+{
+public:
+    HeatmapRenderer();
+
+    void setColorMap(ColorMap map);
+    ColorMap getColorMap() const;
+
+    const QImage& render(const VisitGrid& grid);
+    void drawLegend(QPainter* painter, const QRectF& rect, int maxCount) const;
+
+    static QStringList colorMapNames();
+    static ColorMap colorMapFromName(const QString& name);
+
+private:
+    ColorMap colorMap = ColorMap::Viridis;
+    ColorLut lut;
+    std::vector<uint32_t> countLut;
+    int countLutMax = -1;
+    QImage image;
+};
+
+#endif // HEATMAP_H
@@ -4,6 +4,7 @@
 
 #include "house.h"
 #include "dragdrop.h"
+#include "planlayer.h"
 
 #include <QRandomGenerator>
 
@@ -489,63 +490,10 @@ void House::drawObstructions()
 
 void House::drawSimulationPlan()
 {
-
-    // QColor fillColor;
-    // Qt::BrushStyle pattern = Qt::NoBrush;
-
-    // if (floor_covering == "hard_floor") {
-    //     fillColor = QColor(196, 164, 132, 127);
-    //     pattern = Qt::CrossPattern;
-    // } else if (floor_covering == "cut_pile") {
-    //     fillColor = QColor(200, 0, 0, 127);
-    //     pattern = Qt::Dense6Pattern;
-    // } else if (floor_covering == "loop_pile") {
-    //     fillColor = QColor(50, 50, 255, 127);
-    //     pattern = Qt::Dense7Pattern;
-    // } else if (floor_covering == "frieze_cut") {
-    //     fillColor = QColor(255, 255, 200, 127);
-    //     pattern = Qt::Dense5Pattern;
-    // }
-
-    // QBrush roomBrush(fillColor, pattern);
-
-    // for (const Room& room : rooms) {
-    //     QRectF rect = room.get_rectRoom();
-    //     QGraphicsRectItem* roomItem = m_scene->addRect(rect, wall_pen, roomBrush);
-    //     roomItem->setZValue(0); // Ensure it's below other items
-    // }
-
-    for(int i = 0; i < rooms.size(); i++)
-    {
-        m_scene->addRect(rooms[i].get_rectRoom(), wall_pen);
-    }
-
-    QPen penWhite = QPen(Qt::white);
-    penWhite.setWidth(2);
-    for(int i = 0; i < doors.size(); i++)
-    {
-        m_scene->addLine(doors[i].get_door(), wall_pen);
-        m_scene->addLine(doors[i].get_entry(), penWhite);
-    }
-
-    QPen overlay_pen;
-    for(int i = 0; i < obstructions.size(); i++)
-    {
-        if(obstructions[i].get_isChest())
-        {
-            m_scene->addRect(obstructions[i].get_rect(), obstruct_pen);
-            m_scene->addRect(obstructions[i].get_overlay(), QPen(Qt::NoPen), QBrush(QColor(255,0,0,127)));
-        }
-        else
-        {
-            m_scene->addRect(obstructions[i].get_rect(), obstruct_pen);
-            m_scene->addEllipse(obstructions[i].get_legs()[0], QPen(Qt::NoPen), QBrush(QColor(255,0,0,127)));
-            m_scene->addEllipse(obstructions[i].get_legs()[1], QPen(Qt::NoPen), QBrush(QColor(255,0,0,127)));
-            m_scene->addEllipse(obstructions[i].get_legs()[2], QPen(Qt::NoPen), QBrush(QColor(255,0,0,127)));
-            m_scene->addEllipse(obstructions[i].get_legs()[3], QPen(Qt::NoPen), QBrush(QColor(255,0,0,127)));
-        }
-
-    }
+    // The simulation never edits the plan, so draw it as one cached layer
+    // instead of an item per room, door, obstruction and leg
+    PlanLayer *layer = new PlanLayer(rooms, doors, obstructions);
+    m_scene->addItem(layer);
 }
 
 // Generic method to load entities from JSON
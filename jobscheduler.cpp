@@ -0,0 +1,185 @@
+#include "jobscheduler.h"
+
+#include <algorithm>
+
+namespace {
+thread_local int workerIndex = -1;
+thread_local const void* workerOwner = nullptr;
+}
+
+JobGroup::JobGroup(CancellationToken token)
+    : state(std::make_shared<State>())
+{
+    state->token = token;
+}
+
+void JobGroup::setProgressCallback(ProgressCallback callback)
+{
+    state->progress = std::move(callback);
+}
+
+void JobGroup::wait() const
+{
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->finished.wait(lock, [this] { return state->done == state->total; });
+}
+
+JobScheduler::JobScheduler(int threadCount)
+{
+    if (threadCount <= 0) threadCount = int(std::thread::hardware_concurrency());
+    threadCount = std::max(1, threadCount);
+
+    for (int i = 0; i < threadCount; i++) {
+        queues.push_back(std::make_unique<Worker>());
+    }
+    for (int i = 0; i < threadCount; i++) {
+        workers.emplace_back(&JobScheduler::workerLoop, this, i);
+    }
+}
+
+JobScheduler::~JobScheduler()
+{
+    waitIdle();
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wakeWorkers.notify_all();
+    for (std::thread &worker : workers) worker.join();
+}
+
+int JobScheduler::currentWorker()
+{
+    return workerIndex;
+}
+
+void JobScheduler::submit(JobGroup& group, Job job)
+{
+    Task* task = new Task{std::move(job), group.state};
+    group.state->total++;
+    pending++;
+
+    if (workerOwner == this) {
+        // From one of our own jobs: keep it local, thieves will balance
+        queues[workerIndex]->deque.push(task);
+    } else {
+        Worker &target = *queues[nextInbox++ % queues.size()];
+        std::lock_guard<std::mutex> lock(target.inboxMutex);
+        target.inbox.push_back(task);
+        target.inboxPending = true;
+    }
+    signalWork();
+}
+
+void JobScheduler::signalWork()
+{
+    workEpoch++;
+    // A worker counts itself asleep before its last look for work, so with
+    // none counted every worker will still see the new job
+    if (sleepers > 0) {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+        }
+        wakeWorkers.notify_one();
+    }
+}
+
+void JobScheduler::waitIdle()
+{
+    std::unique_lock<std::mutex> lock(sleepMutex);
+    wakeWaiters.wait(lock, [this] { return pending == 0; });
+}
+
+JobScheduler::Task* JobScheduler::findTask(int index)
+{
+    Worker &own = *queues[index];
+
+    if (Task* task = own.deque.pop()) return task;
+
+    // Move submitted jobs into our deque, where others can steal them
+    if (own.inboxPending) {
+        std::vector<Task*> arrived;
+        {
+            std::lock_guard<std::mutex> lock(own.inboxMutex);
+            arrived.swap(own.inbox);
+            own.inboxPending = false;
+        }
+        // Reversed so the deque still hands out the oldest job to thieves first
+        for (auto it = arrived.rbegin(); it != arrived.rend(); ++it) own.deque.push(*it);
+        if (Task* task = own.deque.pop()) return task;
+    }
+
+    const int count = int(queues.size());
+    for (int offset = 1; offset < count; offset++) {
+        Worker &victim = *queues[(index + offset) % count];
+        if (Task* task = victim.deque.steal()) {
+            // A thief that lost a race for the rest may have gone to sleep
+            signalWork();
+            return task;
+        }
+    }
+
+    // Nothing queued anywhere else: take jobs straight from a busy worker's inbox
+    for (int offset = 1; offset < count; offset++) {
+        Worker &victim = *queues[(index + offset) % count];
+        if (!victim.inboxPending) continue;
+        std::lock_guard<std::mutex> lock(victim.inboxMutex);
+        if (victim.inbox.empty()) continue;
+        Task* task = victim.inbox.front();
+        victim.inbox.erase(victim.inbox.begin());
+        victim.inboxPending = !victim.inbox.empty();
+        return task;
+    }
+    return nullptr;
+}
+
+void JobScheduler::runTask(Task* task)
+{
+    std::shared_ptr<JobGroup::State> group = std::move(task->group);
+    if (!group->token.isCancelled()) {
+        task->job(group->token);
+    }
+    delete task;
+
+    int64_t done = ++group->done;
+    if (group->progress) group->progress(done, group->total);
+    if (done == group->total) {
+        std::lock_guard<std::mutex> lock(group->mutex);
+        group->finished.notify_all();
+    }
+
+    if (--pending == 0) {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        wakeWaiters.notify_all();
+    }
+}
+
+void JobScheduler::workerLoop(int index)
+{
+    workerIndex = index;
+    workerOwner = this;
+
+    while (true) {
+        if (Task* task = findTask(index)) {
+            runTask(task);
+            continue;
+        }
+
+        // Idle: count ourselves asleep, then look once more, so a job
+        // submitted meanwhile either turns up here or wakes us
+        sleepers++;
+        const uint64_t epoch = workEpoch;
+        if (Task* task = findTask(index)) {
+            sleepers--;
+            runTask(task);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        if (stopping && pending == 0) {
+            sleepers--;
+            return;
+        }
+        wakeWorkers.wait(lock, [&] { return stopping || workEpoch != epoch; });
+        sleepers--;
+    }
+}
@@ -0,0 +1,127 @@
+#ifndef JOBSCHEDULER_H
+#define JOBSCHEDULER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "workdeque.h"
+
+// Shared flag checked by jobs that should stop early. Copies share the flag,
+// and cancel() is a single atomic store, so it is safe from a signal handler.
+class CancellationToken
+{
+public:
+    CancellationToken() : state(std::make_shared<std::atomic<bool>>(false)) {}
+
+    void cancel() const { state->store(true, std::memory_order_relaxed); }
+    bool isCancelled() const { return state->load(std::memory_order_relaxed); }
+
+private:
+    std::shared_ptr<std::atomic<bool>> state;
+};
+
+// Jobs submitted together: one cancellation token, a completion count that
+// can be waited on, and an optional progress callback run on the worker
+// thread after each job. Jobs picked up after cancellation are skipped but
+// still counted, so wait() returns promptly.
+class JobGroup
+{
+public:
+    using ProgressCallback = std::function<void(int64_t done, int64_t total)>;
+
+    explicit JobGroup(CancellationToken token = CancellationToken());
+
+    // Set before submitting jobs
+    void setProgressCallback(ProgressCallback callback);
+
+    const CancellationToken& getToken() const { return state->token; }
+    void cancel() const { state->token.cancel(); }
+
+    int64_t getDone() const { return state->done; }
+    int64_t getTotal() const { return state->total; }
+    bool isFinished() const { return state->done == state->total; }
+    void wait() const;
+
+private:
+    friend class JobScheduler;
+
+    struct State
+    {
+        CancellationToken token;
+        ProgressCallback progress;
+        std::atomic<int64_t> done{0};
+        std::atomic<int64_t> total{0};
+        std::mutex mutex;
+        std::condition_variable finished;
+    };
+    std::shared_ptr<State> state;
+};
+
+// Work-stealing scheduler for simulation workloads, whose jobs vary a lot
+// in length. Each worker owns a lock-free deque (workdeque.h): it runs its
+// newest job first and, when empty, steals the oldest job of another
+// worker. Jobs submitted from outside the pool are dealt round-robin into
+// per-worker inboxes, each with its own lock, so no lock is shared by all
+// workers.
+class JobScheduler
+{
+public:
+    using Job = std::function<void(const CancellationToken&)>;
+
+    explicit JobScheduler(int threadCount = 0);
+    ~JobScheduler();
+
+    JobScheduler(const JobScheduler&) = delete;
+    JobScheduler& operator=(const JobScheduler&) = delete;
+
+    void submit(JobGroup& group, Job job);
+    // Blocks until every submitted job of every group has finished
+    void waitIdle();
+
+    int getThreadCount() const { return int(workers.size()); }
+    // Index of the calling worker, or -1 outside any scheduler
+    static int currentWorker();
+
+private:
+    struct Task
+    {
+        Job job;
+        std::shared_ptr<JobGroup::State> group;
+    };
+
+    struct Worker
+    {
+        WorkDeque<Task> deque;
+        std::mutex inboxMutex;
+        std::vector<Task*> inbox;
+        std::atomic<bool> inboxPending{false};
+    };
+
+    void workerLoop(int index);
+    Task* findTask(int index);
+    void runTask(Task* task);
+    // Counts new work and wakes a sleeping worker, if any, to look for it
+    void signalWork();
+
+    std::vector<std::unique_ptr<Worker>> queues;
+    std::vector<std::thread> workers;
+
+    std::atomic<unsigned> nextInbox{0};
+    std::atomic<int64_t> pending{0};
+    std::atomic<bool> stopping{false};
+    std::atomic<uint64_t> workEpoch{0};    // bumped for every job that becomes available
+    std::atomic<int> sleepers{0};           // idle workers about to park or parked
+
+    // Only taken when a worker is asleep, and by waiters; never to hand out jobs
+    std::mutex sleepMutex;
+    std::condition_variable wakeWorkers;
+    std::condition_variable wakeWaiters;
+};
+
+#endif // JOBSCHEDULER_H
@@ -0,0 +1,98 @@
+#include "journal.h"
+
+#include <filesystem>
+#include <cstdlib>
+#include <fstream>
+
+namespace {
+const char headerTag[] = "robosim-journal 1 ";
+}
+
+RunJournal::~RunJournal()
+{
+    close();
+}
+
+bool RunJournal::open(const std::string& path, const std::string& experimentId, int64_t jobCount, std::string* error)
+{
+    close();
+    completed.assign(size_t(jobCount), false);
+    completedCount = 0;
+
+    const std::string header = headerTag + experimentId;
+    std::error_code ec;
+    bool exists = std::filesystem::exists(path, ec);
+
+    if (exists) {
+        std::ifstream in(path, std::ios::binary);
+        std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+        // Only whole lines count
+        size_t end = content.rfind('\n');
+        end = end == std::string::npos ? 0 : end + 1;
+
+        size_t lineStart = 0;
+        bool first = true;
+        while (lineStart < end) {
+            size_t lineEnd = content.find('\n', lineStart);
+            std::string line = content.substr(lineStart, lineEnd - lineStart);
+            lineStart = lineEnd + 1;
+
+            if (first) {
+                first = false;
+                if (line != header) {
+                    if (error) *error = "Journal " + path + " belongs to a different experiment";
+                    return false;
+                }
+                continue;
+            }
+            if (line.empty()) continue;
+            markCompleted(std::strtoll(line.c_str(), nullptr, 10));
+        }
+
+        if (end == 0) {
+            exists = false;     // not even the header survived
+        } else if (end < content.size()) {
+            std::filesystem::resize_file(path, end, ec);
+        }
+    }
+
+    file = std::fopen(path.c_str(), exists ? "ab" : "wb");
+    if (!file) {
+        if (error) *error = "Cannot write journal " + path;
+        return false;
+    }
+    if (!exists) {
+        std::fprintf(file, "%s\n", header.c_str());
+        std::fflush(file);
+    }
+    return true;
+}
+
+void RunJournal::close()
+{
+    if (file) std::fclose(file);
+    file = nullptr;
+}
+
+bool RunJournal::isCompleted(int64_t job) const
+{
+    return job >= 0 && job < int64_t(completed.size()) && completed[size_t(job)];
+}
+
+void RunJournal::markCompleted(int64_t job)
+{
+    if (job < 0 || job >= int64_t(completed.size()) || completed[size_t(job)]) return;
+    completed[size_t(job)] = true;
+    completedCount++;
+}
+
+bool RunJournal::append(const std::vector<int64_t>& jobs)
+{
+    if (!file) return false;
+    for (int64_t job : jobs) {
+        std::fprintf(file, "%lld\n", static_cast<long long>(job));
+        markCompleted(job);
+    }
+    return std::fflush(file) == 0;
+}
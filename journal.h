@@ -0,0 +1,37 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Append-only record of finished jobs, so an interrupted experiment resumes
+// where it stopped. The first line names the experiment it belongs to (a
+// hash of its spec); every further line is one finished job index. A line
+// cut short by a crash is dropped when the journal is reopened.
+class RunJournal
+{
+public:
+    ~RunJournal();
+
+    // Loads the jobs already recorded for this experiment. Fails if the
+    // journal belongs to a different experiment.
+    bool open(const std::string& path, const std::string& experimentId, int64_t jobCount, std::string* error = nullptr);
+    void close();
+
+    bool isCompleted(int64_t job) const;
+    int64_t getCompletedCount() const { return completedCount; }
+
+    // Marks jobs as done in memory only, e.g. rows found in the results file
+    void markCompleted(int64_t job);
+    // Appends the jobs to the file and flushes it
+    bool append(const std::vector<int64_t>& jobs);
+
+private:
+    std::FILE* file = nullptr;
+    std::vector<bool> completed;
+    int64_t completedCount = 0;
+};
+
+#endif // JOURNAL_H
@@ -13,6 +13,7 @@ MainWindow::MainWindow(QWidget *parent)
     ui->setupUi(this);
     this->setFocus();
     ui->runSim->setEnabled(false);
+    ui->runEnsemble->setEnabled(false);
     ui->robSet->setEnabled(false);
 }
 
@@ -85,11 +86,22 @@ void MainWindow::on_runSim_clicked()
         simWin = new SimWindow(editWin->house, this);
         simWin->house_path = editWin->house->get_floorplanName();
         qDebug() << "house path: " << simWin->house_path;
-        simWin->startSimulation(batteryLife, vacuumEfficiency, whiskerEfficiency, speed, selectedAlgorithms);
+        simWin->startSimulation(batteryLife, vacuumEfficiency, whiskerEfficiency, speed, selectedAlgorithms, strategyParams);
         simWin->showMaximized();
     }
 }
 
+void MainWindow::on_runEnsemble_clicked()
+{
+    if (editWin && setWin){
+        ensWin = new EnsembleWindow(this);
+        ensWin->setAttribute(Qt::WA_DeleteOnClose);
+        ensWin->setup(editWin->house->get_floorplanName(), batteryLife, vacuumEfficiency, whiskerEfficiency, speed, selectedAlgorithms,
+                      strategyParams);
+        ensWin->show();
+    }
+}
+
 void MainWindow::updateRunSimButtonState()
 {
     if (floorplanCreated)
@@ -100,15 +112,18 @@ void MainWindow::updateRunSimButtonState()
     if (floorplanCreated && robotSetup)
     {
         ui->runSim->setEnabled(true);
+        ui->runEnsemble->setEnabled(true);
     }
 }
 
-void MainWindow::onSettingsUpdated(int batteryLife, int vacuumEfficiency, int whiskerEfficiency, int speed, QStringList selectedAlgorithms)
+void MainWindow::onSettingsUpdated(int batteryLife, int vacuumEfficiency, int whiskerEfficiency, int speed, QStringList selectedAlgorithms,
+                                   StrategyParams strategyParams)
 {
     this->batteryLife = batteryLife;
     this->vacuumEfficiency = vacuumEfficiency;
     this->whiskerEfficiency = whiskerEfficiency;
     this->speed = speed;
     this->selectedAlgorithms = selectedAlgorithms;
+    this->strategyParams = strategyParams;
 }
 
@@ -7,6 +7,7 @@
 #include "simwindow.h"
 #include "reportwindow.h"
 #include "summarywindow.h"
+#include "ensemblewindow.h"
 
 QT_BEGIN_NAMESPACE
 namespace Ui {
@@ -29,8 +30,10 @@ private slots:
     void on_sumRep_clicked();
     void on_robSet_clicked();
     void on_runSim_clicked();
+    void on_runEnsemble_clicked();
     void updateRunSimButtonState();
-    void onSettingsUpdated(int batteryLife, int vacuumEfficiency, int whiskerEfficiency, int speed, QStringList selectedAlgorithms);
+    void onSettingsUpdated(int batteryLife, int vacuumEfficiency, int whiskerEfficiency, int speed, QStringList selectedAlgorithms,
+                           StrategyParams strategyParams);
 
 private:
     Ui::MainWindow *ui;
@@ -40,6 +43,7 @@ private:
     SimWindow *simWin;
     ReportWindow *repWin;
     SummaryWindow *sumWin;
+    EnsembleWindow *ensWin;
 
     bool floorplanCreated = false;
     bool robotSetup = false;
@@ -49,6 +53,7 @@ private:
     int whiskerEfficiency;
     int speed;
     QStringList selectedAlgorithms;
+    StrategyParams strategyParams;
 
 };
 #endif // MAINWINDOW_H
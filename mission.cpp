@@ -0,0 +1,115 @@
+#include "mission.h"
+#include "vacuum.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+
+int MissionRunner::openFloorCells(const Vacuum &vacuum)
+{
+    const VisitGrid &grid = vacuum.getVisitGrid();
+    const CollisionSystem &plan = vacuum.getCollisionSystem();
+    int cells = 0;
+    for (int y = 0; y < grid.getHeight(); y++) {
+        for (int x = 0; x < grid.getWidth(); x++) {
+            const Vector2D centre = {grid.getOriginX() + (x + 0.5) * grid.getCellSize(),
+                                     grid.getOriginY() + (y + 0.5) * grid.getCellSize()};
+            if (!plan.getCurrentRoom(centre)) continue;
+            bool underChest = false;
+            for (const Obstruction2D &obs : plan.getObstructions()) {
+                if (obs.isChest && centre.x >= obs.topLeft.x && centre.x <= obs.bottomRight.x &&
+                    centre.y >= obs.topLeft.y && centre.y <= obs.bottomRight.y) {
+                    underChest = true;
+                    break;
+                }
+            }
+            if (!underChest) cells++;
+        }
+    }
+    return cells;
+}
+
+MissionResult MissionRunner::run(Vacuum &vacuum, const QString &algorithm, quint64 seed,
+                                 const MissionSettings &settings, const CancellationToken &token)
+{
+    MissionResult result;
+    result.algorithm = algorithm;
+    result.seed = seed;
+
+    vacuum.setStartPosition(vacuum.getCollisionSystem().getDockPosition());
+    EnsembleRunner::prepare(vacuum, algorithm, seed, settings.robot);
+    vacuum.setReturnToDock(true, settings.reserveSeconds);
+
+    // The visit raster counts cells the vacuum can only have reached over
+    // open floor, so the target is a cell count checked every tick
+    const int floorCells = std::max(1, openFloorCells(vacuum));
+    const int targetCells = int(std::ceil(settings.targetCoverage * floorCells));
+    const VisitGrid &grid = vacuum.getVisitGrid();
+
+    int time = 0;
+    bool reached = grid.getVisitedCells() >= targetCells;
+    if (reached) result.timeToTarget = 0;
+    while (!reached) {
+        result.charges++;
+        const int cellsBefore = grid.getVisitedCells();
+        while (!vacuum.isFinished() && !token.isCancelled()) {
+            vacuum.updateMovementandTrail(nullptr);
+            time++;
+            if (grid.getVisitedCells() >= targetCells) {
+                reached = true;
+                result.timeToTarget = time;
+                break;
+            }
+        }
+        result.chargeCoverage.push_back(std::min(1.0, double(grid.getVisitedCells()) / floorCells));
+        if (reached || token.isCancelled()) break;
+
+        // Flat or aborted on the floor, out of charges, or nothing left it can reach
+        if (vacuum.getDockState() != DockState::Docked || result.charges >= settings.maxCharges ||
+            grid.getVisitedCells() == cellsBefore) {
+            break;
+        }
+        time += settings.rechargeMinutes * 60;
+        vacuum.setBatteryLife(settings.robot.batteryLife);
+        vacuum.undock();
+    }
+
+    result.missionTime = time;
+    result.floorCoverage = std::min(1.0, double(grid.getVisitedCells()) / floorCells);
+    result.coverage = vacuum.getCoveredArea();
+    result.docked = vacuum.getDockState() == DockState::Docked;
+    return result;
+}
+
+std::vector<MissionResult> MissionRunner::runAll(const MissionSettings &settings, const CancellationToken &token)
+{
+    const EnsembleSettings &robot = settings.robot;
+    const int seeds = std::max(0, robot.seedsPerAlgorithm);
+    const int jobs = robot.algorithms.size() * seeds;
+    std::vector<MissionResult> results(jobs);
+    std::vector<char> done(jobs, 0);
+
+    JobScheduler scheduler(robot.threadCount);
+    std::vector<std::unique_ptr<Vacuum>> vacuums(scheduler.getThreadCount());
+    JobGroup group(token);
+    for (int job = 0; job < jobs; job++) {
+        scheduler.submit(group, [&, job](const CancellationToken &cancel) {
+            std::unique_ptr<Vacuum> &vacuum = vacuums[JobScheduler::currentWorker()];
+            if (!vacuum) {
+                QString housePath = robot.housePath;
+                vacuum = std::make_unique<Vacuum>(nullptr);
+                vacuum->setHousePath(housePath);
+            }
+            results[job] = run(*vacuum, robot.algorithms[job / seeds], robot.baseSeed + quint64(job % seeds),
+                               settings, cancel);
+            done[job] = !cancel.isCancelled();
+        });
+    }
+    group.wait();
+
+    std::vector<MissionResult> finished;
+    for (int job = 0; job < jobs; job++) {
+        if (done[job]) finished.push_back(results[job]);
+    }
+    return finished;
+}
@@ -0,0 +1,64 @@
+#ifndef MISSION_H
+#define MISSION_H
+
+#include <QString>
+#include <QStringList>
+
+#include <vector>
+
+#include "ensemble.h"
+#include "jobscheduler.h"
+
+class Vacuum;
+
+struct MissionSettings
+{
+    EnsembleSettings robot;         // plan, algorithms, seeds, battery per charge, speed, stuck handling
+    double targetCoverage = 0.9;    // share of the open floor that ends the mission
+    int reserveSeconds = 60;        // battery kept over the way home
+    int rechargeMinutes = 120;      // on the dock between charges
+    int maxCharges = 5;             // batteries a mission may use, the first included
+};
+
+struct MissionResult
+{
+    QString algorithm;
+    quint64 seed = 0;
+    int charges = 0;                // batteries used, the first included
+    int missionTime = 0;            // simulated seconds off the dock and charging until the end
+    int timeToTarget = -1;          // simulated seconds until the target coverage, -1 if never reached
+    double floorCoverage = 0.0;     // share of the open floor covered
+    double coverage = 0.0;          // sq. ft, as a single run reports it
+    bool docked = false;            // ended on the dock, not flat or aborted on the floor
+    std::vector<double> chargeCoverage;    // share of the open floor after each charge
+};
+
+// A cleaning mission over several charges. The vacuum leaves its dock (the
+// plan's dock_pos, or its start when the plan has none) with return to
+// dock on, cleans until the reserve sends it home, charges for
+// rechargeMinutes and goes back to where it broke off, until the open
+// floor is targetCoverage covered. A mission also ends when its charges
+// are used up, when the vacuum cannot make it home, or when a whole charge
+// adds nothing.
+//
+// Open floor is measured on the visit raster: cells whose centre is in a
+// room and not under a chest. Tables do not count against it.
+class MissionRunner
+{
+public:
+    // One mission on an already loaded vacuum, which it leaves with return
+    // to dock on and its start on the dock
+    static MissionResult run(Vacuum &vacuum, const QString &algorithm, quint64 seed,
+                             const MissionSettings &settings,
+                             const CancellationToken &token = CancellationToken());
+
+    // Every algorithm and seed of settings.robot on a JobScheduler, results
+    // in algorithm-then-seed order; cancelled missions are left out
+    static std::vector<MissionResult> runAll(const MissionSettings &settings,
+                                             const CancellationToken &token = CancellationToken());
+
+    // Raster cells of open floor
+    static int openFloorCells(const Vacuum &vacuum);
+};
+
+#endif // MISSION_H
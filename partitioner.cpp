@@ -0,0 +1,205 @@
+#include "partitioner.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace {
+const double infinity = std::numeric_limits<double>::infinity();
+
+// Work compared as (largest, total), with room for rounding
+bool lessWork(double largest, double total, double bestLargest, double bestTotal)
+{
+    const double eps = 1e-9 * std::max(1.0, bestLargest);
+    if (largest < bestLargest - eps) return true;
+    return largest <= bestLargest + eps && total < bestTotal - eps;
+}
+}
+
+RoomPartitioner::RoomPartitioner(const CompiledPlan& plan, const RoomGraph& graph)
+    : plan(plan)
+    , graph(graph)
+    , roomAreas(plan.getRooms().size(), 0.0)
+{
+    const double squareArea = CompiledPlan::gridCellSize * CompiledPlan::gridCellSize;
+    for (int y = 0; y < plan.getGridHeight(); y++) {
+        for (int x = 0; x < plan.getGridWidth(); x++) {
+            if (!plan.isFree(x, y)) continue;
+            const int room = plan.roomAt(plan.gridCentre(y * plan.getGridWidth() + x));
+            if (room >= 0) roomAreas[room] += squareArea;
+        }
+    }
+}
+
+int RoomPartitioner::startRoom(const Vector2D& pos) const
+{
+    return plan.roomNear(pos);
+}
+
+double RoomPartitioner::cost(int start, const std::vector<int>& rooms, double laneSpacing) const
+{
+    double area = 0.0;
+    for (int room : rooms) area += roomAreas[room];
+    return area / laneSpacing + graph.tourLength(start, graph.tour(start, rooms));
+}
+
+// Rooms sharing a door are zero apart on the room graph
+bool RoomPartitioner::adjacent(int room, const std::vector<int>& rooms) const
+{
+    for (int other : rooms) {
+        if (graph.getRoomDistance(room, other) == 0.0) return true;
+    }
+    return false;
+}
+
+bool RoomPartitioner::isConnected(const std::vector<int>& rooms) const
+{
+    if (rooms.size() <= 1) return true;
+    std::vector<int> reached = {rooms.front()};
+    for (size_t i = 0; i < reached.size(); i++) {
+        for (int room : rooms) {
+            if (std::find(reached.begin(), reached.end(), room) == reached.end() &&
+                graph.getRoomDistance(reached[i], room) == 0.0) {
+                reached.push_back(room);
+            }
+        }
+    }
+    return reached.size() == rooms.size();
+}
+
+RoomPartition RoomPartitioner::partition(const std::vector<Vector2D>& starts, double laneSpacing, bool connected) const
+{
+    const int robots = int(starts.size());
+    const int roomCount = int(roomAreas.size());
+    RoomPartition result;
+    result.rooms.resize(robots);
+    result.areas.assign(robots, 0.0);
+    result.costs.assign(robots, 0.0);
+    if (robots == 0) return result;
+
+    std::vector<int> origins(robots);
+    for (int k = 0; k < robots; k++) origins[k] = startRoom(starts[k]);
+    auto reaches = [&](int robot, int room) {
+        return origins[robot] >= 0 && graph.getRoomDistance(origins[robot], room) != infinity;
+    };
+
+    // Largest rooms first, ties to the lower index
+    std::vector<int> order(roomCount);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return roomAreas[a] > roomAreas[b]; });
+
+    std::vector<std::vector<int>>& rooms = result.rooms;
+    std::vector<double>& costs = result.costs;
+    for (int room : order) {
+        if (roomAreas[room] <= 0.0) continue;
+        int best = -1;
+        double bestCost = infinity;
+        for (int pass = connected ? 0 : 1; pass < 2 && best < 0; pass++) {
+            for (int k = 0; k < robots; k++) {
+                if (!reaches(k, room)) continue;
+                if (pass == 0 && !rooms[k].empty() && !adjacent(room, rooms[k])) continue;
+                std::vector<int> grown = rooms[k];
+                grown.push_back(room);
+                const double grownCost = cost(origins[k], grown, laneSpacing);
+                if (grownCost < bestCost) {
+                    bestCost = grownCost;
+                    best = k;
+                }
+            }
+        }
+        if (best < 0) {
+            result.unassigned.push_back(room);
+            continue;
+        }
+        rooms[best].push_back(room);
+        costs[best] = bestCost;
+    }
+
+    // Local search: the first move or swap that helps is taken, then the
+    // search starts over. Every step lowers (largest, total), so it ends.
+    auto workWith = [&](int a, double costA, int b, double costB, double& largest, double& total) {
+        largest = 0.0;
+        total = 0.0;
+        for (int k = 0; k < robots; k++) {
+            const double c = k == a ? costA : k == b ? costB : costs[k];
+            largest = std::max(largest, c);
+            total += c;
+        }
+    };
+    double largest = 0.0;
+    double total = 0.0;
+    workWith(-1, 0.0, -1, 0.0, largest, total);
+
+    constexpr int maxSteps = 1000;
+    for (int step = 0; step < maxSteps; step++) {
+        bool improved = false;
+        for (int a = 0; a < robots && !improved; a++) {
+            for (size_t i = 0; i < rooms[a].size() && !improved; i++) {
+                const int room = rooms[a][i];
+                std::vector<int> shrunk = rooms[a];
+                shrunk.erase(shrunk.begin() + i);
+                if (connected && !isConnected(shrunk)) continue;
+                const double shrunkCost = cost(origins[a], shrunk, laneSpacing);
+
+                for (int b = 0; b < robots && !improved; b++) {
+                    if (b == a || !reaches(b, room)) continue;
+
+                    // Move the room from a to b
+                    std::vector<int> grown = rooms[b];
+                    grown.push_back(room);
+                    const double grownCost = cost(origins[b], grown, laneSpacing);
+                    double moveLargest, moveTotal;
+                    workWith(a, shrunkCost, b, grownCost, moveLargest, moveTotal);
+                    if ((!connected || isConnected(grown)) && lessWork(moveLargest, moveTotal, largest, total)) {
+                        rooms[a] = shrunk;
+                        rooms[b] = grown;
+                        costs[a] = shrunkCost;
+                        costs[b] = grownCost;
+                        largest = moveLargest;
+                        total = moveTotal;
+                        improved = true;
+                        break;
+                    }
+
+                    // Swap it for one of b's
+                    for (size_t j = 0; j < rooms[b].size(); j++) {
+                        const int other = rooms[b][j];
+                        if (!reaches(a, other)) continue;
+                        std::vector<int> swappedA = shrunk;
+                        swappedA.push_back(other);
+                        std::vector<int> swappedB = rooms[b];
+                        swappedB[j] = room;
+                        if (connected && (!isConnected(swappedA) || !isConnected(swappedB))) continue;
+                        const double costA = cost(origins[a], swappedA, laneSpacing);
+                        const double costB = cost(origins[b], swappedB, laneSpacing);
+                        double swapLargest, swapTotal;
+                        workWith(a, costA, b, costB, swapLargest, swapTotal);
+                        if (lessWork(swapLargest, swapTotal, largest, total)) {
+                            rooms[a] = swappedA;
+                            rooms[b] = swappedB;
+                            costs[a] = costA;
+                            costs[b] = costB;
+                            largest = swapLargest;
+                            total = swapTotal;
+                            improved = true;
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+        if (!improved) break;
+    }
+
+    // Each robot's rooms in tour order, its own first when it has it
+    for (int k = 0; k < robots; k++) {
+        std::vector<int> ordered;
+        if (std::find(rooms[k].begin(), rooms[k].end(), origins[k]) != rooms[k].end()) ordered.push_back(origins[k]);
+        for (int room : graph.tour(origins[k], rooms[k])) ordered.push_back(room);
+        rooms[k] = ordered;
+        for (int room : rooms[k]) result.areas[k] += roomAreas[room];
+    }
+    std::sort(result.unassigned.begin(), result.unassigned.end());
+    return result;
+}
@@ -0,0 +1,54 @@
+#ifndef PARTITIONER_H
+#define PARTITIONER_H
+
+#include <vector>
+
+#include "compiledplan.h"
+#include "roomgraph.h"
+
+struct RoomPartition
+{
+    // Rooms each robot cleans, in the order of its tour from its start
+    std::vector<std::vector<int>> rooms;
+    std::vector<double> areas;      // free floor of those rooms, square plan units
+    std::vector<double> costs;      // estimated walk: sweeping plus the tour, plan units
+    // Rooms no robot can reach from its start
+    std::vector<int> unassigned;
+};
+
+// Splits a plan's rooms among K robots so each has about the same work.
+// A room weighs its free floor on the occupancy grid; a robot's work is the
+// length of the lanes its rooms take to sweep plus the tour through them
+// from its start on the room graph, so handing a robot a room far from the
+// rest of its rooms costs it the walk there.
+//
+// Rooms are first packed greedily, largest first, each onto the robot it
+// leaves with the least work; single moves and swaps between robots are then taken
+// while they lower the largest work, or keep it and lower the total.
+class RoomPartitioner
+{
+public:
+    // Both must outlive the partitioner
+    RoomPartitioner(const CompiledPlan& plan, const RoomGraph& graph);
+
+    double getRoomArea(int room) const { return roomAreas[room]; }
+    // The room a robot starting at pos begins in, -1 if off every room
+    int startRoom(const Vector2D& pos) const;
+
+    // One partition per start, for lanes laneSpacing apart. With connected,
+    // each robot's rooms are joined by doors among themselves, so a robot
+    // that never leaves its rooms can still walk between them; a room that
+    // fits no robot that way goes to the one it costs least.
+    RoomPartition partition(const std::vector<Vector2D>& starts, double laneSpacing, bool connected = false) const;
+
+private:
+    double cost(int start, const std::vector<int>& rooms, double laneSpacing) const;
+    bool adjacent(int room, const std::vector<int>& rooms) const;
+    bool isConnected(const std::vector<int>& rooms) const;
+
+    const CompiledPlan& plan;
+    const RoomGraph& graph;
+    std::vector<double> roomAreas;
+};
+
+#endif // PARTITIONER_H
@@ -0,0 +1,339 @@
+#include "pathplanner.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <queue>
+
+namespace {
+const double diagonalCost = std::sqrt(2.0);
+
+double distance(const Vector2D& a, const Vector2D& b)
+{
+    return std::hypot(a.x - b.x, a.y - b.y);
+}
+}
+
+PathPlanner::PathPlanner(std::shared_ptr<const CompiledPlan> plan, size_t cacheSize)
+    : plan(std::move(plan))
+    , cacheSize(std::max<size_t>(1, cacheSize))
+{
+    const CompiledPlan& compiled = *this->plan;
+    for (const PlanDoor& door : compiled.getDoors()) {
+        doorSquares.push_back(compiled.nearestFree(door.centre, CollisionSystem::doorWidth / 2.0));
+    }
+    const size_t squares = size_t(compiled.getGridWidth()) * compiled.getGridHeight();
+    generation.assign(squares, 0);
+    cost.resize(squares);
+    parent.resize(squares);
+}
+
+bool PathPlanner::lineOfSight(const Vector2D& a, const Vector2D& b) const
+{
+    // Sample at half-square steps; the free mask's margin covers the rest
+    const int steps = std::max(1, int(std::ceil(distance(a, b) / (CompiledPlan::gridCellSize / 2.0))));
+    for (int k = 0; k <= steps; k++) {
+        const double t = double(k) / steps;
+        const int index = plan->gridIndex({a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t});
+        if (index < 0) return false;
+        if (!plan->isFree(index % plan->getGridWidth(), index / plan->getGridWidth())) return false;
+    }
+    return true;
+}
+
+// Straight run onward from the free square (x, y). Stops at the goal or at
+// a square with a forced neighbour: a free square beside the run whose
+// square behind is blocked, so only from here is it reached optimally.
+// The run lengths are precomputed, so this is a lookup.
+int PathPlanner::jumpStraight(int x, int y, int dx, int dy, int goal) const
+{
+    const CompiledPlan& grid = *plan;
+    const int width = grid.getGridWidth();
+    const int direction = dx > 0 ? 0 : dx < 0 ? 1 : dy > 0 ? 2 : 3;
+    const int jump = grid.getStraightJump(y * width + x, direction);
+    const int reach = std::abs(jump);
+
+    // The goal may lie on the run before its end
+    const int gx = goal % width;
+    const int gy = goal / width;
+    const int toGoal = dx != 0 ? (gx - x) * dx : (gy - y) * dy;
+    if ((dx != 0 ? gy == y : gx == x) && toGoal > 0 && toGoal <= reach) return goal;
+
+    if (jump <= 0) return -1;
+    return (y + dy * jump) * width + x + dx * jump;
+}
+
+// Diagonal run onward from the free square (x, y), or a straight one
+int PathPlanner::jump(int x, int y, int dx, int dy, int goal) const
+{
+    if (dx == 0 || dy == 0) return jumpStraight(x, y, dx, dy, goal);
+
+    const CompiledPlan& grid = *plan;
+    for (;;) {
+        // Diagonal steps only between two free sides
+        if (!grid.isFree(x + dx, y) || !grid.isFree(x, y + dy) || !grid.isFree(x + dx, y + dy)) return -1;
+        x += dx;
+        y += dy;
+        const int index = y * grid.getGridWidth() + x;
+        if (index == goal) return index;
+        // A diagonal run stops where one of its straight runs finds something
+        if (jumpStraight(x, y, dx, 0, goal) >= 0 || jumpStraight(x, y, 0, dy, goal) >= 0) return index;
+    }
+}
+
+bool PathPlanner::search(int start, int goal, Leg& leg)
+{
+    searches++;
+    leg = Leg();
+    const CompiledPlan& grid = *plan;
+    const int width = grid.getGridWidth();
+    if (start == goal) {
+        leg.found = true;
+        leg.points.push_back(grid.gridCentre(goal));
+        return true;
+    }
+    // Most trips within a room are a straight line; no search needed
+    const Vector2D startCentre = grid.gridCentre(start);
+    const Vector2D goalCentre = grid.gridCentre(goal);
+    if (lineOfSight(startCentre, goalCentre)) {
+        leg.found = true;
+        leg.length = distance(startCentre, goalCentre);
+        leg.points = {startCentre, goalCentre};
+        return true;
+    }
+
+    if (++currentGeneration == 0) {
+        std::fill(generation.begin(), generation.end(), 0);
+        currentGeneration = 1;
+    }
+    const int goalX = goal % width;
+    const int goalY = goal / width;
+    auto octile = [](int ax, int ay) {
+        ax = std::abs(ax);
+        ay = std::abs(ay);
+        return (std::max(ax, ay) + (diagonalCost - 1.0) * std::min(ax, ay)) * CompiledPlan::gridCellSize;
+    };
+    auto heuristic = [&](int index) { return octile(index % width - goalX, index / width - goalY); };
+
+    using Item = std::pair<double, int>;
+    std::priority_queue<Item, std::vector<Item>, std::greater<Item>> open;
+    generation[start] = currentGeneration;
+    cost[start] = 0.0;
+    parent[start] = -1;
+    open.push({heuristic(start), start});
+
+    while (!open.empty()) {
+        const Item item = open.top();
+        open.pop();
+        const int node = item.second;
+        if (item.first > cost[node] + heuristic(node) + 1e-9) continue;      // superseded
+        if (node == goal) break;
+
+        const int x = node % width;
+        const int y = node / width;
+
+        // Pruned neighbour directions: all of them at the start, otherwise
+        // onward from the parent plus the forced ones
+        int directions[8][2];
+        int count = 0;
+        auto add = [&](int dx, int dy) {
+            directions[count][0] = dx;
+            directions[count][1] = dy;
+            count++;
+        };
+        if (parent[node] < 0) {
+            for (int dy = -1; dy <= 1; dy++) {
+                for (int dx = -1; dx <= 1; dx++) {
+                    if (dx == 0 && dy == 0) continue;
+                    if (dx != 0 && dy != 0 && (!grid.isFree(x + dx, y) || !grid.isFree(x, y + dy))) continue;
+                    add(dx, dy);
+                }
+            }
+        } else {
+            const int px = parent[node] % width;
+            const int py = parent[node] / width;
+            const int dx = (x > px) - (x < px);
+            const int dy = (y > py) - (y < py);
+            if (dx != 0 && dy != 0) {
+                const bool vertical = grid.isFree(x, y + dy);
+                const bool horizontal = grid.isFree(x + dx, y);
+                if (vertical) add(0, dy);
+                if (horizontal) add(dx, 0);
+                if (vertical && horizontal) add(dx, dy);
+            } else if (dx != 0) {
+                const bool up = grid.isFree(x, y - 1);
+                const bool down = grid.isFree(x, y + 1);
+                if (grid.isFree(x + dx, y)) {
+                    add(dx, 0);
+                    if (up) add(dx, -1);
+                    if (down) add(dx, 1);
+                }
+                if (up) add(0, -1);
+                if (down) add(0, 1);
+            } else {
+                const bool left = grid.isFree(x - 1, y);
+                const bool right = grid.isFree(x + 1, y);
+                if (grid.isFree(x, y + dy)) {
+                    add(0, dy);
+                    if (left) add(-1, dy);
+                    if (right) add(1, dy);
+                }
+                if (left) add(-1, 0);
+                if (right) add(1, 0);
+            }
+        }
+
+        for (int d = 0; d < count; d++) {
+            const int dx = directions[d][0];
+            const int dy = directions[d][1];
+            const int next = jump(x, y, dx, dy, goal);
+            if (next < 0) continue;
+            const double total = cost[node] + octile(next % width - x, next / width - y);
+            if (generation[next] != currentGeneration || total < cost[next]) {
+                generation[next] = currentGeneration;
+                cost[next] = total;
+                parent[next] = node;
+                open.push({total + heuristic(next), next});
+            }
+        }
+    }
+
+    if (generation[goal] != currentGeneration) return false;
+    for (int node = goal; node >= 0; node = parent[node]) leg.points.push_back(grid.gridCentre(node));
+    std::reverse(leg.points.begin(), leg.points.end());
+    leg.found = true;
+    leg.length = cost[goal];
+    return true;
+}
+
+const PathPlanner::Leg& PathPlanner::doorLeg(int start, int goal)
+{
+    const uint64_t key = (uint64_t(uint32_t(start)) << 32) | uint32_t(goal);
+    auto it = legIndex.find(key);
+    if (it != legIndex.end()) {
+        cacheHits++;
+        legs.splice(legs.begin(), legs, it->second);
+        return legs.front().second;
+    }
+
+    Leg leg;
+    search(start, goal, leg);
+    legs.emplace_front(key, std::move(leg));
+    legIndex[key] = legs.begin();
+    if (legs.size() > cacheSize) {
+        legIndex.erase(legs.back().first);
+        legs.pop_back();
+    }
+    return legs.front().second;
+}
+
+void PathPlanner::smooth(std::vector<Vector2D>& points) const
+{
+    if (points.size() < 3) return;
+    std::vector<Vector2D> pulled = {points.front()};
+    size_t i = 0;
+    while (i + 1 < points.size()) {
+        size_t j = points.size() - 1;
+        while (j > i + 1 && !lineOfSight(points[i], points[j])) j--;
+        pulled.push_back(points[j]);
+        i = j;
+    }
+    points.swap(pulled);
+}
+
+bool PathPlanner::findPath(const Vector2D& from, const Vector2D& to, std::vector<Vector2D>& path)
+{
+    path.clear();
+    const CompiledPlan& compiled = *plan;
+    // A robot against a wall sits inside the mask's margin; so may a target
+    const double snapDistance = compiled.getRobotRadius() + 4.0 * CompiledPlan::gridCellSize;
+    const int start = compiled.nearestFree(from, snapDistance);
+    const int goal = compiled.nearestFree(to, snapDistance);
+    if (start < 0 || goal < 0) return false;
+
+    std::vector<Vector2D> points = {from};
+    auto append = [&](const Leg& leg) {
+        // Consecutive legs share their joining square
+        const size_t first = distance(points.back(), leg.points.front()) < 1e-9 ? 1 : 0;
+        points.insert(points.end(), leg.points.begin() + first, leg.points.end());
+    };
+
+    const std::vector<PlanDoor>& doors = compiled.getDoors();
+    const int fromRoom = compiled.roomAt(from);
+    const int toRoom = compiled.roomAt(to);
+    bool planned = false;
+    if (fromRoom >= 0 && toRoom >= 0 && fromRoom != toRoom && !doors.empty()) {
+        // Dijkstra over the doors. The legs to the first door and from the
+        // last are estimated by straight-line distance and searched only
+        // once the doors are chosen.
+        auto touches = [&](size_t d, int room) {
+            return doorSquares[d] >= 0 && (doors[d].firstRoom == room || doors[d].secondRoom == room);
+        };
+        const size_t count = doors.size();
+        std::vector<double> reach(count, std::numeric_limits<double>::infinity());
+        std::vector<int> previous(count, -1);
+        std::vector<char> done(count, 0);
+        for (size_t d = 0; d < count; d++) {
+            if (touches(d, fromRoom)) reach[d] = distance(from, doors[d].centre);
+        }
+        for (;;) {
+            int d = -1;
+            for (size_t e = 0; e < count; e++) {
+                if (!done[e] && reach[e] < std::numeric_limits<double>::infinity() && (d < 0 || reach[e] < reach[d])) {
+                    d = int(e);
+                }
+            }
+            if (d < 0) break;
+            done[d] = 1;
+            for (size_t e = 0; e < count; e++) {
+                if (done[e] || doorSquares[e] < 0) continue;
+                if (!touches(e, doors[d].firstRoom) && !touches(e, doors[d].secondRoom)) continue;
+                const Leg& leg = doorLeg(doorSquares[d], doorSquares[e]);
+                if (leg.found && reach[d] + leg.length < reach[e]) {
+                    reach[e] = reach[d] + leg.length;
+                    previous[e] = d;
+                }
+            }
+        }
+        int last = -1;
+        double best = std::numeric_limits<double>::infinity();
+        for (size_t d = 0; d < count; d++) {
+            if (!touches(d, toRoom)) continue;
+            const double total = reach[d] + distance(doors[d].centre, to);
+            if (total < best) {
+                best = total;
+                last = int(d);
+            }
+        }
+
+        if (last >= 0) {
+            std::vector<int> chain;
+            for (int d = last; d >= 0; d = previous[d]) chain.push_back(d);
+            std::reverse(chain.begin(), chain.end());
+
+            Leg leg;
+            planned = search(start, doorSquares[chain.front()], leg);
+            if (planned) append(leg);
+            for (size_t k = 1; planned && k < chain.size(); k++) {
+                const Leg& between = doorLeg(doorSquares[chain[k - 1]], doorSquares[chain[k]]);
+                planned = between.found;
+                if (planned) append(between);
+            }
+            if (planned) planned = search(doorSquares[chain.back()], goal, leg);
+            if (planned) append(leg);
+            if (!planned) points = {from};
+        }
+    }
+    if (!planned) {
+        Leg leg;
+        if (!search(start, goal, leg)) return false;
+        append(leg);
+    }
+
+    // End on the target itself when it is free
+    if (compiled.gridIndex(to) == goal) points.back() = to;
+    smooth(points);
+    path.assign(points.begin() + 1, points.end());
+    return true;
+}
@@ -0,0 +1,75 @@
+#ifndef PATHPLANNER_H
+#define PATHPLANNER_H
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "compiledplan.h"
+
+// Shortest paths for the robot centre over a compiled plan's free mask:
+// A* with jump-point search on the 8-connected grid, diagonal steps only
+// between two free sides, so paths never cut a corner. Jump points are
+// then pulled tight along lines of sight.
+//
+// A trip between rooms is planned as legs joined at door centres: the
+// doors are chosen by Dijkstra over the door graph, and the door-to-door
+// legs, the part every cross-room trip repeats, are kept in an LRU cache
+// keyed by their two end squares. Only the legs into the first door and
+// out of the last one are searched per query.
+//
+// A planner keeps scratch buffers and its cache; it belongs to one thread.
+// The plan it reads is shared.
+class PathPlanner
+{
+public:
+    static const size_t defaultCacheSize = 256;
+
+    explicit PathPlanner(std::shared_ptr<const CompiledPlan> plan, size_t cacheSize = defaultCacheSize);
+
+    // Waypoints after from, ending at the free point closest to to. False
+    // when either end is far from free space or no path joins them.
+    bool findPath(const Vector2D& from, const Vector2D& to, std::vector<Vector2D>& path);
+
+    // Whether the robot centre can move straight from a to b
+    bool lineOfSight(const Vector2D& a, const Vector2D& b) const;
+
+    const CompiledPlan& getPlan() const { return *plan; }
+    int getSearches() const { return searches; }
+    int getCacheHits() const { return cacheHits; }
+
+private:
+    struct Leg
+    {
+        bool found = false;
+        double length = 0.0;
+        std::vector<Vector2D> points;
+    };
+
+    bool search(int start, int goal, Leg& leg);
+    const Leg& doorLeg(int start, int goal);
+    int jump(int x, int y, int dx, int dy, int goal) const;
+    int jumpStraight(int x, int y, int dx, int dy, int goal) const;
+    void smooth(std::vector<Vector2D>& points) const;
+
+    std::shared_ptr<const CompiledPlan> plan;
+    std::vector<int> doorSquares;       // free square nearest each door centre, -1 if none
+
+    // A* scratch, reset per search by bumping the generation
+    std::vector<uint32_t> generation;
+    std::vector<double> cost;
+    std::vector<int> parent;
+    uint32_t currentGeneration = 0;
+
+    // LRU of door-to-door legs, most recent first
+    size_t cacheSize;
+    std::list<std::pair<uint64_t, Leg>> legs;
+    std::unordered_map<uint64_t, std::list<std::pair<uint64_t, Leg>>::iterator> legIndex;
+
+    int searches = 0;
+    int cacheHits = 0;
+};
+
+#endif // PATHPLANNER_H
@@ -0,0 +1,104 @@
+#include "planlayer.h"
+
+PlanLayer::PlanLayer(QVector<Room> rooms, QVector<Door> doors, QVector<Obstruction> obstructions,
+                     QGraphicsItem *parent)
+    : QGraphicsItem(parent)
+    , m_rooms(rooms)
+    , m_doors(doors)
+    , m_obstructions(obstructions)
+{
+    m_wallPen.setWidth(4);
+    m_obstructPen.setWidth(3);
+
+    for (Room &room : m_rooms) {
+        m_bounds = m_bounds.united(room.get_rectRoom());
+    }
+    for (Door &door : m_doors) {
+        m_bounds = m_bounds.united(QRectF(door.get_door().p1(), door.get_door().p2()).normalized());
+        m_bounds = m_bounds.united(QRectF(door.get_entry().p1(), door.get_entry().p2()).normalized());
+    }
+    for (Obstruction &obstruction : m_obstructions) {
+        m_bounds = m_bounds.united(obstruction.get_rect().normalized());
+    }
+
+    // Pad by the widest pen so the outer walls are not clipped by the cache
+    m_bounds.adjust(-m_wallPen.widthF(), -m_wallPen.widthF(), m_wallPen.widthF(), m_wallPen.widthF());
+
+    setCacheMode(QGraphicsItem::DeviceCoordinateCache);
+    setZValue(-1);
+}
+
+QRectF PlanLayer::boundingRect() const
+{
+    return m_bounds;
+}
+
+void PlanLayer::paint(QPainter *painter, const QStyleOptionGraphicsItem *, QWidget *)
+{
+    painter->setRenderHint(QPainter::Antialiasing);
+
+    // Rooms are outlines only, so the coverage layers show through
+    painter->setPen(m_wallPen);
+    painter->setBrush(Qt::NoBrush);
+    for (Room &room : m_rooms) {
+        painter->drawRect(room.get_rectRoom());
+    }
+
+    QPen penWhite = QPen(Qt::white);
+    penWhite.setWidth(2);
+    for (Door &door : m_doors) {
+        painter->setPen(m_wallPen);
+        painter->drawLine(door.get_door());
+        painter->setPen(penWhite);
+        painter->drawLine(door.get_entry());
+    }
+
+    QBrush overlayBrush(QColor(255, 0, 0, 127));
+    for (Obstruction &obstruction : m_obstructions) {
+        painter->setPen(m_obstructPen);
+        painter->setBrush(Qt::NoBrush);
+        painter->drawRect(obstruction.get_rect());
+
+        painter->setPen(Qt::NoPen);
+        painter->setBrush(overlayBrush);
+        if (obstruction.get_isChest()) {
+            painter->drawRect(obstruction.get_overlay());
+        } else {
+            QRectF *legs = obstruction.get_legs();
+            for (int i = 0; i < 4; i++) {
+                painter->drawEllipse(legs[i]);
+            }
+        }
+    }
+}
+
+PlanLayer *PlanLayer::fromJson(const QJsonObject &root)
+{
+    QVector<Room> rooms;
+    QVector<Door> doors;
+    QVector<Obstruction> obstructions;
+
+    for (const QJsonValue &value : root.value("rooms").toArray()) {
+        rooms.append(Room(value.toObject()));
+    }
+    for (const QJsonValue &value : root.value("doors").toArray()) {
+        doors.append(Door(value.toObject()));
+    }
+    for (const QJsonValue &value : root.value("obstructions").toArray()) {
+        obstructions.append(Obstruction(value.toObject()));
+    }
+
+    return new PlanLayer(rooms, doors, obstructions);
+}
+
+QPixmap PlanLayer::toPixmap(const QSize &size)
+{
+    QPixmap pixmap(size);
+    pixmap.fill(Qt::transparent);
+
+    QPainter painter(&pixmap);
+    painter.scale(size.width() / m_bounds.width(), size.height() / m_bounds.height());
+    painter.translate(-m_bounds.topLeft());
+    paint(&painter, nullptr, nullptr);
+    return pixmap;
+}
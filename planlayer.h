@@ -0,0 +1,43 @@
+#ifndef PLANLAYER_H
+#define PLANLAYER_H
+
+#include <QGraphicsItem>
+#include <QPainter>
+#include <QPen>
+#include <QBrush>
+#include <QVector>
+#include <QPixmap>
+
+#include "house.h"
+
+// Static floorplan drawn as a single scene item for the simulation view.
+// Rooms, doors, obstructions and legs never move during a run, so they are
+// painted once into a device-coordinate cache and only repainted when the
+// view transform (zoom) changes. The vacuum and its trail stay as separate
+// dynamic items above this layer.
+class PlanLayer : public QGraphicsItem
+{
+public:
+    PlanLayer(QVector<Room> rooms, QVector<Door> doors, QVector<Obstruction> obstructions,
+              QGraphicsItem *parent = nullptr);
+
+    QRectF boundingRect() const override;
+    void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget = nullptr) override;
+
+    // Builds the layer straight from a floorplan JSON object, e.g. one embedded in a trajectory
+    static PlanLayer *fromJson(const QJsonObject &root);
+
+    // Renders the whole layer into a pixmap of the given size, for views that share one copy
+    QPixmap toPixmap(const QSize &size);
+
+private:
+    QVector<Room> m_rooms;
+    QVector<Door> m_doors;
+    QVector<Obstruction> m_obstructions;
+
+    QRectF m_bounds;
+    QPen m_wallPen;
+    QPen m_obstructPen;
+};
+
+#endif // PLANLAYER_H
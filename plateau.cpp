@@ -0,0 +1,54 @@
+#include "plateau.h"
+#include "bytestream.h"
+
+#include <cstddef>
+
+PlateauDetector::PlateauDetector(int window, double minGain)
+    : window(window > 0 ? window : 0)
+    , minGain(minGain)
+{
+    reset();
+}
+
+void PlateauDetector::reset()
+{
+    samples.assign(std::size_t(window), 0.0);
+    time = 0;
+    plateauTime = -1;
+}
+
+bool PlateauDetector::add(double coverage)
+{
+    if (!isEnabled()) return false;
+    if (hasPlateaued()) return true;
+
+    // Before it is overwritten, the slot holds the sample from `window` seconds ago
+    double &slot = samples[std::size_t(time % window)];
+    if (time >= window && coverage - slot < minGain) {
+        plateauTime = time - window;
+    }
+    slot = coverage;
+    time++;
+    return hasPlateaued();
+}
+
+void PlateauDetector::save(ByteWriter& out) const
+{
+    out.putVarint(uint64_t(time));
+    out.putSigned(plateauTime);
+    int stored = time < window ? time : window;
+    for (int i = 0; i < stored; i++) out.putDouble(samples[std::size_t(i)]);
+}
+
+bool PlateauDetector::load(ByteReader& in)
+{
+    uint64_t t = in.getVarint();
+    int64_t plateau = in.getSigned();
+    if (!in.ok() || t > uint64_t(INT32_MAX)) return false;
+    reset();
+    time = int(t);
+    plateauTime = int(plateau);
+    int stored = time < window ? time : window;
+    for (int i = 0; i < stored; i++) samples[std::size_t(i)] = in.getDouble();
+    return in.ok();
+}
@@ -0,0 +1,40 @@
+#ifndef PLATEAU_H
+#define PLATEAU_H
+
+#include <vector>
+
+class ByteWriter;
+class ByteReader;
+
+// Convergence test on the coverage-over-time signal. Fed one coverage sample
+// per simulated second, it reports a plateau once the last `window` seconds
+// added less than minGain. Keeps one sample per second of window.
+class PlateauDetector
+{
+public:
+    // A window of 0 disables the detector
+    explicit PlateauDetector(int window = 0, double minGain = 1.0);
+
+    void reset();
+
+    // True once coverage has plateaued; stays true until reset()
+    bool add(double coverage);
+
+    bool isEnabled() const { return window > 0; }
+    bool hasPlateaued() const { return plateauTime >= 0; }
+    // Simulated second at which the flat window began, -1 before a plateau
+    int getPlateauTime() const { return plateauTime; }
+
+    // The sample history; the window and gain are configuration
+    void save(ByteWriter& out) const;
+    bool load(ByteReader& in);
+
+private:
+    int window;
+    double minGain;
+    std::vector<double> samples;    // ring buffer, samples[t % window]
+    int time = 0;
+    int plateauTime = -1;
+};
+
+#endif // PLATEAU_H
@@ -0,0 +1,81 @@
+#include "pocketmap.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+PocketMap::PocketMap(const FrontierMap& frontiers)
+    : map(frontiers)
+    , width(frontiers.getPlan().getGridWidth())
+    , height(frontiers.getPlan().getGridHeight())
+    , sums(size_t(width + 1) * (height + 1), 0)
+{
+    const int stride = width + 1;
+    for (int y = 0; y < height; y++) {
+        int32_t row = 0;
+        for (int x = 0; x < width; x++) {
+            const int index = y * width + x;
+            row += map.getComponent(index) >= 0 && !map.isCovered(index);
+            sums[size_t(y + 1) * stride + x + 1] = sums[size_t(y) * stride + x + 1] + row;
+        }
+    }
+}
+
+int PocketMap::uncovered(int x0, int y0, int x1, int y1) const
+{
+    x0 = std::max(x0, 0);
+    y0 = std::max(y0, 0);
+    x1 = std::min(x1, width - 1);
+    y1 = std::min(y1, height - 1);
+    if (x0 > x1 || y0 > y1) return 0;
+    const size_t stride = width + 1;
+    return sums[(y1 + 1) * stride + x1 + 1] - sums[y0 * stride + x1 + 1] -
+           sums[(y1 + 1) * stride + x0] + sums[y0 * stride + x0];
+}
+
+double PocketMap::spotRadius(int index, double maxRadius) const
+{
+    // The distance runs to the centre of the nearest blocked square; a
+    // square short of it keeps the robot off that square's near edge
+    const double clearance = map.getPlan().getWallDistance(index % width, index / width) - CompiledPlan::gridCellSize;
+    return std::max(0.0, std::min(maxRadius, clearance));
+}
+
+int PocketMap::worst(const Vector2D& pos, double maxRadius, const std::vector<char>* allowedRooms) const
+{
+    const CompiledPlan& plan = map.getPlan();
+    const int from = plan.nearestFree(pos, plan.getRobotRadius() + 4 * CompiledPlan::gridCellSize);
+    if (from < 0) return -1;
+    const int component = map.getComponent(from);
+    const Vector2D start = plan.gridCentre(from);
+    const double lane = laneSpacing(plan);
+    const double squareArea = CompiledPlan::gridCellSize * CompiledPlan::gridCellSize;
+
+    int best = -1;
+    double bestYield = 0.0;
+    for (int index = 0; index < width * height; index++) {
+        if (map.getComponent(index) != component || map.isCovered(index)) continue;
+        const int room = map.getRoom(index);
+        if (allowedRooms && (room < 0 || !(*allowedRooms)[room])) continue;
+
+        const double radius = spotRadius(index, maxRadius);
+        // The last turn may stop up to a lane short of the spot radius
+        const double reach = std::max(0.0, radius - lane) + plan.getRobotRadius();
+        const int half = int(reach / std::sqrt(2.0) / CompiledPlan::gridCellSize);
+        const int x = index % width;
+        const int y = index / width;
+        const int count = uncovered(x - half, y - half, x + half, y + half);
+
+        // Straight to the centre, then a spiral of radius/lane turns; the
+        // spiral alone bounds the yield before the distance is worked out
+        const double spiral = M_PI * radius * radius / lane + lane;
+        if (count * squareArea / spiral <= bestYield) continue;
+        const Vector2D centre = plan.gridCentre(index);
+        const double yield = count * squareArea / (std::hypot(centre.x - start.x, centre.y - start.y) + spiral);
+        if (yield > bestYield) {
+            best = index;
+            bestYield = yield;
+        }
+    }
+    return best;
+}
@@ -0,0 +1,48 @@
+#ifndef POCKETMAP_H
+#define POCKETMAP_H
+
+#include <cstdint>
+#include <vector>
+
+#include "frontier.h"
+
+// Under-cleaned pockets of a coverage map, for spot cleaning. An integral
+// image of the free squares still uncovered gives the uncovered count of
+// any window in four lookups, so a candidate pocket costs O(1) to score
+// however wide its window is.
+//
+// A pocket is centred on a free square and spiralled out, turns a lane
+// apart, to its spot radius: the given maximum, held inside the plan's
+// distance field so the spiral clears the walls. Its window is the square
+// inscribed in the disk that spiral is sure to sweep, so every square it
+// counts is one the spiral covers.
+class PocketMap
+{
+public:
+    // Sums map's uncovered free squares; O(squares). map must outlive it.
+    explicit PocketMap(const FrontierMap& map);
+
+    // Spacing of the spiral's turns: a swath less a unit of overlap, as
+    // boustrophedon lays its lanes
+    static double laneSpacing(const CompiledPlan& plan) { return 2.0 * plan.getRobotRadius() - 1.0; }
+
+    // Uncovered free squares in x0..x1, y0..y1, clipped to the grid
+    int uncovered(int x0, int y0, int x1, int y1) const;
+    // How far the robot centre can spiral out from a free square
+    double spotRadius(int index, double maxRadius) const;
+
+    // The worst pocket to leave from pos: the uncovered free square in pos's
+    // component whose pocket holds the most uncovered floor per unit of the
+    // walk there (as the crow flies) and of its spiral; ties go to the lower
+    // index. -1 when every square is covered. Given allowedRooms (a flag per
+    // room), only squares in those rooms count.
+    int worst(const Vector2D& pos, double maxRadius, const std::vector<char>* allowedRooms = nullptr) const;
+
+private:
+    const FrontierMap& map;
+    int width;
+    int height;
+    std::vector<int32_t> sums;          // (width + 1) x (height + 1), zero first row and column
+};
+
+#endif // POCKETMAP_H
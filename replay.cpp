@@ -0,0 +1,146 @@
+#include "replay.h"
+
+#include <QPen>
+#include <QBrush>
+#include <QDebug>
+#include <QJsonDocument>
+
+#include "planlayer.h"
+
+RunReplay::RunReplay(QGraphicsScene *scene)
+    : m_scene(scene)
+{
+}
+
+bool RunReplay::load(const QByteArray &bytes, bool addPlanLayer)
+{
+    std::vector<uint8_t> data(bytes.begin(), bytes.end());
+    m_loaded = m_reader.load(std::move(data));
+    if (!m_loaded) {
+        qWarning() << "Invalid trajectory file";
+        return false;
+    }
+
+    QByteArray planJson = QByteArray::fromStdString(m_reader.getPlanJson());
+    PlanLayer *plan = PlanLayer::fromJson(QJsonDocument::fromJson(planJson).object());
+    m_planBounds = plan->boundingRect();
+    if (addPlanLayer) {
+        m_scene->addItem(plan);
+    } else {
+        delete plan;
+    }
+
+    m_grid.reset(m_planBounds.left(), m_planBounds.top(), m_planBounds.right(), m_planBounds.bottom(), 1.0);
+    m_coverageTick = -1;
+    m_reader.seek(m_coverageCursor, 0);
+
+    m_coverageLayer = m_scene->addPixmap(QPixmap());
+    m_coverageLayer->setZValue(1);
+    m_coverageLayer->setOpacity(0.85);
+    m_coverageLayer->setPos(m_grid.getOriginX(), m_grid.getOriginY());
+    m_coverageLayer->setScale(m_grid.getCellSize());
+
+    m_robot = m_scene->addEllipse(-m_radius, -m_radius, 2 * m_radius, 2 * m_radius,
+                                  QPen(Qt::black), QBrush(Qt::red));
+    m_robot->setZValue(2);
+
+    setTick(0);
+    return true;
+}
+
+bool RunReplay::isLoaded() const
+{
+    return m_loaded;
+}
+
+int RunReplay::getTickCount() const
+{
+    return m_reader.getTickCount();
+}
+
+int RunReplay::getTick() const
+{
+    return m_tick;
+}
+
+const TrajectoryReader &RunReplay::getReader() const
+{
+    return m_reader;
+}
+
+const VisitGrid &RunReplay::getGrid() const
+{
+    return m_grid;
+}
+
+QRectF RunReplay::getPlanBounds() const
+{
+    return m_planBounds;
+}
+
+void RunReplay::setColorMap(ColorMap map)
+{
+    m_renderer.setColorMap(map);
+    refreshCoverage();
+}
+
+void RunReplay::setTick(int tick)
+{
+    if (!m_loaded || getTickCount() == 0) return;
+    tick = qBound(0, tick, getTickCount() - 1);
+    m_tick = tick;
+
+    // Robot marker: keyframe binary search plus a short decode
+    TrajectoryPoint robot = m_reader.pointAt(tick);
+    m_robot->setPos(robot.x, robot.y);
+
+    // Coverage: only stamp what was not stamped yet
+    if (tick < m_coverageTick) {
+        m_grid.clear();
+        m_reader.seek(m_coverageCursor, 0);
+        m_coverageTick = -1;
+    }
+
+    TrajectoryPoint point;
+    while (m_coverageTick < tick && m_reader.next(m_coverageCursor, point)) {
+        if (m_coverageTick < 0) {
+            m_grid.stampDisc(point.x, point.y, m_radius);
+        } else {
+            m_grid.stampSegment(m_lastPoint.x, m_lastPoint.y, point.x, point.y, m_radius);
+        }
+        m_lastPoint = point;
+        m_coverageTick = point.tick;
+    }
+
+    refreshCoverage();
+}
+
+void RunReplay::refreshCoverage()
+{
+    if (!m_coverageLayer) return;
+    m_coverageLayer->setPixmap(QPixmap::fromImage(m_renderer.render(m_grid)));
+}
+
+//---------------------------------------------------------------------------------------------------------------------------------------
+//---------------------------------------------------------------------------------------------------------------------------------------
+
+ReplayView::ReplayView(QGraphicsScene *scene, QWidget *parent)
+    : QGraphicsView(scene, parent)
+{
+    setRenderHint(QPainter::SmoothPixmapTransform, true);
+}
+
+void ReplayView::setPlanPixmap(const QPixmap &pixmap, const QRectF &planBounds)
+{
+    m_planPixmap = pixmap;
+    m_planBounds = planBounds;
+    viewport()->update();
+}
+
+void ReplayView::drawBackground(QPainter *painter, const QRectF &rect)
+{
+    QGraphicsView::drawBackground(painter, rect);
+    if (!m_planPixmap.isNull()) {
+        painter->drawPixmap(m_planBounds, m_planPixmap, QRectF(m_planPixmap.rect()));
+    }
+}
@@ -0,0 +1,76 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <QGraphicsScene>
+#include <QGraphicsView>
+#include <QGraphicsPixmapItem>
+#include <QGraphicsEllipseItem>
+#include <QByteArray>
+
+#include "trajectory.h"
+#include "visitgrid.h"
+#include "heatmap.h"
+
+// Plays a recorded trajectory back into a scene: the floorplan embedded in
+// the recording, a coverage layer rebuilt from the recorded path and a
+// marker for the robot. Moving forward only
+// stamps the new ticks; moving backward restarts the coverage from tick 0
+// while the marker jumps there through the keyframe index.
+class RunReplay
+{
+public:
+    RunReplay(QGraphicsScene *scene);
+
+    // addPlanLayer is false when the plan is drawn by a shared ReplayView background
+    bool load(const QByteArray &bytes, bool addPlanLayer = true);
+    bool isLoaded() const;
+
+    int getTickCount() const;
+    int getTick() const;
+    void setTick(int tick);
+
+    void setColorMap(ColorMap map);
+    const TrajectoryReader &getReader() const;
+    const VisitGrid &getGrid() const;
+    QRectF getPlanBounds() const;
+
+private:
+    void refreshCoverage();
+
+    QGraphicsScene *m_scene;
+    QGraphicsPixmapItem *m_coverageLayer = nullptr;
+    QGraphicsEllipseItem *m_robot = nullptr;
+
+    TrajectoryReader m_reader;
+    TrajectoryCursor m_coverageCursor;
+    TrajectoryPoint m_lastPoint;
+    int m_coverageTick = -1;
+    int m_tick = 0;
+    bool m_loaded = false;
+    QRectF m_planBounds;
+
+    VisitGrid m_grid;
+    HeatmapRenderer m_renderer;
+
+    const double m_radius = 6.4;
+};
+
+// View that paints the static floorplan from a pixmap shared between several
+// views, so side-by-side replays of one floorplan keep a single cached copy
+// of the plan instead of one PlanLayer per scene.
+class ReplayView : public QGraphicsView
+{
+public:
+    explicit ReplayView(QGraphicsScene *scene, QWidget *parent = nullptr);
+
+    void setPlanPixmap(const QPixmap &pixmap, const QRectF &planBounds);
+
+protected:
+    void drawBackground(QPainter *painter, const QRectF &rect) override;
+
+private:
+    QPixmap m_planPixmap;
+    QRectF m_planBounds;
+};
+
+#endif // REPLAY_H
@@ -1,9 +1,11 @@
 #include "reportwindow.h"
 #include "ui_reportwindow.h"
+#include "comparewindow.h"
 
 #include <QDebug>
 #include <QStyleFactory>
 #include <QFileDialog>
+#include <QMessageBox>
 #include <QStringList>
 #include <QRegularExpression>
 
@@ -14,10 +16,15 @@ ReportWindow::ReportWindow(QWidget *parent)
     ui->setupUi(this);
     this->setFocus();
     data = new RunData();
+
+    replayTimer = new QTimer(this);
+    replayTimer->setInterval(30);
+    connect(replayTimer, &QTimer::timeout, this, &ReportWindow::advanceReplay);
 }
 
 ReportWindow::~ReportWindow()
 {
+    delete replay;
     delete ui;
 }
 
@@ -39,6 +46,8 @@ void ReportWindow::updateText(){
         ui->runTime->setText(data->runs[0].getTimeString(data->runs[0].time));
         ui->cleanSqFt->setText(data->runs[0].coverSF);
         ui->perCleaned->setText(data->runs[0].coverPer + " %");
+        ui->coverageChart->setHistory(&data->runs[0].coverage);
+        setupReplay(data->runs[0]);
         QPixmap map(data->runs[0].heatmapPath);
         ui->heatMap->setScene(new QGraphicsScene(this));
         ui->heatMap->scene()->addPixmap(map.scaled(600, 400, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation));
@@ -48,6 +57,8 @@ void ReportWindow::updateText(){
         ui->runTime->setText(data->runs[1].getTimeString(data->runs[1].time));
         ui->cleanSqFt->setText(data->runs[1].coverSF);
         ui->perCleaned->setText(data->runs[1].coverPer + " %");
+        ui->coverageChart->setHistory(&data->runs[1].coverage);
+        setupReplay(data->runs[1]);
         QPixmap map(data->runs[1].heatmapPath);
         ui->heatMap->setScene(new QGraphicsScene(this));
         ui->heatMap->scene()->addPixmap(map.scaled(600, 400, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation));
@@ -56,6 +67,8 @@ void ReportWindow::updateText(){
         ui->runTime->setText(data->runs[2].getTimeString(data->runs[2].time));
         ui->cleanSqFt->setText(data->runs[2].coverSF);
         ui->perCleaned->setText(data->runs[2].coverPer + " %");
+        ui->coverageChart->setHistory(&data->runs[2].coverage);
+        setupReplay(data->runs[2]);
         QPixmap map(data->runs[2].heatmapPath);
         ui->heatMap->setScene(new QGraphicsScene(this));
         ui->heatMap->scene()->addPixmap(map.scaled(600, 400, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation));
@@ -64,10 +77,22 @@ void ReportWindow::updateText(){
         ui->runTime->setText(data->runs[3].getTimeString(data->runs[3].time));
         ui->cleanSqFt->setText(data->runs[3].coverSF);
         ui->perCleaned->setText(data->runs[3].coverPer + " %");
+        ui->coverageChart->setHistory(&data->runs[3].coverage);
+        setupReplay(data->runs[3]);
         QPixmap map(data->runs[3].heatmapPath);
         ui->heatMap->setScene(new QGraphicsScene(this));
         ui->heatMap->scene()->addPixmap(map.scaled(600, 400, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation));
     }
+    else if (selectedAlg == "frontier"){
+        ui->runTime->setText(data->runs[4].getTimeString(data->runs[4].time));
+        ui->cleanSqFt->setText(data->runs[4].coverSF);
+        ui->perCleaned->setText(data->runs[4].coverPer + " %");
+        ui->coverageChart->setHistory(&data->runs[4].coverage);
+        setupReplay(data->runs[4]);
+        QPixmap map(data->runs[4].heatmapPath);
+        ui->heatMap->setScene(new QGraphicsScene(this));
+        ui->heatMap->scene()->addPixmap(map.scaled(600, 400, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation));
+    }
 
 
     this->show();
@@ -107,6 +132,13 @@ bool ReportWindow::setupSceneFromSim(QString sim_file_path){
         else{
             ui->wallfollowAlg->setEnabled(1);
         }
+
+        if (!data->runs[4].exists){
+            ui->frontierAlg->setEnabled(0);
+        }
+        else{
+            ui->frontierAlg->setEnabled(1);
+        }
         updateText();
         return true;
     }
@@ -147,6 +179,13 @@ bool ReportWindow::setupSceneFromFile(){
         else{
             ui->wallfollowAlg->setEnabled(1);
         }
+
+        if (!data->runs[4].exists){
+            ui->frontierAlg->setEnabled(0);
+        }
+        else{
+            ui->frontierAlg->setEnabled(1);
+        }
         updateText();
         return true;
     }
@@ -182,3 +221,110 @@ void ReportWindow::on_wallfollowAlg_clicked()
 }
 
 
+void ReportWindow::on_frontierAlg_clicked()
+{
+    selectedAlg = "frontier";
+    updateText();
+}
+
+// Loads the run's trajectory, if one was recorded, and enables the scrubber.
+// The static heatmap stays on screen until the scrubber is used.
+void ReportWindow::setupReplay(Run &run)
+{
+    replayTimer->stop();
+    ui->playButton->setText("Play");
+
+    delete replay;
+    replay = nullptr;
+    delete replayScene;
+    replayScene = nullptr;
+
+    QFile file(run.trajectoryPath);
+    if (!run.trajectoryPath.isEmpty() && file.open(QIODevice::ReadOnly)) {
+        replayScene = new QGraphicsScene(this);
+        replay = new RunReplay(replayScene);
+        if (!replay->load(file.readAll())) {
+            delete replay;
+            replay = nullptr;
+        }
+    }
+
+    bool hasReplay = replay != nullptr;
+    ui->playButton->setEnabled(hasReplay);
+    ui->replaySlider->setEnabled(hasReplay);
+
+    ui->replaySlider->blockSignals(true);
+    ui->replaySlider->setRange(0, hasReplay ? replay->getTickCount() - 1 : 0);
+    ui->replaySlider->setValue(ui->replaySlider->maximum());
+    ui->replaySlider->blockSignals(false);
+}
+
+void ReportWindow::showReplay()
+{
+    if (!replay || ui->heatMap->scene() == replayScene) return;
+    ui->heatMap->setScene(replayScene);
+    ui->heatMap->fitInView(replayScene->itemsBoundingRect(), Qt::KeepAspectRatio);
+}
+
+void ReportWindow::on_playButton_clicked()
+{
+    if (!replay) return;
+
+    if (replayTimer->isActive()) {
+        replayTimer->stop();
+        ui->playButton->setText("Play");
+        return;
+    }
+
+    if (ui->replaySlider->value() >= ui->replaySlider->maximum()) {
+        ui->replaySlider->setValue(0);
+    }
+    showReplay();
+    replayTimer->start();
+    ui->playButton->setText("Pause");
+}
+
+void ReportWindow::advanceReplay()
+{
+    // Whole replay takes about 20 seconds regardless of run length
+    int step = qMax(1, replay->getTickCount() / 600);
+    int next = ui->replaySlider->value() + step;
+    if (next >= ui->replaySlider->maximum()) {
+        next = ui->replaySlider->maximum();
+        replayTimer->stop();
+        ui->playButton->setText("Play");
+    }
+    ui->replaySlider->setValue(next);
+}
+
+void ReportWindow::on_replaySlider_valueChanged(int tick)
+{
+    if (!replay) return;
+
+    showReplay();
+    replay->setTick(tick);
+
+    // One tick is one simulated second
+    ui->replayTime->setText(QString("%1:%2:%3").arg(tick / 3600, 2, 10, QChar('0'))
+                                .arg((tick / 60) % 60, 2, 10, QChar('0'))
+                                .arg(tick % 60, 2, 10, QChar('0')));
+}
+
+void ReportWindow::on_compareButton_clicked()
+{
+    CompareWindow *compare = new CompareWindow();
+    compare->setAttribute(Qt::WA_DeleteOnClose);
+
+    for (int i = 0; i < data->runs.size() && compare->getRunCount() < CompareWindow::maxRuns; i++) {
+        Run &run = data->runs[i];
+        if (!run.exists || run.trajectoryPath.isEmpty()) continue;
+        compare->addRun(run.alg, run.trajectoryPath);
+    }
+
+    if (compare->getRunCount() < 2) {
+        QMessageBox::information(this, "Compare Runs", "At least two runs with recorded replays are needed to compare.");
+        delete compare;
+        return;
+    }
+    compare->show();
+}
@@ -2,9 +2,11 @@
 #define REPORTWINDOW_H
 
 #include "rundata.h"
+#include "replay.h"
 #include <QMainWindow>
 #include <QGraphicsScene>
 #include <QString>
+#include <QTimer>
 
 namespace Ui {
 class ReportWindow;
@@ -33,9 +35,25 @@ private slots:
 
     void on_wallfollowAlg_clicked();
 
+    void on_frontierAlg_clicked();
+
+    void on_playButton_clicked();
+
+    void on_replaySlider_valueChanged(int tick);
+
+    void advanceReplay();
+
+    void on_compareButton_clicked();
+
 private:
     Ui::ReportWindow *ui;
     RunData *data;
+
+    QGraphicsScene *replayScene = nullptr;
+    RunReplay *replay = nullptr;
+    QTimer *replayTimer;
+    void setupReplay(Run &run);
+    void showReplay();
 };
 
 #endif // REPORTWINDOW_H
@@ -0,0 +1,256 @@
+#include "resultcache.h"
+#include "bytestream.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include <algorithm>
+
+namespace {
+const char entryMagic[4] = {'R', 'S', 'R', 'C'};
+const char entrySuffix[] = ".rsrc";
+}
+
+ResultCache::ResultCache(const QString &directory, qint64 maxBytes)
+    : directory(directory)
+    , maxBytes(maxBytes)
+{
+}
+
+QString ResultCache::defaultDirectory()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/results";
+}
+
+QString ResultCache::makeKey(const QByteArray &planHash, const QString &algorithm, quint64 seed,
+                             const EnsembleSettings &settings)
+{
+    // Vacuum matches algorithm names case-insensitively
+    QStringList parts = {
+        "robosim-result " + QString::number(formatVersion),
+        QString::fromLatin1(planHash.toHex()),
+        algorithm.toLower(),
+        QString::number(seed),
+        QString::number(settings.batteryLife),
+        QString::number(settings.vacuumEfficiency),
+        QString::number(settings.whiskerEfficiency),
+        QString::number(settings.speed)
+    };
+    // A run cut short at a plateau is a different result
+    if (settings.plateauWindow > 0) {
+        parts << "plateau" << QString::number(settings.plateauWindow)
+              << QString::number(settings.plateauMinGain, 'g', 17);
+    }
+    if (settings.stuckAction != StuckAction::Report) {
+        parts << QString("stuck-") + stuckActionName(settings.stuckAction);
+    }
+    // Default parameters leave the keys of earlier runs valid
+    if (!settings.strategyParams.isDefault()) {
+        parts << "params" << settings.strategyParams.describe();
+    }
+    QByteArray hash = QCryptographicHash::hash(parts.join('|').toUtf8(), QCryptographicHash::Sha256);
+    return QString::fromLatin1(hash.toHex());
+}
+
+QString ResultCache::entryPath(const QString &key) const
+{
+    return directory + "/" + key.left(2) + "/" + key + entrySuffix;
+}
+
+bool ResultCache::load(const QString &key, CachedRun &run)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        scan();
+    }
+
+    // Read and decompress outside the lock, which every worker shares
+    const QString path = entryPath(key);
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        std::lock_guard<std::mutex> lock(mutex);
+        remove(key);        // deleted by another process
+        return false;
+    }
+    QByteArray bytes = file.readAll();
+    file.close();
+
+    ByteReader in(reinterpret_cast<const uint8_t*>(bytes.constData()), size_t(bytes.size()));
+    char magic[4] = {};
+    in.getRaw(magic, sizeof magic);
+    bool valid = std::equal(magic, magic + 4, entryMagic) &&
+                 in.getVarint() == uint64_t(formatVersion) &&
+                 in.getString() == key.toStdString();
+
+    CachedRun loaded;
+    loaded.metrics.algorithm = QString::fromStdString(in.getString());
+    loaded.metrics.seed = in.getVarint();
+    loaded.metrics.coverage = in.getDouble();
+    loaded.metrics.runtime = int(in.getSigned());
+    loaded.metrics.recleanRatio = in.getDouble();
+    loaded.metrics.plateauTime = int(in.getSigned());
+    StuckTelemetry &stuck = loaded.metrics.stuck;
+    stuck.stuckEvents = int(in.getVarint());
+    stuck.oscillationEvents = int(in.getVarint());
+    stuck.stuckTicks = int(in.getVarint());
+    stuck.recoveries = int(in.getVarint());
+    stuck.aborted = in.getByte() != 0;
+    std::vector<uint8_t> packed = in.getBytes();
+    valid = valid && in.ok();
+
+    QByteArray payload;
+    if (valid) {
+        payload = qUncompress(reinterpret_cast<const uchar*>(packed.data()), int(packed.size()));
+        ByteReader body(reinterpret_cast<const uint8_t*>(payload.constData()), size_t(payload.size()));
+        valid = loaded.coverage.load(body);
+        loaded.trajectory = body.getBytes();
+        valid = valid && body.ok();
+    }
+    if (!valid) {
+        std::lock_guard<std::mutex> lock(mutex);
+        QFile::remove(path);
+        remove(key);
+        return false;
+    }
+
+    run = std::move(loaded);
+
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    // ExistingOnly: an entry evicted meanwhile must not come back empty
+    if (file.open(QIODevice::ReadWrite | QIODevice::ExistingOnly)) {
+        file.setFileTime(QDateTime::fromMSecsSinceEpoch(now), QFileDevice::FileModificationTime);
+        file.close();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(key);
+    if (it == entries.end()) {
+        // Written by another process since the scan, unless evicted while we read it
+        if (!QFile::exists(path)) return true;
+        it = entries.insert(key, Entry());
+        it->size = bytes.size();
+        totalBytes += it->size;
+    }
+    it->lastUse = now;
+    return true;
+}
+
+bool ResultCache::store(const QString &key, const CachedRun &run)
+{
+    // Build the entry outside the lock; compressing the raster is the slow part
+    ByteWriter body;
+    run.coverage.save(body);
+    body.putBytes(run.trajectory);
+    QByteArray packed = qCompress(reinterpret_cast<const uchar*>(body.data().data()), int(body.size()));
+
+    ByteWriter out;
+    out.putRaw(entryMagic, sizeof entryMagic);
+    out.putVarint(uint64_t(formatVersion));
+    out.putString(key.toStdString());
+    out.putString(run.metrics.algorithm.toStdString());
+    out.putVarint(run.metrics.seed);
+    out.putDouble(run.metrics.coverage);
+    out.putSigned(run.metrics.runtime);
+    out.putDouble(run.metrics.recleanRatio);
+    out.putSigned(run.metrics.plateauTime);
+    const StuckTelemetry &stuck = run.metrics.stuck;
+    out.putVarint(uint64_t(stuck.stuckEvents));
+    out.putVarint(uint64_t(stuck.oscillationEvents));
+    out.putVarint(uint64_t(stuck.stuckTicks));
+    out.putVarint(uint64_t(stuck.recoveries));
+    out.putByte(stuck.aborted);
+    out.putBytes(reinterpret_cast<const uint8_t*>(packed.constData()), size_t(packed.size()));
+
+    std::lock_guard<std::mutex> lock(mutex);
+    scan();
+
+    const QString path = entryPath(key);
+    if (!QDir().mkpath(QFileInfo(path).absolutePath())) return false;
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) return false;
+    file.write(reinterpret_cast<const char*>(out.data().data()), qint64(out.size()));
+    if (!file.commit()) return false;
+
+    Entry &entry = entries[key];
+    totalBytes += qint64(out.size()) - entry.size;
+    entry.size = qint64(out.size());
+    entry.lastUse = QDateTime::currentMSecsSinceEpoch();
+    evict();
+    return true;
+}
+
+qint64 ResultCache::getSize()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    scan();
+    return totalBytes;
+}
+
+int ResultCache::getEntryCount()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    scan();
+    return entries.size();
+}
+
+void ResultCache::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    scan();
+    for (auto it = entries.constBegin(); it != entries.constEnd(); ++it) {
+        QFile::remove(entryPath(it.key()));
+    }
+    entries.clear();
+    totalBytes = 0;
+}
+
+// The index is built from the directory on first use; entries other
+// processes add later are picked up the next time a cache is opened
+void ResultCache::scan()
+{
+    if (scanned) return;
+    scanned = true;
+
+    QDirIterator it(directory, {QString("*") + entrySuffix}, QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        it.next();
+        QFileInfo info = it.fileInfo();
+        Entry entry;
+        entry.size = info.size();
+        entry.lastUse = info.lastModified().toMSecsSinceEpoch();
+        entries.insert(info.completeBaseName(), entry);
+        totalBytes += entry.size;
+    }
+}
+
+void ResultCache::remove(const QString &key)
+{
+    auto it = entries.find(key);
+    if (it == entries.end()) return;
+    totalBytes -= it->size;
+    entries.erase(it);
+}
+
+void ResultCache::evict()
+{
+    if (totalBytes <= maxBytes) return;
+
+    std::vector<std::pair<qint64, QString>> byAge;
+    byAge.reserve(size_t(entries.size()));
+    for (auto it = entries.constBegin(); it != entries.constEnd(); ++it) {
+        byAge.emplace_back(it->lastUse, it.key());
+    }
+    std::sort(byAge.begin(), byAge.end());
+
+    for (const auto &oldest : byAge) {
+        if (totalBytes <= maxBytes) break;
+        QFile::remove(entryPath(oldest.second));
+        remove(oldest.second);
+    }
+}
@@ -0,0 +1,75 @@
+#ifndef RESULTCACHE_H
+#define RESULTCACHE_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "ensemble.h"
+#include "visitgrid.h"
+
+// Everything a finished headless run leaves behind
+struct CachedRun
+{
+    EnsembleRunResult metrics;
+    VisitGrid coverage;
+    std::vector<uint8_t> trajectory;    // TrajectoryWriter bytes, as Run::saveTrajectory writes them
+};
+
+// On-disk store of finished runs, addressed by everything that decides a
+// run: the plan geometry hash, every robot setting, the algorithm and the
+// seed. A repeated run is read back instead of simulated.
+//
+// Entries live in <directory>/<first two key characters>/<key>.rsrc and are
+// written through a temporary file, so readers never see half an entry.
+// When the entries outgrow the size limit the least recently used ones are
+// deleted; reading an entry counts as a use. One cache object may be shared
+// by worker threads.
+class ResultCache
+{
+public:
+    static const qint64 defaultMaxBytes = 512ll * 1024 * 1024;
+    // Bump when a change to the simulation makes stored results stale
+    static const int formatVersion = 6;
+
+    explicit ResultCache(const QString &directory = defaultDirectory(), qint64 maxBytes = defaultMaxBytes);
+
+    static QString defaultDirectory();
+    static QString makeKey(const QByteArray &planHash, const QString &algorithm, quint64 seed,
+                           const EnsembleSettings &settings);
+
+    bool load(const QString &key, CachedRun &run);
+    bool store(const QString &key, const CachedRun &run);
+
+    QString getDirectory() const { return directory; }
+    qint64 getMaxBytes() const { return maxBytes; }
+    qint64 getSize();
+    int getEntryCount();
+    void clear();
+
+private:
+    struct Entry
+    {
+        qint64 size = 0;
+        qint64 lastUse = 0;     // ms since the epoch, kept as the file's modification time
+    };
+
+    QString entryPath(const QString &key) const;
+    void scan();
+    void remove(const QString &key);
+    void evict();
+
+    QString directory;
+    qint64 maxBytes;
+
+    std::mutex mutex;
+    bool scanned = false;
+    QHash<QString, Entry> entries;
+    qint64 totalBytes = 0;
+};
+
+#endif // RESULTCACHE_H
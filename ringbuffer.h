@@ -0,0 +1,48 @@
+#ifndef RINGBUFFER_H
+#define RINGBUFFER_H
+
+#include <cstddef>
+#include <vector>
+
+// Fixed-capacity FIFO that overwrites its oldest element once full.
+// Storage is allocated once, so pushing never allocates.
+template<typename T>
+class RingBuffer
+{
+public:
+    explicit RingBuffer(size_t capacity = 0) : buffer(capacity) {}
+
+    void push(const T& value)
+    {
+        if (buffer.empty()) return;
+        buffer[(head + count) % buffer.size()] = value;
+        if (count < buffer.size()) {
+            count++;
+        } else {
+            head = (head + 1) % buffer.size();
+        }
+    }
+
+    // Index 0 is the oldest element still held
+    const T& at(size_t i) const { return buffer[(head + i) % buffer.size()]; }
+    const T& front() const { return at(0); }
+    const T& back() const { return at(count - 1); }
+
+    size_t size() const { return count; }
+    size_t capacity() const { return buffer.size(); }
+    bool empty() const { return count == 0; }
+    bool full() const { return count == buffer.size(); }
+
+    void clear()
+    {
+        head = 0;
+        count = 0;
+    }
+
+private:
+    std::vector<T> buffer;
+    size_t head = 0;
+    size_t count = 0;
+};
+
+#endif // RINGBUFFER_H
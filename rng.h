@@ -0,0 +1,58 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <array>
+#include <cstdint>
+
+// Small seedable generator (xoshiro128**) owned by each vacuum. A run is
+// reproducible from its seed, and vacuums stepped on different threads never
+// share generator state. The four state words can be saved and restored.
+class Rng
+{
+public:
+    explicit Rng(uint64_t seed = 0) { setSeed(seed); }
+
+    void setSeed(uint64_t seed)
+    {
+        // splitmix64 spreads consecutive seeds over the whole state
+        for (int i = 0; i < 4; i += 2) {
+            seed += 0x9E3779B97F4A7C15ull;
+            uint64_t z = seed;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            z ^= z >> 31;
+            s[i] = uint32_t(z);
+            s[i + 1] = uint32_t(z >> 32);
+        }
+        if ((s[0] | s[1] | s[2] | s[3]) == 0) s[0] = 1;
+    }
+
+    uint32_t next()
+    {
+        const uint32_t result = rotl(s[1] * 5, 7) * 9;
+        const uint32_t t = s[1] << 9;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 11);
+        return result;
+    }
+
+    // Uniform integer in [0, bound)
+    uint32_t nextInt(uint32_t bound) { return uint32_t((uint64_t(next()) * bound) >> 32); }
+
+    // Uniform real in [0, bound)
+    double nextDouble(double bound) { return next() * (1.0 / 4294967296.0) * bound; }
+
+    std::array<uint32_t, 4> getState() const { return s; }
+    void setState(const std::array<uint32_t, 4> &state) { s = state; }
+
+private:
+    static uint32_t rotl(uint32_t x, int k) { return (x << k) | (x >> (32 - k)); }
+
+    std::array<uint32_t, 4> s;
+};
+
+#endif // RNG_H
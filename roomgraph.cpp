@@ -0,0 +1,200 @@
+#include "roomgraph.h"
+#include "pathplanner.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+const double infinity = std::numeric_limits<double>::infinity();
+
+double distance(const Vector2D& a, const Vector2D& b)
+{
+    return std::hypot(a.x - b.x, a.y - b.y);
+}
+}
+
+RoomGraph::RoomGraph(std::shared_ptr<const CompiledPlan> plan)
+    : roomCount(int(plan->getRooms().size()))
+    , doorCount(int(plan->getDoors().size()))
+    , doorDistances(size_t(doorCount) * doorCount, infinity)
+    , roomDistances(size_t(roomCount) * roomCount, infinity)
+    , roomDoors(roomCount)
+{
+    const std::vector<PlanDoor>& doors = plan->getDoors();
+    for (int d = 0; d < doorCount; d++) {
+        roomDoors[doors[d].firstRoom].push_back(d);
+        if (doors[d].secondRoom != doors[d].firstRoom) roomDoors[doors[d].secondRoom].push_back(d);
+        doorDistances[size_t(d) * doorCount + d] = 0.0;
+    }
+
+    // Legs between the doors of each room, measured along planned paths
+    PathPlanner planner(plan);
+    std::vector<Vector2D> path;
+    for (int room = 0; room < roomCount; room++) {
+        const std::vector<int>& around = roomDoors[room];
+        for (size_t i = 0; i < around.size(); i++) {
+            for (size_t j = i + 1; j < around.size(); j++) {
+                const Vector2D& from = doors[around[i]].centre;
+                if (!planner.findPath(from, doors[around[j]].centre, path)) continue;
+                double length = 0.0;
+                Vector2D at = from;
+                for (const Vector2D& point : path) {
+                    length += distance(at, point);
+                    at = point;
+                }
+                double& ij = doorDistances[size_t(around[i]) * doorCount + around[j]];
+                double& ji = doorDistances[size_t(around[j]) * doorCount + around[i]];
+                ij = ji = std::min(ij, length);
+            }
+        }
+    }
+
+    // Floyd-Warshall
+    for (int k = 0; k < doorCount; k++) {
+        for (int i = 0; i < doorCount; i++) {
+            const double ik = doorDistances[size_t(i) * doorCount + k];
+            if (ik == infinity) continue;
+            for (int j = 0; j < doorCount; j++) {
+                double& ij = doorDistances[size_t(i) * doorCount + j];
+                ij = std::min(ij, ik + doorDistances[size_t(k) * doorCount + j]);
+            }
+        }
+    }
+
+    for (int a = 0; a < roomCount; a++) {
+        roomDistances[size_t(a) * roomCount + a] = 0.0;
+        for (int b = 0; b < roomCount; b++) {
+            double& ab = roomDistances[size_t(a) * roomCount + b];
+            for (int i : roomDoors[a]) {
+                for (int j : roomDoors[b]) ab = std::min(ab, getDoorDistance(i, j));
+            }
+        }
+    }
+}
+
+double RoomGraph::tourLength(int start, const std::vector<int>& order) const
+{
+    double length = 0.0;
+    int at = start;
+    for (int room : order) {
+        length += getRoomDistance(at, room);
+        at = room;
+    }
+    return length;
+}
+
+std::vector<int> RoomGraph::tour(int start, const std::vector<int>& rooms) const
+{
+    if (start < 0 || start >= roomCount) return {};
+    std::vector<int> stops;
+    for (int room : rooms) {
+        if (room < 0 || room >= roomCount || room == start || getRoomDistance(start, room) == infinity) continue;
+        if (std::find(stops.begin(), stops.end(), room) == stops.end()) stops.push_back(room);
+    }
+    if (stops.size() <= 1) return stops;
+    return int(stops.size()) <= exactTourLimit ? exactTour(start, stops) : heuristicTour(start, stops);
+}
+
+// Held-Karp over the open path from start: best[mask][j] is the shortest
+// walk from start through the stops in mask, ending at stop j
+std::vector<int> RoomGraph::exactTour(int start, const std::vector<int>& rooms) const
+{
+    const int n = int(rooms.size());
+    const size_t subsets = size_t(1) << n;
+    std::vector<double> best(subsets * n, infinity);
+    std::vector<int8_t> previous(subsets * n, -1);
+    for (int j = 0; j < n; j++) best[(size_t(1) << j) * n + j] = getRoomDistance(start, rooms[j]);
+
+    for (size_t mask = 1; mask < subsets; mask++) {
+        for (int j = 0; j < n; j++) {
+            const double reach = best[mask * n + j];
+            if (!(mask >> j & 1) || reach == infinity) continue;
+            for (int k = 0; k < n; k++) {
+                if (mask >> k & 1) continue;
+                const size_t next = (mask | (size_t(1) << k)) * n + k;
+                const double length = reach + getRoomDistance(rooms[j], rooms[k]);
+                if (length < best[next]) {
+                    best[next] = length;
+                    previous[next] = int8_t(j);
+                }
+            }
+        }
+    }
+
+    const size_t all = subsets - 1;
+    int last = 0;
+    for (int j = 1; j < n; j++) {
+        if (best[all * n + j] < best[all * n + last]) last = j;
+    }
+    std::vector<int> order;
+    for (size_t mask = all; last >= 0;) {
+        order.push_back(rooms[last]);
+        const int before = previous[mask * n + last];
+        mask &= ~(size_t(1) << last);
+        last = before;
+    }
+    std::reverse(order.begin(), order.end());
+    return order;
+}
+
+std::vector<int> RoomGraph::heuristicTour(int start, const std::vector<int>& rooms) const
+{
+    // Nearest neighbour from each possible first stop, each improved by
+    // 2-opt (reversing a stretch) and Or-opt (moving a stretch of up to
+    // three rooms elsewhere) while either shortens the walk
+    std::vector<int> best;
+    double bestLength = infinity;
+    std::vector<int> order;
+    std::vector<int> trial;
+    for (size_t first = 0; first < rooms.size(); first++) {
+        order.assign(1, rooms[first]);
+        std::vector<char> used(rooms.size(), 0);
+        used[first] = 1;
+        for (size_t step = 1; step < rooms.size(); step++) {
+            size_t next = rooms.size();
+            for (size_t i = 0; i < rooms.size(); i++) {
+                if (!used[i] && (next == rooms.size() ||
+                                 getRoomDistance(order.back(), rooms[i]) < getRoomDistance(order.back(), rooms[next]))) {
+                    next = i;
+                }
+            }
+            used[next] = 1;
+            order.push_back(rooms[next]);
+        }
+
+        const int n = int(order.size());
+        double length = tourLength(start, order);
+        bool improved = true;
+        while (improved) {
+            improved = false;
+            for (int i = 0; i < n - 1 && !improved; i++) {
+                for (int j = i + 1; j < n && !improved; j++) {
+                    trial = order;
+                    std::reverse(trial.begin() + i, trial.begin() + j + 1);
+                    improved = tourLength(start, trial) < length - 1e-9;
+                }
+            }
+            for (int span = 1; span <= 3 && !improved; span++) {
+                for (int i = 0; i + span <= n && !improved; i++) {
+                    for (int k = 0; k + span <= n && !improved; k++) {
+                        if (k == i) continue;
+                        trial = order;
+                        trial.erase(trial.begin() + i, trial.begin() + i + span);
+                        trial.insert(trial.begin() + k, order.begin() + i, order.begin() + i + span);
+                        improved = tourLength(start, trial) < length - 1e-9;
+                    }
+                }
+            }
+            if (improved) {
+                order.swap(trial);
+                length = tourLength(start, order);
+            }
+        }
+        if (length < bestLength) {
+            bestLength = length;
+            best = order;
+        }
+    }
+    return best;
+}
@@ -0,0 +1,53 @@
+#ifndef ROOMGRAPH_H
+#define ROOMGRAPH_H
+
+#include <memory>
+#include <vector>
+
+#include "compiledplan.h"
+
+// The rooms of a compiled plan and the doors between them, with the
+// distances a tour of the rooms needs. Built once per plan and immutable
+// after, so forks and worker threads share one.
+//
+// Doors that open into the same room are joined by the length of the
+// planner's path between their centres; an all-pairs table over those legs
+// (Floyd-Warshall) then gives the shortest walk between any two doors. Two
+// rooms are as far apart as their closest pair of doors, so rooms sharing a
+// door are zero apart.
+class RoomGraph
+{
+public:
+    // Up to this many rooms a tour is solved exactly (Held-Karp); past it,
+    // nearest neighbour improved by 2-opt
+    static const int exactTourLimit = 12;
+
+    explicit RoomGraph(std::shared_ptr<const CompiledPlan> plan);
+
+    int getRoomCount() const { return roomCount; }
+    int getDoorCount() const { return doorCount; }
+    // Infinite when no walk joins them
+    double getDoorDistance(int a, int b) const { return doorDistances[size_t(a) * doorCount + b]; }
+    double getRoomDistance(int a, int b) const { return roomDistances[size_t(a) * roomCount + b]; }
+    // Doors opening into room
+    const std::vector<int>& getRoomDoors(int room) const { return roomDoors[room]; }
+
+    // Order to visit rooms in, starting from start (which is not repeated)
+    // and going through each reachable room of rooms once, with the least
+    // walking between them. Unreachable rooms are left out.
+    std::vector<int> tour(int start, const std::vector<int>& rooms) const;
+    // Walking the tour takes, start included
+    double tourLength(int start, const std::vector<int>& order) const;
+
+private:
+    std::vector<int> exactTour(int start, const std::vector<int>& rooms) const;
+    std::vector<int> heuristicTour(int start, const std::vector<int>& rooms) const;
+
+    int roomCount;
+    int doorCount;
+    std::vector<double> doorDistances;
+    std::vector<double> roomDistances;
+    std::vector<std::vector<int>> roomDoors;
+};
+
+#endif // ROOMGRAPH_H
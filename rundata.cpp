@@ -13,6 +13,54 @@ QString Run::getTimeString(QStringList time){
     return time[0].rightJustified(2, '0') + ":" + time[1].rightJustified(2, '0') + ":" + time[2].rightJustified(2, '0');
 }
 
+// Coverage history is kept next to the heatmap as "time,coverage" lines
+bool Run::saveCoverage(QString path){
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        qDebug() << "Failed to write coverage history" << path;
+        return false;
+    }
+
+    QTextStream stream(&file);
+    stream << "time,coverage" << Qt::endl;
+    for (int i = 0; i < coverage.size(); i++){
+        stream << coverage.at(i).time << "," << coverage.at(i).coverage << Qt::endl;
+    }
+    coveragePath = path;
+    return true;
+}
+
+bool Run::loadCoverage(QString path){
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        qDebug() << "Failed to open coverage history" << path;
+        return false;
+    }
+
+    coverage.clear();
+    QTextStream ts(&file);
+    ts.readLine(); // header
+    while (!ts.atEnd()){
+        QStringList fields = ts.readLine().split(',');
+        if (fields.size() == 2){
+            coverage.append({fields[0].toInt(), fields[1].toDouble()});
+        }
+    }
+    coveragePath = path;
+    return true;
+}
+
+bool Run::saveTrajectory(QString path){
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qDebug() << "Failed to write trajectory" << path;
+        return false;
+    }
+    file.write(trajectory);
+    trajectoryPath = path;
+    return true;
+}
+
 RunData::RunData(){}
 
 void RunData::parseFile(QString file_name){
@@ -23,7 +71,7 @@ void RunData::parseFile(QString file_name){
     }
 
     QStringList filedata[4];
-    QString algdata[4];
+    QString algdata[5];
 
     int n = 0;
     int m =0;
@@ -37,12 +85,13 @@ void RunData::parseFile(QString file_name){
             filedata[n] = data;
             n++;
         }
-        else{
+        else if (m < 5){
             QString line = ts.readLine();
             algdata[m] = line;
             m++;
 
         }
+        else break;
     }
 
     bool ok;
@@ -63,7 +112,7 @@ void RunData::parseFile(QString file_name){
     openSF = filedata[3][0];
 
 
-    for (int i = 0; i < 4; i++){
+    for (int i = 0; i < 5; i++){
         Run run;
         QStringList runString = algdata[i].split(' ');
         if (runString.size() >2){
@@ -72,6 +121,12 @@ void RunData::parseFile(QString file_name){
             run.coverSF = runString[2];
             run.heatmapPath = runString[3];
             qDebug() << run.heatmapPath;
+            if (runString.size() > 4){
+                run.loadCoverage(runString[4]);
+            }
+            if (runString.size() > 5){
+                run.trajectoryPath = runString[5];
+            }
             run.exists = true;
             run.coverPer = QString::number(run.coverSF.toDouble()/openSF.toDouble() * 100, 'g', 4);
         }
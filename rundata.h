@@ -5,6 +5,9 @@
 
 #include <QString>
 #include <QList>
+#include <QByteArray>
+
+#include "coveragehistory.h"
 
 
 class Run
@@ -24,6 +27,15 @@ public:
     QPixmap heatmap;
     QString heatmapPath;
 
+    QByteArray trajectory;
+    QString trajectoryPath;
+    bool saveTrajectory(QString path);
+
+    CoverageHistory coverage;
+    QString coveragePath;
+    bool saveCoverage(QString path);
+    bool loadCoverage(QString path);
+
 };
 
 
@@ -0,0 +1,115 @@
+#include "runstats.h"
+
+#include <algorithm>
+#include <cmath>
+
+QuantileEstimator::QuantileEstimator(double p)
+    : p(p)
+{
+    const double init[5] = {1.0, 1.0 + 2.0 * p, 1.0 + 4.0 * p, 3.0 + 2.0 * p, 5.0};
+    const double inc[5] = {0.0, p / 2.0, p, (1.0 + p) / 2.0, 1.0};
+    for (int i = 0; i < 5; i++) {
+        heights[i] = 0.0;
+        positions[i] = i + 1;
+        desired[i] = init[i];
+        increments[i] = inc[i];
+    }
+}
+
+void QuantileEstimator::add(double x)
+{
+    // The first five samples seed the markers
+    if (count < 5) {
+        heights[count++] = x;
+        if (count == 5) std::sort(heights, heights + 5);
+        return;
+    }
+    count++;
+
+    int k;
+    if (x < heights[0]) {
+        heights[0] = x;
+        k = 0;
+    } else if (x >= heights[4]) {
+        heights[4] = std::max(heights[4], x);
+        k = 3;
+    } else {
+        k = 0;
+        while (k < 3 && x >= heights[k + 1]) k++;
+    }
+
+    for (int i = k + 1; i < 5; i++) positions[i] += 1.0;
+    for (int i = 0; i < 5; i++) desired[i] += increments[i];
+
+    // Nudge the three middle markers towards their desired positions
+    for (int i = 1; i <= 3; i++) {
+        double d = desired[i] - positions[i];
+        if ((d >= 1.0 && positions[i + 1] - positions[i] > 1.0) ||
+            (d <= -1.0 && positions[i - 1] - positions[i] < -1.0)) {
+            int s = d > 0 ? 1 : -1;
+            double parabolic = heights[i] + s / (positions[i + 1] - positions[i - 1]) *
+                ((positions[i] - positions[i - 1] + s) * (heights[i + 1] - heights[i]) / (positions[i + 1] - positions[i]) +
+                 (positions[i + 1] - positions[i] - s) * (heights[i] - heights[i - 1]) / (positions[i] - positions[i - 1]));
+            if (heights[i - 1] < parabolic && parabolic < heights[i + 1]) {
+                heights[i] = parabolic;
+            } else {
+                heights[i] += s * (heights[i + s] - heights[i]) / (positions[i + s] - positions[i]);
+            }
+            positions[i] += s;
+        }
+    }
+}
+
+double QuantileEstimator::getValue() const
+{
+    if (count == 0) return 0.0;
+    if (count >= 5) return heights[2];
+
+    // Too few samples for the markers, take the nearest rank
+    double sorted[5];
+    std::copy(heights, heights + count, sorted);
+    std::sort(sorted, sorted + count);
+    int rank = std::min(count - 1, int(std::round(p * (count - 1))));
+    return sorted[rank];
+}
+
+RunningStats::RunningStats()
+{
+    quantiles = {QuantileEstimator(0.1), QuantileEstimator(0.5), QuantileEstimator(0.9)};
+}
+
+void RunningStats::add(double x)
+{
+    if (count == 0) {
+        minValue = x;
+        maxValue = x;
+    } else {
+        minValue = std::min(minValue, x);
+        maxValue = std::max(maxValue, x);
+    }
+
+    count++;
+    double delta = x - mean;
+    mean += delta / count;
+    m2 += delta * (x - mean);
+
+    for (QuantileEstimator &q : quantiles) q.add(x);
+}
+
+double RunningStats::getVariance() const
+{
+    return count > 1 ? m2 / (count - 1) : 0.0;
+}
+
+double RunningStats::getStdDev() const
+{
+    return std::sqrt(getVariance());
+}
+
+double RunningStats::getQuantile(double p) const
+{
+    for (const QuantileEstimator &q : quantiles) {
+        if (std::abs(q.getProbability() - p) < 1e-9) return q.getValue();
+    }
+    return 0.0;
+}
@@ -0,0 +1,55 @@
+#ifndef RUNSTATS_H
+#define RUNSTATS_H
+
+#include <vector>
+
+// Streaming estimate of one quantile with the P-square algorithm: five
+// markers, constant memory, no stored samples.
+class QuantileEstimator
+{
+public:
+    explicit QuantileEstimator(double p = 0.5);
+
+    void add(double x);
+    double getProbability() const { return p; }
+    double getValue() const;
+
+private:
+    double p;
+    int count = 0;
+    double heights[5];
+    double positions[5];
+    double desired[5];
+    double increments[5];
+};
+
+// Count, mean, variance (Welford), min/max and a fixed set of quantiles of a
+// stream of values. Used to aggregate ensemble runs without keeping them.
+class RunningStats
+{
+public:
+    RunningStats();
+
+    void add(double x);
+
+    int getCount() const { return count; }
+    double getMean() const { return mean; }
+    double getVariance() const;
+    double getStdDev() const;
+    double getMin() const { return minValue; }
+    double getMax() const { return maxValue; }
+
+    // p must be one of the tracked probabilities (0.1, 0.5, 0.9)
+    double getQuantile(double p) const;
+    double getMedian() const { return getQuantile(0.5); }
+
+private:
+    int count = 0;
+    double mean = 0.0;
+    double m2 = 0.0;
+    double minValue = 0.0;
+    double maxValue = 0.0;
+    std::vector<QuantileEstimator> quantiles;
+};
+
+#endif // RUNSTATS_H
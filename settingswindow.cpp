@@ -3,6 +3,8 @@
 
 #include <QCheckBox>
 #include<QMessageBox>
+#include <QFileDialog>
+#include <QFileInfo>
 #include <QDebug>
 
 SettingsWindow::SettingsWindow(QWidget *parent)
@@ -15,6 +17,11 @@ SettingsWindow::SettingsWindow(QWidget *parent)
 
     // Connect START button to handle the final selection
     connect(ui->pushButtonSave, &QPushButton::clicked, this, &SettingsWindow::handleSaveClicked);
+    connect(ui->loadProfileButton, &QPushButton::clicked, this, &SettingsWindow::handleLoadProfileClicked);
+    connect(ui->clearProfileButton, &QPushButton::clicked, this, [this]() {
+        strategyParams = StrategyParams();
+        ui->profileEdit->setText("Defaults");
+    });
 }
 
 SettingsWindow::~SettingsWindow()
@@ -24,7 +31,7 @@ SettingsWindow::~SettingsWindow()
 
 void SettingsWindow::setupAlgorithmList()
 {
-    QStringList algorithms = {"Random", "Snaking", "Wall Follow", "Spiral"};
+    QStringList algorithms = {"Random", "Snaking", "Wall Follow", "Spiral", "Frontier"};
 
     QFont font = ui->selectAlgorithms->font();
     font.setPointSize(20);
@@ -82,6 +89,8 @@ void SettingsWindow::setupLineEdits()
 
     ui->whiskerEfficiencyEdit->setText("30");
     ui->speedEdit->setText("12");
+    ui->profileEdit->setFont(font);
+    if (strategyParams.isDefault()) ui->profileEdit->setText("Defaults");
 
     ui->batteryLifeEdit->setValidator(new QIntValidator(90, 200, this));
     ui->vacuumEfficiencyEdit->setValidator(new QIntValidator(10, 90, this));
@@ -153,10 +162,27 @@ void SettingsWindow::handleSaveClicked()
                         ui->vacuumEfficiencyEdit->text().toInt(),
                         ui->whiskerEfficiencyEdit->text().toInt(),
                         ui->speedEdit->text().toInt(),
-                        selectedAlgorithms);
+                        selectedAlgorithms,
+                        strategyParams);
     this->close();
 }
 
+// Profiles are written by robosim-cli tune
+void SettingsWindow::handleLoadProfileClicked()
+{
+    QString path = QFileDialog::getOpenFileName(this, "Load Strategy Profile", QString(), "Strategy Profiles (*.json)");
+    if (path.isEmpty()) return;
+
+    StrategyProfile profile;
+    QString error;
+    if (!StrategyProfile::load(path, profile, &error)) {
+        QMessageBox::critical(this, "Profile Error", error);
+        return;
+    }
+    strategyParams = profile.params;
+    ui->profileEdit->setText(profile.name.isEmpty() ? QFileInfo(path).completeBaseName() : profile.name);
+}
+
 void SettingsWindow::showEvent(QShowEvent *event)
 {
     QMainWindow::showEvent(event);
@@ -4,6 +4,8 @@
 #include <QMainWindow>
 #include <QListWidgetItem>
 
+#include "strategyparams.h"
+
 QT_BEGIN_NAMESPACE
 namespace Ui {
 class SettingsWindow;
@@ -25,7 +27,8 @@ signals:
                          int vacuumEfficiency,
                          int whiskerEfficiency,
                          int speed,
-                         QStringList pathingAlgorithms);
+                         QStringList pathingAlgorithms,
+                         StrategyParams strategyParams);
 
 protected:
     void showEvent(QShowEvent *event) override;
@@ -35,7 +38,11 @@ private:
     void setupAlgorithmList();
     void setupLineEdits();
     void handleSaveClicked();
+    void handleLoadProfileClicked();
     bool validateInputs();
+
+    // Defaults until a tuned profile is loaded
+    StrategyParams strategyParams;
 };
 
 #endif // SETTINGSWINDOW_H
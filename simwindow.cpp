@@ -2,6 +2,8 @@
 #include "ui_simwindow.h"
 
 #include <QFileDialog>
+#include <QPainter>
+#include <QRandomGenerator>
 
 SimWindow::SimWindow(House* housePtr, QWidget *parent)
     : QMainWindow(parent), house(housePtr)
@@ -34,6 +36,15 @@ SimWindow::SimWindow(House* housePtr, QWidget *parent)
     connect(ui->timesFivePushButton, &QPushButton::clicked, this, &SimWindow::fiveSpeedPushed);
     connect(ui->timesFiftyPushButton, &QPushButton::clicked, this, &SimWindow::fiftySpeedPushed);
 
+    ui->colorMapComboBox->addItems(HeatmapRenderer::colorMapNames());
+    connect(ui->colorMapComboBox, &QComboBox::currentTextChanged, this, &SimWindow::setColorMap);
+
+    ui->coverageChart->setHistory(&coverageHistory);
+    connect(ui->sampleIntervalSpinBox, QOverload<int>::of(&QSpinBox::valueChanged), this, [this](int seconds){
+        coverageHistory.setSampleInterval(seconds);
+    });
+    coverageHistory.setSampleInterval(ui->sampleIntervalSpinBox->value());
+
 
 }
 
@@ -42,12 +53,14 @@ SimWindow::~SimWindow()
     delete ui;
 }
 
-void SimWindow::startSimulation(int batteryLife, int vacuumEfficiency, int whiskerEfficiency, int speed, QStringList selectedAlgorithms)
+void SimWindow::startSimulation(int batteryLife, int vacuumEfficiency, int whiskerEfficiency, int speed, QStringList selectedAlgorithms,
+                                const StrategyParams &strategyParams)
 {
     this->batteryLife = batteryLife;
     this->vacuumEfficiency = vacuumEfficiency;
     this->whiskerEfficiency = whiskerEfficiency;
     this->speed = speed;
+    this->strategyParams = strategyParams;
     pendingAlgorithms = selectedAlgorithms;
 
     vacuum->setHousePath(house_path);
@@ -71,7 +84,7 @@ void SimWindow::startSimulation(int batteryLife, int vacuumEfficiency, int whisk
     QString timeString = time.toString();
     simData->sTime = timeString.split(':');
 
-    for (int i = 0; i < 4; i++){
+    for (int i = 0; i < 5; i++){
         Run run;
         run.exists = false;
         simData->runs.append(run);
@@ -82,7 +95,7 @@ void SimWindow::startSimulation(int batteryLife, int vacuumEfficiency, int whisk
 
 void SimWindow::updateSimulation()
 {
-    if (vacuum->getBatteryLife() <= 0)
+    if (vacuum->isFinished())
     {
         writeRun();
         simulationTimer->stop();
@@ -92,9 +105,47 @@ void SimWindow::updateSimulation()
     }
 
     vacuum->updateMovementandTrail(scene);
+    refreshCoverageLayer();
+    recordCoverage();
+    recordTrajectory();
     updateBatteryLifeLabel();
 }
 
+void SimWindow::recordTrajectory()
+{
+    if (!recordingTrajectory) return;
+
+    std::vector<uint8_t> state;
+    if (trajectoryWriter.nextIsKeyframe()) {
+        state = vacuum->saveStrategyState();
+    }
+    const Vector2D &pos = vacuum->getPosition();
+    trajectoryWriter.append(pos.x, pos.y, vacuum->getStepEvents(), state);
+}
+
+void SimWindow::recordCoverage()
+{
+    int elapsed = batteryLife*60 - vacuum->getBatteryLife();
+    coverageHistory.record(elapsed, vacuum->getCoveredArea());
+    ui->coverageChart->update();
+}
+
+void SimWindow::refreshCoverageLayer()
+{
+    if (!coverageLayer) return;
+
+    const VisitGrid &grid = vacuum->getVisitGrid();
+    coverageLayer->setPixmap(QPixmap::fromImage(heatmapRenderer.render(grid)));
+    coverageLayer->setPos(grid.getOriginX(), grid.getOriginY());
+    coverageLayer->setScale(grid.getCellSize());
+}
+
+void SimWindow::setColorMap(const QString &name)
+{
+    heatmapRenderer.setColorMap(HeatmapRenderer::colorMapFromName(name));
+    refreshCoverageLayer();
+}
+
 void SimWindow::updateBatteryLifeLabel()
 {
     int batteryLife = vacuum->getBatteryLife();
@@ -146,9 +197,17 @@ QString SimWindow::writeReport(){
         qDebug() << simData->runs[0].exists;
         if (simData->runs[0].exists){
             simData->runs[0].heatmapPath = save_path + "/" + simData->id + "_" + QString::number(simData->report_id) + "-" + simData->runs[0].alg + ".png";
-            stream << "random " << simData->runs[0].getTimeString(simData->runs[0].time) << " " << simData->runs[0].coverSF  << " " << simData->runs[0].heatmapPath << Qt::endl;
+            simData->runs[0].coveragePath = save_path + "/" + simData->id + "_" + QString::number(simData->report_id) + "-" + simData->runs[0].alg + ".csv";
+            if (!simData->runs[0].trajectory.isEmpty()){
+                simData->runs[0].trajectoryPath = save_path + "/" + simData->id + "_" + QString::number(simData->report_id) + "-" + simData->runs[0].alg + ".rstj";
+            }
+            stream << "random " << simData->runs[0].getTimeString(simData->runs[0].time) << " " << simData->runs[0].coverSF  << " " << simData->runs[0].heatmapPath << " " << simData->runs[0].coveragePath << " " << simData->runs[0].trajectoryPath << Qt::endl;
             //QFile saveMap(simData->runs[0].heatmapPath);
             simData->runs[0].heatmap.save(simData->runs[0].heatmapPath,"PNG");
+            simData->runs[0].saveCoverage(simData->runs[0].coveragePath);
+            if (!simData->runs[0].trajectory.isEmpty()){
+                simData->runs[0].saveTrajectory(simData->runs[0].trajectoryPath);
+            }
         }
         else{
             stream << "random 0" << Qt::endl;
@@ -156,27 +215,67 @@ QString SimWindow::writeReport(){
         }
         if (simData->runs[1].exists){
             simData->runs[1].heatmapPath = save_path + "/" + simData->id + "_" + QString::number(simData->report_id) + "-" + simData->runs[1].alg+ ".png";
-            stream << "spiral " << simData->runs[1].getTimeString(simData->runs[1].time) << " " << simData->runs[1].coverSF  << " " << simData->runs[1].heatmapPath << Qt::endl;
+            simData->runs[1].coveragePath = save_path + "/" + simData->id + "_" + QString::number(simData->report_id) + "-" + simData->runs[1].alg + ".csv";
+            if (!simData->runs[1].trajectory.isEmpty()){
+                simData->runs[1].trajectoryPath = save_path + "/" + simData->id + "_" + QString::number(simData->report_id) + "-" + simData->runs[1].alg + ".rstj";
+            }
+            stream << "spiral " << simData->runs[1].getTimeString(simData->runs[1].time) << " " << simData->runs[1].coverSF  << " " << simData->runs[1].heatmapPath << " " << simData->runs[1].coveragePath << " " << simData->runs[1].trajectoryPath << Qt::endl;
             simData->runs[1].heatmap.save(simData->runs[1].heatmapPath,"PNG");
+            simData->runs[1].saveCoverage(simData->runs[1].coveragePath);
+            if (!simData->runs[1].trajectory.isEmpty()){
+                simData->runs[1].saveTrajectory(simData->runs[1].trajectoryPath);
+            }
         }
         else{
             stream << "spiral 0" << Qt::endl;
         }
         if (simData->runs[2].exists){
             simData->runs[2].heatmapPath = save_path + "/" + simData->id + "_" + QString::number(simData->report_id) + "-" + simData->runs[2].alg+ ".png";
-            stream << "snaking " << simData->runs[2].getTimeString(simData->runs[2].time) << " " << simData->runs[2].coverSF  << " " << simData->runs[2].heatmapPath << Qt::endl;
+            simData->runs[2].coveragePath = save_path + "/" + simData->id + "_" + QString::number(simData->report_id) + "-" + simData->runs[2].alg + ".csv";
+            if (!simData->runs[2].trajectory.isEmpty()){
+                simData->runs[2].trajectoryPath = save_path + "/" + simData->id + "_" + QString::number(simData->report_id) + "-" + simData->runs[2].alg + ".rstj";
+            }
+            stream << "snaking " << simData->runs[2].getTimeString(simData->runs[2].time) << " " << simData->runs[2].coverSF  << " " << simData->runs[2].heatmapPath << " " << simData->runs[2].coveragePath << " " << simData->runs[2].trajectoryPath << Qt::endl;
             simData->runs[2].heatmap.save(simData->runs[2].heatmapPath,"PNG");
+            simData->runs[2].saveCoverage(simData->runs[2].coveragePath);
+            if (!simData->runs[2].trajectory.isEmpty()){
+                simData->runs[2].saveTrajectory(simData->runs[2].trajectoryPath);
+            }
         }
         else{
             stream << "snaking 0" << Qt::endl;
         }
         if (simData->runs[3].exists){
             simData->runs[3].heatmapPath = save_path + "/" + simData->id + "_" + QString::number(simData->report_id) + "-" + simData->runs[3].alg+ ".png";
-            stream << "wallfollow " << simData->runs[3].getTimeString(simData->runs[3].time) << " " << simData->runs[3].coverSF  << " " << simData->runs[3].heatmapPath << Qt::endl;
+            simData->runs[3].coveragePath = save_path + "/" + simData->id + "_" + QString::number(simData->report_id) + "-" + simData->runs[3].alg + ".csv";
+            if (!simData->runs[3].trajectory.isEmpty()){
+                simData->runs[3].trajectoryPath = save_path + "/" + simData->id + "_" + QString::number(simData->report_id) + "-" + simData->runs[3].alg + ".rstj";
+            }
+            stream << "wallfollow " << simData->runs[3].getTimeString(simData->runs[3].time) << " " << simData->runs[3].coverSF  << " " << simData->runs[3].heatmapPath << " " << simData->runs[3].coveragePath << " " << simData->runs[3].trajectoryPath << Qt::endl;
             simData->runs[3].heatmap.save(simData->runs[3].heatmapPath,"PNG");
+            simData->runs[3].saveCoverage(simData->runs[3].coveragePath);
+            if (!simData->runs[3].trajectory.isEmpty()){
+                simData->runs[3].saveTrajectory(simData->runs[3].trajectoryPath);
+            }
         }
         else{
-            stream << "wallfollow 0";
+            stream << "wallfollow 0" << Qt::endl;
+        }
+        if (simData->runs[4].exists){
+            simData->runs[4].heatmapPath = save_path + "/" + simData->id + "_" + QString::number(simData->report_id) + "-" + simData->runs[4].alg+ ".png";
+            simData->runs[4].coveragePath = save_path + "/" + simData->id + "_" + QString::number(simData->report_id) + "-" + simData->runs[4].alg + ".csv";
+            if (!simData->runs[4].trajectory.isEmpty()){
+                simData->runs[4].trajectoryPath = save_path + "/" + simData->id + "_" + QString::number(simData->report_id) + "-" + simData->runs[4].alg + ".rstj";
+            }
+            stream << "frontier " << simData->runs[4].getTimeString(simData->runs[4].time) << " " << simData->runs[4].coverSF  << " " << simData->runs[4].heatmapPath << " " << simData->runs[4].coveragePath << " " << simData->runs[4].trajectoryPath << Qt::endl;
+            simData->runs[4].heatmap.save(simData->runs[4].heatmapPath,"PNG");
+            simData->runs[4].saveCoverage(simData->runs[4].coveragePath);
+            if (!simData->runs[4].trajectory.isEmpty()){
+                simData->runs[4].saveTrajectory(simData->runs[4].trajectoryPath);
+            }
+        }
+        else{
+            stream << "frontier 0";
         }
 
     }
@@ -198,6 +297,9 @@ void SimWindow::writeRun(){
     if (pendingAlgorithms[currentAlgorithmIndex] == "Wall Follow"){
         run.alg = "wallfollow";
     }
+    if (pendingAlgorithms[currentAlgorithmIndex] == "Frontier"){
+        run.alg = "frontier";
+    }
     run.exists = true;
     int batRuntime = batteryLife*60 - vacuum->getBatteryLife();
     int m = batRuntime/60;
@@ -205,8 +307,19 @@ void SimWindow::writeRun(){
     run.time.append(QString::number(m % 60));
     run.time.append(QString::number(batRuntime % 60));
     run.coverSF = QString::number(vacuum->getCoveredArea());
+    run.coverage = coverageHistory;
+    if (recordingTrajectory && !trajectoryWriter.isEmpty()) {
+        std::vector<uint8_t> bytes = trajectoryWriter.finish();
+        run.trajectory = QByteArray(reinterpret_cast<const char*>(bytes.data()), int(bytes.size()));
+    }
 
     QPixmap heatmap = ui->graphicsView->grab();
+    {
+        // Colour scale for the visit counts in the bottom-right corner
+        QPainter painter(&heatmap);
+        QRectF legendRect(heatmap.width() - 90, heatmap.height() - 170, 70, 150);
+        heatmapRenderer.drawLegend(&painter, legendRect, vacuum->getVisitGrid().getMaxCount());
+    }
     if (pendingAlgorithms[currentAlgorithmIndex] == "Random"){
         simData->runs[0] = run;
         simData->runs[0].heatmap = heatmap;
@@ -223,6 +336,10 @@ void SimWindow::writeRun(){
         simData->runs[3] = run;
         simData->runs[3].heatmap = heatmap;
     }
+    if (pendingAlgorithms[currentAlgorithmIndex] == "Frontier"){
+        simData->runs[4] = run;
+        simData->runs[4].heatmap = heatmap;
+    }
 }
 
 void SimWindow::stopSimulation(){
@@ -280,17 +397,42 @@ void SimWindow::startNextRun()
 void SimWindow::resetScene()
 {
     scene->clear(); // Clears all items from the scene
+    coverageLayer = nullptr;
     house->setScene(scene); // Sets the simulation window scene as the current scene
-    house->loadPlan(house_path); // Redraws the house layout
+    house->loadNonInteractivePlan(house_path); // Redraws the house layout as a single cached layer
 
     // Ensure vacuum exists and is properly reset
     if (vacuum != nullptr)
     {
         vacuum->reset(); // Reset the vacuum (position, battery, etc.)
+        vacuum->setSeed(QRandomGenerator::global()->generate64());
         vacuum->setBatteryLife(batteryLife);
         vacuum->setVacuumEfficiency(vacuumEfficiency);
         vacuum->setWhiskerEfficiency(whiskerEfficiency);
         vacuum->setSpeed(speed);
+        vacuum->setStrategyParams(strategyParams);
+
+        // Visit-density heatmap drawn between the plan and the vacuum
+        coverageLayer = scene->addPixmap(QPixmap());
+        coverageLayer->setZValue(1);
+        coverageLayer->setOpacity(0.85);
+        refreshCoverageLayer();
+
+        coverageHistory.clear();
+        recordCoverage();
+
+        // The plan is embedded so the replay does not depend on the floorplan file
+        recordingTrajectory = ui->recordReplayCheckBox->isChecked();
+        if (recordingTrajectory) {
+            QFile planFile(house_path);
+            QByteArray planJson;
+            if (planFile.open(QIODevice::ReadOnly)) {
+                planJson = QJsonDocument::fromJson(planFile.readAll()).toJson(QJsonDocument::Compact);
+            }
+            QString alg = currentAlgorithmIndex < pendingAlgorithms.size() ? pendingAlgorithms[currentAlgorithmIndex] : QString();
+            trajectoryWriter.begin(planJson.toStdString(), alg.toStdString());
+            recordTrajectory();
+        }
 
         if (currentAlgorithmIndex < pendingAlgorithms.size()) {
             vacuum->setPathingAlgorithm(pendingAlgorithms[currentAlgorithmIndex]);
@@ -309,6 +451,9 @@ void SimWindow::resetScene()
         if (vacuum->getPathingAlgorithm() == "Wall Follow"){
             ui->algLabel->setText("Wall Follow");
         }
+        if (vacuum->getPathingAlgorithm() == "Frontier"){
+            ui->algLabel->setText("Frontier");
+        }
     }
     else
     {
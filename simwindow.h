@@ -8,6 +8,11 @@
 #include "house.h"
 #include "rundata.h"
 #include "reportwindow.h"
+#include "heatmap.h"
+#include "coveragehistory.h"
+#include "trajectory.h"
+
+#include <QGraphicsPixmapItem>
 
 
 namespace Ui {
@@ -22,7 +27,8 @@ public:
     explicit SimWindow(House* housePtr, QWidget *parent = nullptr);
     ~SimWindow();
 
-    void startSimulation(int batteryLife, int vacuumEfficiency, int whiskerEfficiency, int speed, QStringList selectedAlgorithms);
+    void startSimulation(int batteryLife, int vacuumEfficiency, int whiskerEfficiency, int speed, QStringList selectedAlgorithms,
+                         const StrategyParams &strategyParams = StrategyParams());
     void stopSimulation();
 
     House* house;
@@ -40,6 +46,7 @@ private slots:
     void on_stopButton_clicked();
     void startNextRun();
     void resetScene();
+    void setColorMap(const QString &name);
 
 private:
     Ui::SimWindow *ui;
@@ -57,12 +64,24 @@ private:
     int vacuumEfficiency;
     int whiskerEfficiency;
     int speed;
+    StrategyParams strategyParams;
     QStringList pendingAlgorithms;
     int currentAlgorithmIndex = 0;
     bool allRunsCompleted = false;
 
     bool saveHeatmapImage(QString &outImageFilename);
 
+    HeatmapRenderer heatmapRenderer;
+    QGraphicsPixmapItem *coverageLayer = nullptr;
+    void refreshCoverageLayer();
+
+    CoverageHistory coverageHistory;
+    void recordCoverage();
+
+    TrajectoryWriter trajectoryWriter;
+    bool recordingTrajectory = false;
+    void recordTrajectory();
+
 
     ReportWindow *repWin;
 };
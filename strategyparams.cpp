@@ -0,0 +1,219 @@
+#include "strategyparams.h"
+#include "bytestream.h"
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSaveFile>
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+struct Field
+{
+    const char *group;          // JSON object the field lives in
+    const char *key;
+    const char *algorithm;      // the strategy that reads it
+    double min;
+    double max;
+    bool integer;
+    std::function<double(const StrategyParams &)> get;
+    std::function<void(StrategyParams &, double)> set;
+    bool tunable = true;        // false keeps the field out of the tuner's search
+};
+
+// The one list of fields: tuning, JSON, cache keys and checkpoints all go
+// through it, in this order
+const std::vector<Field> &fields()
+{
+    static const std::vector<Field> list = {
+        // Wall Follow traces the distance field whenever a plan is compiled;
+        // these two only steer the rotation search it falls back on, so
+        // tuning them would barely move the score
+        {"wall_follow", "rotate_step", "Wall Follow", 0.05, 1.5707963267948966, false,
+         [](const StrategyParams &p) { return p.wallFollow.rotateStep; },
+         [](StrategyParams &p, double v) { p.wallFollow.rotateStep = v; }, false},
+        {"wall_follow", "random_chance_on_block", "Wall Follow", 0, 100, true,
+         [](const StrategyParams &p) { return double(p.wallFollow.randomChanceOnBlock); },
+         [](StrategyParams &p, double v) { p.wallFollow.randomChanceOnBlock = int(v); }, false},
+        {"wall_follow", "trace_level", "Wall Follow", 1.0, 8.0, false,
+         [](const StrategyParams &p) { return p.wallFollow.traceLevel; },
+         [](StrategyParams &p, double v) { p.wallFollow.traceLevel = v; }},
+        {"spiral", "angle_increment", "Spiral", 0.01, 0.5, false,
+         [](const StrategyParams &p) { return p.spiral.angleIncrement; },
+         [](StrategyParams &p, double v) { p.spiral.angleIncrement = v; }},
+        {"spiral", "radius_growth_rate", "Spiral", 0.005, 0.3, false,
+         [](const StrategyParams &p) { return p.spiral.radiusGrowthRate; },
+         [](StrategyParams &p, double v) { p.spiral.radiusGrowthRate = v; }},
+        {"spiral", "max_spiral_radius", "Spiral", 10.0, 200.0, false,
+         [](const StrategyParams &p) { return p.spiral.maxSpiralRadius; },
+         [](StrategyParams &p, double v) { p.spiral.maxSpiralRadius = v; }},
+        {"spiral", "random_trigger_chance", "Spiral", 0, 100, true,
+         [](const StrategyParams &p) { return double(p.spiral.randomTriggerChance); },
+         [](StrategyParams &p, double v) { p.spiral.randomTriggerChance = int(v); }},
+        {"spiral", "spot_cleaning", "Spiral", 0, 1, true,
+         [](const StrategyParams &p) { return double(p.spiral.spotCleaning); },
+         [](StrategyParams &p, double v) { p.spiral.spotCleaning = v != 0.0; }, false},
+        {"snaking", "near_wall_random_chance", "Snaking", 0, 100, true,
+         [](const StrategyParams &p) { return double(p.snaking.nearWallRandomChance); },
+         [](StrategyParams &p, double v) { p.snaking.nearWallRandomChance = int(v); }},
+        {"snaking", "near_wall_distance", "Snaking", 0.0, 40.0, false,
+         [](const StrategyParams &p) { return p.snaking.nearWallDistance; },
+         [](StrategyParams &p, double v) { p.snaking.nearWallDistance = v; }},
+    };
+    return list;
+}
+
+bool matches(const Field &field, const QString &algorithm)
+{
+    return field.tunable && algorithm.compare(field.algorithm, Qt::CaseInsensitive) == 0;
+}
+}
+
+bool StrategyParams::operator==(const StrategyParams &other) const
+{
+    for (const Field &field : fields()) {
+        if (field.get(*this) != field.get(other)) return false;
+    }
+    return true;
+}
+
+std::vector<TunableParameter> StrategyParams::tunables(const QString &algorithm)
+{
+    std::vector<TunableParameter> list;
+    for (const Field &field : fields()) {
+        if (matches(field, algorithm)) {
+            list.push_back({QString(field.group) + "." + field.key, field.min, field.max, field.integer});
+        }
+    }
+    return list;
+}
+
+std::vector<double> StrategyParams::getValues(const QString &algorithm) const
+{
+    std::vector<double> values;
+    for (const Field &field : fields()) {
+        if (matches(field, algorithm)) values.push_back(field.get(*this));
+    }
+    return values;
+}
+
+void StrategyParams::setValues(const QString &algorithm, const std::vector<double> &values)
+{
+    size_t i = 0;
+    for (const Field &field : fields()) {
+        if (!matches(field, algorithm) || i >= values.size()) continue;
+        double value = std::clamp(values[i++], field.min, field.max);
+        if (field.integer) value = std::round(value);
+        field.set(*this, value);
+    }
+}
+
+QStringList StrategyParams::describe() const
+{
+    QStringList parts;
+    for (const Field &field : fields()) {
+        parts << QString(field.group) + "." + field.key + "=" + QString::number(field.get(*this), 'g', 17);
+    }
+    return parts;
+}
+
+QJsonObject StrategyParams::toJson() const
+{
+    QJsonObject json;
+    for (const Field &field : fields()) {
+        QJsonObject group = json[field.group].toObject();
+        group[field.key] = field.get(*this);
+        json[field.group] = group;
+    }
+    return json;
+}
+
+bool StrategyParams::fromJson(const QJsonObject &json, StrategyParams &params, QString *error)
+{
+    StrategyParams loaded;
+    for (const Field &field : fields()) {
+        const QJsonValue value = json[field.group].toObject()[field.key];
+        if (value.isUndefined()) continue;
+        const double number = value.toDouble(std::nan(""));
+        if (!(number >= field.min && number <= field.max) || (field.integer && number != std::round(number))) {
+            if (error) {
+                *error = QString("%1.%2 must be %3 between %4 and %5")
+                             .arg(field.group, field.key, field.integer ? "a whole number" : "a number")
+                             .arg(field.min).arg(field.max);
+            }
+            return false;
+        }
+        field.set(loaded, number);
+    }
+    params = loaded;
+    return true;
+}
+
+void StrategyParams::save(ByteWriter &out) const
+{
+    for (const Field &field : fields()) out.putDouble(field.get(*this));
+}
+
+bool StrategyParams::load(ByteReader &in)
+{
+    StrategyParams loaded;
+    for (const Field &field : fields()) {
+        const double value = in.getDouble();
+        if (!(value >= field.min && value <= field.max)) return false;
+        field.set(loaded, value);
+    }
+    if (!in.ok()) return false;
+    *this = loaded;
+    return true;
+}
+
+bool StrategyProfile::save(const QString &path, QString *error) const
+{
+    QJsonObject json;
+    json["name"] = name;
+    json["algorithm"] = algorithm;
+    json["plans"] = QJsonArray::fromStringList(plans);
+    json["score"] = score;
+    json["baseline_score"] = baselineScore;
+    json["params"] = params.toJson();
+
+    QSaveFile file(path);
+    const QByteArray bytes = QJsonDocument(json).toJson();
+    if (!file.open(QIODevice::WriteOnly) || file.write(bytes) != bytes.size() || !file.commit()) {
+        if (error) *error = "Cannot write " + path;
+        return false;
+    }
+    return true;
+}
+
+bool StrategyProfile::load(const QString &path, StrategyProfile &profile, QString *error)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (error) *error = "Cannot open " + path;
+        return false;
+    }
+    QJsonParseError parseError;
+    const QJsonDocument document = QJsonDocument::fromJson(file.readAll(), &parseError);
+    if (!document.isObject()) {
+        if (error) *error = path + ": " + parseError.errorString();
+        return false;
+    }
+
+    const QJsonObject json = document.object();
+    StrategyProfile loaded;
+    QString paramsError;
+    if (!StrategyParams::fromJson(json["params"].toObject(), loaded.params, &paramsError)) {
+        if (error) *error = path + ": " + paramsError;
+        return false;
+    }
+    loaded.name = json["name"].toString();
+    loaded.algorithm = json["algorithm"].toString();
+    for (const QJsonValue &plan : json["plans"].toArray()) loaded.plans << plan.toString();
+    loaded.score = json["score"].toDouble();
+    loaded.baselineScore = json["baseline_score"].toDouble();
+    profile = loaded;
+    return true;
+}
@@ -0,0 +1,102 @@
+#ifndef STRATEGYPARAMS_H
+#define STRATEGYPARAMS_H
+
+#include <QJsonObject>
+#include <QString>
+#include <QStringList>
+
+#include <functional>
+#include <vector>
+
+class ByteWriter;
+class ByteReader;
+
+// Constants of the heuristic strategies. The defaults are the values the
+// strategies always had, so a vacuum left with them runs exactly as before.
+
+struct WallFollowParams
+{
+    double rotateStep = 0.2617993877991494;     // pi / 12: turn tried per step when blocked
+    int randomChanceOnBlock = 15;               // % chance of a random step when every turn is blocked
+    double traceLevel = 2.0;                    // distance kept from the walls, in plan grid squares
+};
+
+struct SpiralParams
+{
+    double angleIncrement = 0.07;               // radians per tick
+    double radiusGrowthRate = 0.03;             // per tick
+    double maxSpiralRadius = 60.0;              // the spiral starts over past this radius
+    int randomTriggerChance = 20;               // % chance of a random spell when close to a wall
+    bool spotCleaning = false;                  // spiral out over the worst under-cleaned pocket instead
+};
+
+struct SnakingParams
+{
+    int nearWallRandomChance = 10;              // % chance of a random step near the room bounds
+    double nearWallDistance = 10.0;             // what counts as near
+};
+
+// One parameter as the tuner sees it
+struct TunableParameter
+{
+    QString name;                               // "<strategy>.<field>", as in profile files
+    double min;
+    double max;
+    bool integer;
+};
+
+struct StrategyParams
+{
+    WallFollowParams wallFollow;
+    SpiralParams spiral;
+    SnakingParams snaking;
+
+    bool operator==(const StrategyParams &other) const;
+    bool operator!=(const StrategyParams &other) const { return !(*this == other); }
+    bool isDefault() const { return *this == StrategyParams(); }
+
+    // The parameters of algorithm that can be tuned, within sane bounds;
+    // empty for the planned strategies, which have nothing to tune
+    static std::vector<TunableParameter> tunables(const QString &algorithm);
+    std::vector<double> getValues(const QString &algorithm) const;
+    // Clamped to the bounds, integers rounded
+    void setValues(const QString &algorithm, const std::vector<double> &values);
+
+    // Every field, each with its full precision; used in result cache keys
+    QStringList describe() const;
+
+    QJsonObject toJson() const;
+    // Missing fields keep their defaults; out-of-range ones are rejected
+    static bool fromJson(const QJsonObject &json, StrategyParams &params, QString *error = nullptr);
+
+    void save(ByteWriter &out) const;
+    bool load(ByteReader &in);
+};
+
+// A tuned set of parameters on disk, with a note of what it was tuned for:
+//
+// {
+//     "name": "spiral-small-homes",
+//     "algorithm": "Spiral",
+//     "plans": ["default_plan.json"],
+//     "score": 0.91,
+//     "baseline_score": 0.84,
+//     "params": { "spiral": { "angle_increment": 0.081, ... }, ... }
+// }
+//
+// score and baseline_score are coverage per battery minute (sq. ft) of the
+// profile and of the tuner's starting parameters on its validation seeds.
+struct StrategyProfile
+{
+    QString name;
+    QString algorithm;
+    QStringList plans;
+    double score = 0.0;
+    double baselineScore = 0.0;
+    StrategyParams params;
+
+    bool save(const QString &path, QString *error = nullptr) const;
+    static bool load(const QString &path, StrategyProfile &profile, QString *error = nullptr);
+};
+
+#endif // STRATEGYPARAMS_H
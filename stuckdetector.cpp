@@ -0,0 +1,100 @@
+#include "stuckdetector.h"
+#include "bytestream.h"
+
+#include <cmath>
+#include <cstddef>
+
+const char *stuckActionName(StuckAction action)
+{
+    switch (action) {
+    case StuckAction::Recover: return "recover";
+    case StuckAction::Abort: return "abort";
+    case StuckAction::Report: break;
+    }
+    return "report";
+}
+
+bool stuckActionFromName(const std::string &name, StuckAction &action)
+{
+    for (StuckAction candidate : {StuckAction::Report, StuckAction::Recover, StuckAction::Abort}) {
+        if (name == stuckActionName(candidate)) {
+            action = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+StuckDetector::StuckDetector(int window, double minSpread)
+    : window(window > 1 ? window : 2)
+    , minSpread(minSpread)
+{
+    reset();
+}
+
+void StuckDetector::reset()
+{
+    xs.assign(std::size_t(window), 0.0);
+    ys.assign(std::size_t(window), 0.0);
+    count = 0;
+}
+
+StuckState StuckDetector::add(double x, double y)
+{
+    xs[std::size_t(count % window)] = x;
+    ys[std::size_t(count % window)] = y;
+    count++;
+    if (count < window) return StuckState::Moving;
+
+    // The window is a few dozen ticks, so a fresh pass is cheaper than
+    // keeping running sums exact
+    double meanX = 0.0, meanY = 0.0;
+    for (int i = 0; i < window; i++) {
+        meanX += xs[std::size_t(i)];
+        meanY += ys[std::size_t(i)];
+    }
+    meanX /= window;
+    meanY /= window;
+
+    double variance = 0.0;
+    for (int i = 0; i < window; i++) {
+        double dx = xs[std::size_t(i)] - meanX;
+        double dy = ys[std::size_t(i)] - meanY;
+        variance += dx * dx + dy * dy;
+    }
+    variance /= window;
+    if (variance >= minSpread * minSpread) return StuckState::Moving;
+
+    // Walk the ring oldest to newest
+    double path = 0.0;
+    for (int i = 1; i < window; i++) {
+        std::size_t a = std::size_t((count + i - 1) % window);
+        std::size_t b = std::size_t((count + i) % window);
+        path += std::hypot(xs[b] - xs[a], ys[b] - ys[a]);
+    }
+    return path < minSpread ? StuckState::Stuck : StuckState::Oscillating;
+}
+
+void StuckDetector::save(ByteWriter& out) const
+{
+    out.putVarint(uint64_t(count));
+    int stored = count < window ? count : window;
+    for (int i = 0; i < stored; i++) {
+        out.putDouble(xs[std::size_t(i)]);
+        out.putDouble(ys[std::size_t(i)]);
+    }
+}
+
+bool StuckDetector::load(ByteReader& in)
+{
+    uint64_t n = in.getVarint();
+    if (!in.ok() || n > uint64_t(INT32_MAX)) return false;
+    reset();
+    count = int(n);
+    int stored = count < window ? count : window;
+    for (int i = 0; i < stored; i++) {
+        xs[std::size_t(i)] = in.getDouble();
+        ys[std::size_t(i)] = in.getDouble();
+    }
+    return in.ok();
+}
@@ -0,0 +1,66 @@
+#ifndef STUCKDETECTOR_H
+#define STUCKDETECTOR_H
+
+#include <string>
+#include <vector>
+
+class ByteWriter;
+class ByteReader;
+
+enum class StuckState
+{
+    Moving,
+    Stuck,          // barely moved over the window
+    Oscillating     // moved, but back and forth around one spot
+};
+
+// What a vacuum does when its detector fires
+enum class StuckAction
+{
+    Report,         // only count it
+    Recover,        // new random heading and a short random walk
+    Abort           // end the run
+};
+
+// "report", "recover" or "abort", as spec files and the CLI spell them
+const char *stuckActionName(StuckAction action);
+bool stuckActionFromName(const std::string &name, StuckAction &action);
+
+// Counts of what the detector saw during one run
+struct StuckTelemetry
+{
+    int stuckEvents = 0;
+    int oscillationEvents = 0;
+    int stuckTicks = 0;         // ticks spent flagged, either kind
+    int recoveries = 0;
+    bool aborted = false;
+};
+
+// Ring buffer of the last `window` positions. Once full, a tick is flagged
+// when the positions' RMS distance from their centroid falls below
+// minSpread; it is Stuck if the path walked over the window is shorter than
+// minSpread as well, otherwise Oscillating.
+class StuckDetector
+{
+public:
+    explicit StuckDetector(int window = 20, double minSpread = 3.0);
+
+    void reset();
+    StuckState add(double x, double y);
+
+    int getWindow() const { return window; }
+    double getMinSpread() const { return minSpread; }
+
+    // The buffered positions; the window and spread are configuration
+    void save(ByteWriter& out) const;
+    bool load(ByteReader& in);
+
+private:
+    int window;
+    double minSpread;
+    std::vector<double> xs;
+    std::vector<double> ys;
+    int count = 0;      // positions added since reset
+};
+
+#endif // STUCKDETECTOR_H
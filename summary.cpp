@@ -20,7 +20,7 @@ int summary::getNumRuns(){
     int num=0;
 
     for (int i = 0; i < reports.size(); i++){
-        for (int j = 0; j < 4; j++){
+        for (int j = 0; j < reports[i].runs.size(); j++){
             if (reports[i].runs[j].exists){
                 num++;
             }
@@ -33,7 +33,7 @@ QList<int> summary::getShortestRun(){
     int m = 0;
     int n = 0;
     for (int i = 0; i < reports.size(); i++){
-        for (int j = 0; j<4; j++){
+        for (int j = 0; j < reports[i].runs.size(); j++){
             if (reports[i].runs[j].exists){
                 if (reports[i].runs[j].time[0] < reports[m].runs[n].time[0]){
                     m = i;
@@ -63,7 +63,7 @@ QList<int> summary::getLongestRun(){
     int m = 0;
     int n = 0;
     for (int i = 0; i < reports.size(); i++){
-        for (int j = 0; j<4; j++){
+        for (int j = 0; j < reports[i].runs.size(); j++){
             if (reports[i].runs[j].exists){
                 if (reports[i].runs[j].time[0] > reports[m].runs[n].time[0]){
                     m = i;
@@ -93,7 +93,7 @@ QList<int> summary::getMostCovRun(){
     int n = 0;
 
     for (int i = 1; i < reports.size(); i++){
-        for (int j = 1; j<4; j++){
+        for (int j = 1; j < reports[i].runs.size(); j++){
             if (reports[i].runs[j].exists){
                 if (reports[i].runs[j].coverSF > reports[m].runs[n].coverSF){
                     m = i;
@@ -112,7 +112,7 @@ QList<int> summary::getLeastCovRun(){
     int n = 0;
 
     for (int i = 1; i < reports.size(); i++){
-        for (int j = 1; j<4; j++){
+        for (int j = 1; j < reports[i].runs.size(); j++){
             if (reports[i].runs[j].exists){
                 if (reports[i].runs[j].coverSF < reports[m].runs[n].coverSF){
                     m = i;
@@ -24,7 +24,7 @@ int SummaryWindow::getNumRuns(){
     int num=0;
 
     for (int i = 0; i < data.size(); i++){
-        for (int j = 0; j < 4; j++){
+        for (int j = 0; j < data[i].runs.size(); j++){
             if (data[i].runs[j].exists){
                 num++;
             }
@@ -37,7 +37,7 @@ QList<int> SummaryWindow::getShortestRun(){
     int m = 0;
     int n = 0;
     for (int i = 0; i < data.size(); i++){
-        for (int j = 1; j<4; j++){
+        for (int j = 1; j < data[i].runs.size(); j++){
             if (data[i].runs[j].exists){
                 if (data[i].runs[j].time[0] < data[m].runs[n].time[0]){
                     m = i;
@@ -67,7 +67,7 @@ QList<int> SummaryWindow::getLongestRun(){
     int m = 0;
     int n = 0;
     for (int i = 0; i < data.size(); i++){
-        for (int j = 1; j<4; j++){
+        for (int j = 1; j < data[i].runs.size(); j++){
             if (data[i].runs[j].exists){
                 if (data[i].runs[j].time[0] > data[m].runs[n].time[0]){
                     m = i;
@@ -225,6 +225,9 @@ void SummaryWindow::updateText(){
     else if (data[shortRun[0]].runs[shortRun[1]].alg == "wallfollow"){
         ui->algSR->setText("Wall Follow");
     }
+    else if (data[shortRun[0]].runs[shortRun[1]].alg == "frontier"){
+        ui->algSR->setText("Frontier");
+    }
     ui->valueSR->setText(data[shortRun[0]].runs[shortRun[1]].getTimeString(data[shortRun[0]].runs[shortRun[1]].time));
 
     QList<int> longRun = getLongestRun();
@@ -241,6 +244,9 @@ void SummaryWindow::updateText(){
     else if (data[longRun[0]].runs[longRun[1]].alg == "wallfollow"){
         ui->algLR->setText("Wall Follow");
     }
+    else if (data[longRun[0]].runs[longRun[1]].alg == "frontier"){
+        ui->algLR->setText("Frontier");
+    }
     ui->valueLR->setText(data[longRun[0]].runs[longRun[1]].getTimeString(data[longRun[0]].runs[longRun[1]].time));
 
     QList<int> mostCover = getMostCovRun();
@@ -257,6 +263,9 @@ void SummaryWindow::updateText(){
     else if (data[mostCover[0]].runs[mostCover[1]].alg == "wallfollow"){
         ui->algMC->setText("Wall Follow");
     }
+    else if (data[mostCover[0]].runs[mostCover[1]].alg == "frontier"){
+        ui->algMC->setText("Frontier");
+    }
     ui->valueMC->setText(data[mostCover[0]].runs[mostCover[1]].coverSF);
 
     QList<int> leastCover = getLeastCovRun();
@@ -273,6 +282,9 @@ void SummaryWindow::updateText(){
     else if (data[leastCover[0]].runs[leastCover[1]].alg == "wallfollow"){
         ui->algLC->setText("Wall Follow");
     }
+    else if (data[leastCover[0]].runs[leastCover[1]].alg == "frontier"){
+        ui->algLC->setText("Frontier");
+    }
     ui->valueLC->setText(data[leastCover[0]].runs[leastCover[1]].coverSF);
 
 
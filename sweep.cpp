@@ -0,0 +1,90 @@
+#include "sweep.h"
+#include "experiment.h"
+
+#include <QFileInfo>
+
+qint64 SweepSpec::getJobCount() const
+{
+    return qint64(batteryLives.size()) * vacuumEfficiencies.size() * whiskerEfficiencies.size() *
+           speeds.size() * qMax(0, seeds) * algorithms.size();
+}
+
+SweepJob SweepSpec::jobAt(qint64 index) const
+{
+    SweepJob job;
+    job.index = index;
+
+    job.algorithmIndex = int(index % algorithms.size());
+    index /= algorithms.size();
+    job.seed = baseSeed + quint64(index % seeds);
+    index /= seeds;
+    job.speed = speeds[int(index % speeds.size())];
+    index /= speeds.size();
+    job.whiskerEfficiency = whiskerEfficiencies[int(index % whiskerEfficiencies.size())];
+    index /= whiskerEfficiencies.size();
+    job.vacuumEfficiency = vacuumEfficiencies[int(index % vacuumEfficiencies.size())];
+    index /= vacuumEfficiencies.size();
+    job.batteryLife = batteryLives[int(index % batteryLives.size())];
+
+    job.algorithm = algorithms[job.algorithmIndex];
+    return job;
+}
+
+bool SweepSpec::parseAxis(const QString &text, int min, int max, QList<int> &values, QString *error)
+{
+    auto fail = [&](const QString &message) {
+        if (error) *error = message;
+        return false;
+    };
+    auto outside = [&](int value) {
+        return fail(QString("%1 is outside %2-%3").arg(value).arg(min).arg(max));
+    };
+
+    QList<int> parsed;
+    QStringList range = text.split(':');
+    if (range.size() == 3) {
+        bool okFrom, okTo, okStep;
+        int from = range[0].toInt(&okFrom);
+        int to = range[1].toInt(&okTo);
+        int step = range[2].toInt(&okStep);
+        if (!okFrom || !okTo || !okStep || step <= 0 || to < from) {
+            return fail("Invalid range \"" + text + "\", expected from:to:step");
+        }
+        // Bounded before expanding, so a stray digit cannot ask for billions of values
+        if (from < min || from > max) return outside(from);
+        if (to < min || to > max) return outside(to);
+        for (qint64 value = from; value <= to; value += step) parsed.append(int(value));
+    } else if (range.size() == 1) {
+        for (const QString &item : text.split(',', Qt::SkipEmptyParts)) {
+            bool ok;
+            int value = item.trimmed().toInt(&ok);
+            if (!ok) return fail("Invalid value \"" + item + "\"");
+            parsed.append(value);
+        }
+    } else {
+        return fail("Invalid range \"" + text + "\"");
+    }
+
+    if (parsed.isEmpty()) return fail("No values in \"" + text + "\"");
+    for (int value : parsed) {
+        if (value < min || value > max) return outside(value);
+    }
+    values = parsed;
+    return true;
+}
+
+bool SweepRunner::run(const SweepSpec &spec, const ProgressCallback &progress, QString *error)
+{
+    // A sweep is an experiment over one plan with nothing to resume
+    ExperimentSpec experiment;
+    experiment.name = QFileInfo(spec.outputPath).completeBaseName();
+    experiment.plans = {spec.housePath};
+    experiment.sweep = spec;
+    experiment.resultsPath = spec.outputPath;
+    experiment.threadCount = spec.threadCount;
+    experiment.cachePath = spec.cachePath;
+    experiment.cacheMaxBytes = spec.cacheMaxBytes;
+
+    ExperimentRunner runner;
+    return runner.run(experiment, progress, CancellationToken(), error);
+}
@@ -0,0 +1,70 @@
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include <QString>
+#include <QStringList>
+#include <QList>
+
+#include <functional>
+
+#include "strategyparams.h"
+#include "stuckdetector.h"
+
+// One point of a parameter sweep
+struct SweepJob
+{
+    qint64 index = 0;
+    int batteryLife = 150;
+    int vacuumEfficiency = 90;
+    int whiskerEfficiency = 30;
+    int speed = 12;
+    int algorithmIndex = 0;
+    QString algorithm;
+    quint64 seed = 1;
+};
+
+// Cartesian product of robot settings, algorithms and seeds over one plan.
+// Jobs are never expanded into a list: jobAt() decodes a job index as a
+// mixed-radix number, algorithm fastest, then seed, speed, whisker
+// efficiency, vacuum efficiency and battery life.
+struct SweepSpec
+{
+    QString housePath;
+    QList<int> batteryLives = {150};
+    QList<int> vacuumEfficiencies = {90};
+    QList<int> whiskerEfficiencies = {30};
+    QList<int> speeds = {12};
+    QStringList algorithms = {"Random"};
+    int seeds = 1;
+    quint64 baseSeed = 1;
+
+    QString outputPath;
+    int threadCount = 0;        // 0 uses every core
+    QString cachePath;          // result cache directory; empty runs everything
+    qint64 cacheMaxBytes = 512ll * 1024 * 1024;
+    // Coverage-plateau early termination, see EnsembleSettings; 0 disables it
+    int plateauWindow = 0;
+    double plateauMinGain = 1.0;
+    StuckAction stuckAction = StuckAction::Report;
+    StrategyParams strategyParams;
+
+    qint64 getJobCount() const;
+    SweepJob jobAt(qint64 index) const;
+
+    // Accepts "150", "6,12,18" or "from:to:step"; values outside [min, max]
+    // are rejected, as SettingsWindow does
+    static bool parseAxis(const QString &text, int min, int max, QList<int> &values, QString *error = nullptr);
+};
+
+// Runs every job of a sweep on a JobScheduler and streams one row per finished
+// job into a columnar results file (columnar.h). Rows arrive in completion
+// order; the job column gives their place in the product.
+class SweepRunner
+{
+public:
+    using ProgressCallback = std::function<void(qint64 done, qint64 total)>;
+
+    bool run(const SweepSpec &spec, const ProgressCallback &progress = nullptr, QString *error = nullptr);
+};
+
+#endif // SWEEP_H
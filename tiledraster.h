@@ -0,0 +1,123 @@
+#ifndef TILEDRASTER_H
+#define TILEDRASTER_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Row-major raster stored as 64x64-cell tiles behind reference-counted
+// pointers. Copying a raster copies the pointers only; a tile is cloned the
+// first time one of the copies writes to it, so forks of a simulation share
+// every tile they have not both touched. Tiles nobody has written are not
+// allocated at all and read as zero.
+//
+// Copies may be written from different threads, and so may different tiles
+// of one raster; one raster object must not be read and written concurrently.
+template <typename T>
+class TiledRaster
+{
+public:
+    static const int tileShift = 6;
+    static const int tileSize = 1 << tileShift;
+    static const int tileMask = tileSize - 1;
+
+    void resize(int newWidth, int newHeight)
+    {
+        width = std::max(0, newWidth);
+        height = std::max(0, newHeight);
+        tilesX = (width + tileMask) >> tileShift;
+        tilesY = (height + tileMask) >> tileShift;
+        tiles.assign(size_t(tilesX) * tilesY, nullptr);
+    }
+
+    void clear() { std::fill(tiles.begin(), tiles.end(), nullptr); }
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+
+    T get(int ix, int iy) const
+    {
+        const Tile *tile = tiles[tileIndex(ix, iy)].get();
+        return tile ? (*tile)[cellIndex(ix, iy)] : T();
+    }
+
+    // Cells (ix..ix+length-1, iy), contiguous up to the tile's right edge;
+    // length is clipped to that edge and to the raster
+    const T *readRun(int ix, int iy, int &length) const
+    {
+        length = std::min(tileSize - (ix & tileMask), width - ix);
+        const Tile *tile = tiles[tileIndex(ix, iy)].get();
+        return tile ? &(*tile)[cellIndex(ix, iy)] : &zeroTile()[0];
+    }
+
+    // Writable cell (ix, iy); the cells to its right up to the tile edge
+    // follow it in memory. Unshares the tile first.
+    T *writeRun(int ix, int iy)
+    {
+        std::shared_ptr<Tile> &tile = tiles[tileIndex(ix, iy)];
+        if (!tile) {
+            tile = std::make_shared<Tile>();
+            tile->fill(T());
+        } else if (tile.use_count() > 1) {
+            tile = std::make_shared<Tile>(*tile);
+        } else {
+            // Pairs with the release in the other owner's reference drop,
+            // so its last reads of this tile happen before our writes
+            std::atomic_thread_fence(std::memory_order_acquire);
+        }
+        return &(*tile)[cellIndex(ix, iy)];
+    }
+
+    // Adds whole tiles on each side, keeping the contents; the cell that
+    // was (0, 0) moves to (left * tileSize, top * tileSize)
+    void growTiles(int left, int top, int right, int bottom)
+    {
+        const int newTilesX = tilesX + left + right;
+        const int newTilesY = tilesY + top + bottom;
+        std::vector<std::shared_ptr<Tile>> grown(size_t(newTilesX) * newTilesY);
+        for (int ty = 0; ty < tilesY; ty++) {
+            for (int tx = 0; tx < tilesX; tx++) {
+                grown[size_t(ty + top) * newTilesX + tx + left] = std::move(tiles[size_t(ty) * tilesX + tx]);
+            }
+        }
+        tiles.swap(grown);
+        tilesX = newTilesX;
+        tilesY = newTilesY;
+        width = tilesX << tileShift;
+        height = tilesY << tileShift;
+    }
+
+    // Allocated tiles, shared or not, and how many of them another raster also holds
+    int getAllocatedTiles() const
+    {
+        return int(std::count_if(tiles.begin(), tiles.end(), [](const auto &t) { return t != nullptr; }));
+    }
+    int getSharedTiles() const
+    {
+        return int(std::count_if(tiles.begin(), tiles.end(), [](const auto &t) { return t && t.use_count() > 1; }));
+    }
+    static constexpr size_t getTileBytes() { return sizeof(Tile); }
+
+private:
+    using Tile = std::array<T, size_t(tileSize) * tileSize>;
+
+    static const Tile &zeroTile()
+    {
+        static const Tile zeros{};
+        return zeros;
+    }
+
+    size_t tileIndex(int ix, int iy) const { return size_t(iy >> tileShift) * tilesX + (ix >> tileShift); }
+    static size_t cellIndex(int ix, int iy) { return size_t(iy & tileMask) * tileSize + (ix & tileMask); }
+
+    int width = 0;
+    int height = 0;
+    int tilesX = 0;
+    int tilesY = 0;
+    std::vector<std::shared_ptr<Tile>> tiles;
+};
+
+#endif // TILEDRASTER_H
@@ -0,0 +1,196 @@
+#include "trajectory.h"
+#include "bytestream.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const char trajectoryMagic[4] = {'R', 'S', 'T', 'J'};
+const uint64_t trajectoryVersion = 1;
+
+}
+
+TrajectoryWriter::TrajectoryWriter(int keyframeInterval, int scale)
+    : keyframeInterval(std::max(1, keyframeInterval))
+    , scale(std::max(1, scale))
+{
+}
+
+void TrajectoryWriter::begin(const std::string& plan, const std::string& alg)
+{
+    planJson = plan;
+    algorithm = alg;
+    body.clear();
+    keyframes.clear();
+    lastX = 0;
+    lastY = 0;
+    tickCount = 0;
+}
+
+bool TrajectoryWriter::nextIsKeyframe() const
+{
+    return tickCount % keyframeInterval == 0;
+}
+
+void TrajectoryWriter::append(double x, double y, uint8_t flags, const std::vector<uint8_t>& keyframeState)
+{
+    if (nextIsKeyframe()) {
+        keyframes.push_back({tickCount, body.size(), lastX, lastY, keyframeState});
+    }
+
+    int64_t qx = std::llround(x * scale);
+    int64_t qy = std::llround(y * scale);
+
+    ByteWriter record;
+    record.putVarint((ByteWriter::zigzag(qx - lastX) << 2) | (flags & 0x3));
+    record.putSigned(qy - lastY);
+    body.insert(body.end(), record.data().begin(), record.data().end());
+
+    lastX = qx;
+    lastY = qy;
+    tickCount++;
+}
+
+int TrajectoryWriter::getTickCount() const
+{
+    return tickCount;
+}
+
+bool TrajectoryWriter::isEmpty() const
+{
+    return tickCount == 0;
+}
+
+std::vector<uint8_t> TrajectoryWriter::finish() const
+{
+    ByteWriter out;
+    out.putRaw(trajectoryMagic, sizeof trajectoryMagic);
+    out.putVarint(trajectoryVersion);
+    out.putVarint(uint64_t(scale));
+    out.putVarint(uint64_t(keyframeInterval));
+    out.putVarint(uint64_t(tickCount));
+    out.putString(algorithm);
+    out.putString(planJson);
+    out.putBytes(body);
+
+    out.putVarint(keyframes.size());
+    for (const TrajectoryKeyframe& kf : keyframes) {
+        out.putVarint(uint64_t(kf.tick));
+        out.putVarint(kf.offset);
+        out.putSigned(kf.prevX);
+        out.putSigned(kf.prevY);
+        out.putBytes(kf.state);
+    }
+    return out.data();
+}
+
+bool TrajectoryReader::load(std::vector<uint8_t> bytes)
+{
+    data = std::move(bytes);
+    ByteReader in(data);
+
+    char magic[4];
+    if (!in.getRaw(magic, sizeof magic) || !std::equal(magic, magic + 4, trajectoryMagic)) return false;
+    if (in.getVarint() != trajectoryVersion) return false;
+
+    scale = int(in.getVarint());
+    keyframeInterval = int(in.getVarint());
+    tickCount = int(in.getVarint());
+    algorithm = in.getString();
+    planJson = in.getString();
+
+    uint64_t bodySize = in.getVarint();
+    bodyStart = in.offset();
+    bodyEnd = bodyStart + bodySize;
+    in.seek(bodyEnd);
+
+    keyframes.clear();
+    uint64_t numKeyframes = in.getVarint();
+    for (uint64_t i = 0; i < numKeyframes && in.ok(); ++i) {
+        TrajectoryKeyframe kf;
+        kf.tick = int(in.getVarint());
+        kf.offset = size_t(in.getVarint());
+        kf.prevX = in.getSigned();
+        kf.prevY = in.getSigned();
+        kf.state = in.getBytes();
+        keyframes.push_back(std::move(kf));
+    }
+
+    return in.ok() && scale > 0 && !keyframes.empty();
+}
+
+int TrajectoryReader::getTickCount() const
+{
+    return tickCount;
+}
+
+int TrajectoryReader::getKeyframeInterval() const
+{
+    return keyframeInterval;
+}
+
+const std::string& TrajectoryReader::getPlanJson() const
+{
+    return planJson;
+}
+
+const std::string& TrajectoryReader::getAlgorithm() const
+{
+    return algorithm;
+}
+
+const TrajectoryKeyframe* TrajectoryReader::keyframeAt(int tick) const
+{
+    auto it = std::upper_bound(keyframes.begin(), keyframes.end(), tick,
+                               [](int t, const TrajectoryKeyframe& kf) { return t < kf.tick; });
+    if (it == keyframes.begin()) return nullptr;
+    return &*(it - 1);
+}
+
+bool TrajectoryReader::seek(TrajectoryCursor& cursor, int tick) const
+{
+    if (tick < 0 || tick > tickCount) return false;
+
+    const TrajectoryKeyframe* kf = keyframeAt(tick);
+    if (!kf) return false;
+
+    cursor.offset = bodyStart + kf->offset;
+    cursor.tick = kf->tick;
+    cursor.x = kf->prevX;
+    cursor.y = kf->prevY;
+
+    TrajectoryPoint skipped;
+    while (cursor.tick < tick) {
+        if (!next(cursor, skipped)) return false;
+    }
+    return true;
+}
+
+bool TrajectoryReader::next(TrajectoryCursor& cursor, TrajectoryPoint& point) const
+{
+    if (cursor.tick >= tickCount || cursor.offset >= bodyEnd) return false;
+
+    ByteReader in(data.data() + cursor.offset, bodyEnd - cursor.offset);
+    uint64_t packedX = in.getVarint();
+    int64_t dy = in.getSigned();
+    if (!in.ok()) return false;
+
+    cursor.x += ByteReader::unzigzag(packedX >> 2);
+    cursor.y += dy;
+    cursor.offset += in.offset();
+
+    point.tick = cursor.tick++;
+    point.x = double(cursor.x) / scale;
+    point.y = double(cursor.y) / scale;
+    point.flags = uint8_t(packedX & 0x3);
+    return true;
+}
+
+TrajectoryPoint TrajectoryReader::pointAt(int tick) const
+{
+    TrajectoryPoint point;
+    TrajectoryCursor cursor;
+    if (seek(cursor, tick)) next(cursor, point);
+    return point;
+}
@@ -0,0 +1,110 @@
+#ifndef TRAJECTORY_H
+#define TRAJECTORY_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Compact binary recording of one run, used by ReportWindow to replay it
+// without re-simulating.
+//
+// One record per tick holds the position delta from the previous tick in
+// fixed point (1/scale plan units), zigzag + varint packed, with the event
+// flags folded into the low bits of the x delta. Every keyframeInterval
+// ticks a keyframe stores the absolute position, the byte offset of that
+// tick's record and an opaque snapshot of the strategy state, so seeking
+// is a binary search over the keyframes plus at most keyframeInterval
+// record decodes.
+enum TrajectoryFlag : uint8_t
+{
+    TrajectoryCollision  = 0x1, // a wall or chest blocked the move this tick
+    TrajectoryModeSwitch = 0x2  // strategy entered or left its random fallback
+};
+
+struct TrajectoryPoint
+{
+    int tick = 0;
+    double x = 0.0;
+    double y = 0.0;
+    uint8_t flags = 0;
+};
+
+struct TrajectoryKeyframe
+{
+    int tick = 0;
+    size_t offset = 0;     // offset of this tick's record in the body
+    int64_t prevX = 0;     // quantized position of the previous tick
+    int64_t prevY = 0;
+    std::vector<uint8_t> state;
+};
+
+// Read position inside a trajectory. Several cursors can walk the same
+// reader independently, e.g. the robot marker and the coverage layer.
+struct TrajectoryCursor
+{
+    size_t offset = 0;
+    int tick = 0;
+    int64_t x = 0;
+    int64_t y = 0;
+};
+
+class TrajectoryWriter
+{
+public:
+    explicit TrajectoryWriter(int keyframeInterval = 256, int scale = 16);
+
+    void begin(const std::string& planJson, const std::string& algorithm);
+
+    // True when the next append() starts a keyframe and should carry the strategy state
+    bool nextIsKeyframe() const;
+    void append(double x, double y, uint8_t flags, const std::vector<uint8_t>& keyframeState = {});
+
+    int getTickCount() const;
+    bool isEmpty() const;
+    std::vector<uint8_t> finish() const;
+
+private:
+    int keyframeInterval;
+    int scale;
+    std::string planJson;
+    std::string algorithm;
+
+    std::vector<uint8_t> body;
+    std::vector<TrajectoryKeyframe> keyframes;
+    int64_t lastX = 0;
+    int64_t lastY = 0;
+    int tickCount = 0;
+};
+
+class TrajectoryReader
+{
+public:
+    bool load(std::vector<uint8_t> bytes);
+
+    int getTickCount() const;
+    int getKeyframeInterval() const;
+    const std::string& getPlanJson() const;
+    const std::string& getAlgorithm() const;
+
+    // Positions the cursor so the next call to next() returns the given tick
+    bool seek(TrajectoryCursor& cursor, int tick) const;
+    bool next(TrajectoryCursor& cursor, TrajectoryPoint& point) const;
+    TrajectoryPoint pointAt(int tick) const;
+
+    // Strategy snapshot of the last keyframe at or before tick
+    const TrajectoryKeyframe* keyframeAt(int tick) const;
+
+private:
+    std::vector<uint8_t> data;
+    size_t bodyStart = 0;
+    size_t bodyEnd = 0;
+
+    int scale = 16;
+    int keyframeInterval = 256;
+    int tickCount = 0;
+    std::string planJson;
+    std::string algorithm;
+    std::vector<TrajectoryKeyframe> keyframes;
+};
+
+#endif // TRAJECTORY_H
@@ -0,0 +1,293 @@
+#include "tuner.h"
+#include "rng.h"
+#include "vacuum.h"
+
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+#include <numeric>
+
+namespace {
+using Matrix = std::vector<std::vector<double>>;
+
+double gaussian(Rng &rng)
+{
+    // Box-Muller; 1 - u keeps the logarithm finite
+    const double u = 1.0 - rng.nextDouble(1.0);
+    const double v = rng.nextDouble(1.0);
+    return std::sqrt(-2.0 * std::log(u)) * std::cos(2.0 * M_PI * v);
+}
+
+// Eigen decomposition of a symmetric matrix by cyclic Jacobi rotations:
+// a = vectors * diag(values) * vectors^T, eigenvectors in the columns.
+// The tuner's matrices are a handful of rows, so this is plenty.
+void eigenSymmetric(Matrix a, std::vector<double> &values, Matrix &vectors)
+{
+    const int n = int(a.size());
+    vectors.assign(n, std::vector<double>(n, 0.0));
+    for (int i = 0; i < n; i++) vectors[i][i] = 1.0;
+
+    for (int sweep = 0; sweep < 50; sweep++) {
+        double off = 0.0;
+        for (int p = 0; p < n; p++) {
+            for (int q = p + 1; q < n; q++) off += a[p][q] * a[p][q];
+        }
+        if (off < 1e-30) break;
+
+        for (int p = 0; p < n; p++) {
+            for (int q = p + 1; q < n; q++) {
+                if (std::abs(a[p][q]) < 1e-300) continue;
+                const double theta = (a[q][q] - a[p][p]) / (2.0 * a[p][q]);
+                const double t = (theta >= 0 ? 1.0 : -1.0) / (std::abs(theta) + std::sqrt(theta * theta + 1.0));
+                const double c = 1.0 / std::sqrt(t * t + 1.0);
+                const double s = t * c;
+                for (int k = 0; k < n; k++) {
+                    const double kp = a[k][p];
+                    const double kq = a[k][q];
+                    a[k][p] = c * kp - s * kq;
+                    a[k][q] = s * kp + c * kq;
+                }
+                for (int k = 0; k < n; k++) {
+                    const double pk = a[p][k];
+                    const double qk = a[q][k];
+                    a[p][k] = c * pk - s * qk;
+                    a[q][k] = s * pk + c * qk;
+                }
+                for (int k = 0; k < n; k++) {
+                    const double kp = vectors[k][p];
+                    const double kq = vectors[k][q];
+                    vectors[k][p] = c * kp - s * kq;
+                    vectors[k][q] = s * kp + c * kq;
+                }
+            }
+        }
+    }
+    values.resize(n);
+    for (int i = 0; i < n; i++) values[i] = a[i][i];
+}
+
+StrategyParams fromUnit(const QString &algorithm, const StrategyParams &base,
+                        const std::vector<TunableParameter> &tunables, const std::vector<double> &unit)
+{
+    std::vector<double> values(unit.size());
+    for (size_t i = 0; i < unit.size(); i++) {
+        values[i] = tunables[i].min + std::clamp(unit[i], 0.0, 1.0) * (tunables[i].max - tunables[i].min);
+    }
+    StrategyParams params = base;
+    params.setValues(algorithm, values);
+    return params;
+}
+}
+
+std::vector<double> ParameterTuner::evaluate(const TunerSettings &settings,
+                                             const std::vector<StrategyParams> &candidates,
+                                             quint64 firstSeed, int seeds, JobScheduler &scheduler,
+                                             const CancellationToken &token)
+{
+    const int plans = settings.plans.size();
+    const int perCandidate = plans * seeds;
+    std::vector<double> totals(candidates.size(), 0.0);
+    if (perCandidate <= 0) return totals;
+
+    // One vacuum per worker and plan, each loading its plan once
+    std::vector<std::vector<std::unique_ptr<Vacuum>>> vacuums(scheduler.getThreadCount());
+    for (auto &perWorker : vacuums) perWorker.resize(plans);
+    std::mutex totalsMutex;
+
+    JobGroup group(token);
+    const qint64 jobs = qint64(candidates.size()) * perCandidate;
+    for (qint64 job = 0; job < jobs; job++) {
+        scheduler.submit(group, [&, job](const CancellationToken &cancel) {
+            const size_t candidate = size_t(job / perCandidate);
+            const int plan = int(job % perCandidate / seeds);
+            const quint64 seed = firstSeed + quint64(job % seeds);
+
+            std::unique_ptr<Vacuum> &vacuum = vacuums[JobScheduler::currentWorker()][plan];
+            if (!vacuum) {
+                QString housePath = settings.plans[plan];
+                vacuum = std::make_unique<Vacuum>(nullptr);
+                vacuum->setHousePath(housePath);
+            }
+
+            EnsembleSettings runSettings = settings.robot;
+            runSettings.strategyParams = candidates[candidate];
+            const EnsembleRunResult result = EnsembleRunner::runOnce(*vacuum, settings.algorithm, seed, runSettings, cancel);
+            if (cancel.isCancelled() || result.runtime <= 0) return;
+
+            std::lock_guard<std::mutex> lock(totalsMutex);
+            totals[candidate] += result.coverage / (result.runtime / 60.0);
+        });
+    }
+    group.wait();
+
+    for (double &total : totals) total /= perCandidate;
+    return totals;
+}
+
+bool ParameterTuner::run(const TunerSettings &settings, StrategyProfile &profile,
+                         const ProgressCallback &progress, const CancellationToken &token, QString *error)
+{
+    auto fail = [&](const QString &message) {
+        if (error) *error = message;
+        return false;
+    };
+
+    const std::vector<TunableParameter> tunables = StrategyParams::tunables(settings.algorithm);
+    const int n = int(tunables.size());
+    if (n == 0) return fail(settings.algorithm + " has no parameters to tune");
+    if (settings.plans.isEmpty()) return fail("No plans to tune on");
+    if (settings.generations <= 0 || settings.seedsPerPlan <= 0 || settings.validationSeeds <= 0) {
+        return fail("Need at least one generation and one seed");
+    }
+
+    // Strategy parameters (Hansen, "The CMA Evolution Strategy: A Tutorial")
+    const int lambda = settings.population > 0 ? std::max(2, settings.population) : 4 + int(3 * std::log(double(n)));
+    const int mu = lambda / 2;
+    std::vector<double> weights(mu);
+    for (int i = 0; i < mu; i++) weights[i] = std::log(mu + 0.5) - std::log(i + 1.0);
+    const double weightSum = std::accumulate(weights.begin(), weights.end(), 0.0);
+    double squares = 0.0;
+    for (double &w : weights) {
+        w /= weightSum;
+        squares += w * w;
+    }
+    const double muEff = 1.0 / squares;
+    const double cc = (4.0 + muEff / n) / (n + 4.0 + 2.0 * muEff / n);
+    const double cs = (muEff + 2.0) / (n + muEff + 5.0);
+    const double c1 = 2.0 / ((n + 1.3) * (n + 1.3) + muEff);
+    const double cmu = std::min(1.0 - c1, 2.0 * (muEff - 2.0 + 1.0 / muEff) / ((n + 2.0) * (n + 2.0) + muEff));
+    const double damps = 1.0 + 2.0 * std::max(0.0, std::sqrt((muEff - 1.0) / (n + 1.0)) - 1.0) + cs;
+    const double chiN = std::sqrt(double(n)) * (1.0 - 1.0 / (4.0 * n) + 1.0 / (21.0 * n * n));
+
+    // Start from the given parameters
+    std::vector<double> mean(n);
+    const StrategyParams &base = settings.robot.strategyParams;
+    const std::vector<double> start = base.getValues(settings.algorithm);
+    for (int i = 0; i < n; i++) mean[i] = (start[i] - tunables[i].min) / (tunables[i].max - tunables[i].min);
+    double sigma = settings.initialStepSize;
+    Matrix covariance(n, std::vector<double>(n, 0.0));
+    for (int i = 0; i < n; i++) covariance[i][i] = 1.0;
+    Matrix basis = covariance;
+    std::vector<double> scales(n, 1.0);     // square roots of the eigenvalues
+    std::vector<double> pathC(n, 0.0);
+    std::vector<double> pathSigma(n, 0.0);
+
+    int threads = settings.threadCount > 0 ? settings.threadCount : int(std::thread::hardware_concurrency());
+    JobScheduler scheduler(std::max(1, threads));
+    Rng rng(settings.searchSeed);
+
+    std::vector<double> bestSeen = mean;
+    double bestSeenScore = -1.0;
+
+    std::vector<std::vector<double>> samples(lambda, std::vector<double>(n));
+    std::vector<StrategyParams> candidates(lambda);
+    for (int generation = 0; generation < settings.generations; generation++) {
+        for (int k = 0; k < lambda; k++) {
+            std::vector<double> z(n);
+            for (double &value : z) value = gaussian(rng);
+            for (int i = 0; i < n; i++) {
+                double y = 0.0;
+                for (int j = 0; j < n; j++) y += basis[i][j] * scales[j] * z[j];
+                // Repaired onto the box, and the repaired point is what the update sees
+                samples[k][i] = std::clamp(mean[i] + sigma * y, 0.0, 1.0);
+            }
+            candidates[k] = fromUnit(settings.algorithm, base, tunables, samples[k]);
+        }
+
+        const quint64 firstSeed = settings.baseSeed + quint64(generation) * quint64(settings.seedsPerPlan);
+        const std::vector<double> scores = evaluate(settings, candidates, firstSeed, settings.seedsPerPlan,
+                                                    scheduler, token);
+        if (token.isCancelled()) return fail("Interrupted");
+
+        std::vector<int> order(lambda);
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return scores[a] > scores[b]; });
+        if (scores[order[0]] > bestSeenScore) {
+            bestSeenScore = scores[order[0]];
+            bestSeen = samples[order[0]];
+        }
+
+        // New mean from the better half
+        const std::vector<double> oldMean = mean;
+        std::fill(mean.begin(), mean.end(), 0.0);
+        for (int r = 0; r < mu; r++) {
+            for (int i = 0; i < n; i++) mean[i] += weights[r] * samples[order[r]][i];
+        }
+        std::vector<double> shift(n);
+        for (int i = 0; i < n; i++) shift[i] = (mean[i] - oldMean[i]) / sigma;
+
+        // Evolution paths; C^-1/2 shift = B D^-1 B^T shift
+        std::vector<double> whitened(n, 0.0);
+        for (int j = 0; j < n; j++) {
+            double projection = 0.0;
+            for (int i = 0; i < n; i++) projection += basis[i][j] * shift[i];
+            projection /= scales[j];
+            for (int i = 0; i < n; i++) whitened[i] += basis[i][j] * projection;
+        }
+        double pathSigmaNorm = 0.0;
+        for (int i = 0; i < n; i++) {
+            pathSigma[i] = (1.0 - cs) * pathSigma[i] + std::sqrt(cs * (2.0 - cs) * muEff) * whitened[i];
+            pathSigmaNorm += pathSigma[i] * pathSigma[i];
+        }
+        pathSigmaNorm = std::sqrt(pathSigmaNorm);
+        const bool stalled = pathSigmaNorm / std::sqrt(1.0 - std::pow(1.0 - cs, 2.0 * (generation + 1))) / chiN
+                             >= 1.4 + 2.0 / (n + 1.0);
+        const double hsig = stalled ? 0.0 : 1.0;
+        for (int i = 0; i < n; i++) {
+            pathC[i] = (1.0 - cc) * pathC[i] + hsig * std::sqrt(cc * (2.0 - cc) * muEff) * shift[i];
+        }
+
+        // Rank-one and rank-mu covariance updates
+        for (int i = 0; i < n; i++) {
+            for (int j = 0; j <= i; j++) {
+                double rankMu = 0.0;
+                for (int r = 0; r < mu; r++) {
+                    const std::vector<double> &x = samples[order[r]];
+                    rankMu += weights[r] * (x[i] - oldMean[i]) * (x[j] - oldMean[j]) / (sigma * sigma);
+                }
+                const double value = (1.0 - c1 - cmu) * covariance[i][j] +
+                                     c1 * (pathC[i] * pathC[j] + (1.0 - hsig) * cc * (2.0 - cc) * covariance[i][j]) +
+                                     cmu * rankMu;
+                covariance[i][j] = covariance[j][i] = value;
+            }
+        }
+        sigma *= std::exp((cs / damps) * (pathSigmaNorm / chiN - 1.0));
+        sigma = std::min(sigma, 1.0);
+
+        std::vector<double> eigenvalues;
+        eigenSymmetric(covariance, eigenvalues, basis);
+        for (int i = 0; i < n; i++) scales[i] = std::sqrt(std::max(eigenvalues[i], 1e-20));
+
+        if (progress) {
+            TunerProgress report;
+            report.generation = generation + 1;
+            report.bestScore = scores[order[0]];
+            report.meanScore = std::accumulate(scores.begin(), scores.end(), 0.0) / lambda;
+            report.stepSize = sigma;
+            progress(report);
+        }
+    }
+
+    // Final comparison on seeds no generation used
+    const std::vector<StrategyParams> finalists = {
+        base,
+        fromUnit(settings.algorithm, base, tunables, mean),
+        fromUnit(settings.algorithm, base, tunables, bestSeen)
+    };
+    const quint64 validationSeed = settings.baseSeed + quint64(settings.generations) * quint64(settings.seedsPerPlan);
+    const std::vector<double> validation = evaluate(settings, finalists, validationSeed, settings.validationSeeds,
+                                                    scheduler, token);
+    if (token.isCancelled()) return fail("Interrupted");
+
+    size_t best = 0;
+    for (size_t i = 1; i < finalists.size(); i++) {
+        if (validation[i] > validation[best]) best = i;
+    }
+    profile = StrategyProfile();
+    profile.algorithm = settings.algorithm;
+    profile.plans = settings.plans;
+    profile.params = finalists[best];
+    profile.score = validation[best];
+    profile.baselineScore = validation[0];
+    return true;
+}
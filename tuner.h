@@ -0,0 +1,71 @@
+#ifndef TUNER_H
+#define TUNER_H
+
+#include <QString>
+#include <QStringList>
+
+#include <functional>
+#include <vector>
+
+#include "ensemble.h"
+#include "jobscheduler.h"
+#include "strategyparams.h"
+
+struct TunerSettings
+{
+    QStringList plans;          // one plan tunes for it, several for the corpus
+    QString algorithm = "Spiral";
+    EnsembleSettings robot;     // battery, efficiencies, speed, plateau and stuck handling,
+                                // and the parameters the search starts from
+
+    int generations = 20;
+    int population = 0;         // candidates per generation, 0 for 4 + 3 ln(parameters)
+    int seedsPerPlan = 4;       // runs per candidate and plan in each generation
+    int validationSeeds = 16;   // per plan, for the final comparison
+    quint64 baseSeed = 1;
+    quint64 searchSeed = 1;     // drives the sampling, not the runs
+    double initialStepSize = 0.25;  // as a share of each parameter's range
+
+    int threadCount = 0;        // 0 uses every core
+};
+
+struct TunerProgress
+{
+    int generation = 0;
+    double bestScore = 0.0;     // best candidate of the generation
+    double meanScore = 0.0;
+    double stepSize = 0.0;
+};
+
+// Tunes the parameters of one heuristic strategy for the most coverage per
+// battery minute (sq. ft per minute of battery used), with CMA-ES: each
+// generation samples candidates from a Gaussian over the parameter ranges
+// scaled to [0, 1], runs every candidate on every plan on a JobScheduler,
+// and moves the Gaussian's mean, shape and step size towards the better
+// half. All candidates of a generation share its seeds, so they are
+// compared on the same runs; each generation draws new seeds so the search
+// does not fit a few lucky ones.
+//
+// The starting parameters, the final mean and the best candidate seen are
+// then run on validation seeds no generation used, and the best of the three
+// is kept, so a tuned profile never scores below the parameters it started
+// from. Fields the tuner does not search, like spot cleaning, keep the
+// starting value throughout.
+class ParameterTuner
+{
+public:
+    using ProgressCallback = std::function<void(const TunerProgress &progress)>;
+
+    bool run(const TunerSettings &settings, StrategyProfile &profile,
+             const ProgressCallback &progress = nullptr,
+             const CancellationToken &token = CancellationToken(), QString *error = nullptr);
+
+    // Mean coverage per battery minute of each candidate over every plan
+    // and the seeds firstSeed .. firstSeed + seeds - 1; cancelled runs count as 0
+    static std::vector<double> evaluate(const TunerSettings &settings,
+                                        const std::vector<StrategyParams> &candidates,
+                                        quint64 firstSeed, int seeds, JobScheduler &scheduler,
+                                        const CancellationToken &token);
+};
+
+#endif // TUNER_H
@@ -5,10 +5,21 @@
 #include <QtCore/QJsonObject>
 #include <QtCore/QJsonArray>
 #include <QtCore/QFile>
+#include <QtCore/QCryptographicHash>
 #include <QString>
 #include <cmath>
+#include <algorithm>
 #include <iostream>
-#include <QRandomGenerator>
+#include <limits>
+
+#include "bytestream.h"
+#include "compiledplan.h"
+#include "fleet.h"
+#include "frontier.h"
+#include "pocketmap.h"
+#include "roomgraph.h"
+#include "pathplanner.h"
+#include "trajectory.h"
 
 Vacuum::Vacuum(QGraphicsScene* scene)
 {
@@ -19,30 +30,56 @@ Vacuum::Vacuum(QGraphicsScene* scene)
     velocity = {0.0, 0.0};
     this->scene = scene;
 
-    collisionSystem = new CollisionSystem();
+    collisionSystem = std::make_shared<CollisionSystem>();
+}
+
+Vacuum::~Vacuum()
+{
+}
+
+std::unique_ptr<Vacuum> Vacuum::fork() const
+{
+    std::unique_ptr<Vacuum> copy(new Vacuum(*this));
+    copy->scene = nullptr;
+    copy->vacuumGraphic = nullptr;
+    copy->pathPlanner.reset();      // the copy builds its own when it needs one
+    copy->sharedCoverage = nullptr; // and runs on its own
+    copy->robotIndex = nullptr;
+    if (frontierMap) copy->frontierMap = std::make_shared<FrontierMap>(*frontierMap);
+    return copy;
 }
 
 // A method to reset the vacuum and add back into the simulation for multiple runs
 void Vacuum::reset()
 {
-    vacuumGraphic = scene->addEllipse(-diameter/2, -diameter/2, diameter, diameter,
-                                      QPen(Qt::black), QBrush(Qt::red));
-    if (scene && vacuumGraphic)
-    {
-        scene->removeItem(vacuumGraphic);
-        delete vacuumGraphic;
-        vacuumGraphic = nullptr;
-    }
-    else
+    // The previous graphic went with scene->clear(); headless vacuums have none
+    vacuumGraphic = nullptr;
+    if (scene)
     {
-        qWarning() << "Scene or vacuumGraphic is null.";
+        vacuumGraphic = scene->addEllipse(-diameter/2, -diameter/2, diameter, diameter,
+                                          QPen(Qt::black), QBrush(Qt::red));
+        vacuumGraphic->setZValue(2); // Above the plan and coverage layers
     }
-    vacuumGraphic = scene->addEllipse(-diameter/2, -diameter/2, diameter, diameter,
-                                            QPen(Qt::black), QBrush(Qt::red));
-    position = collisionSystem->getVacuumStartPosition();
+    position = hasStartPosition ? startPosition : collisionSystem->getVacuumStartPosition();
     setVacuumPosition(position);
-    lastTrailPoint = vacuumGraphic->pos();
-    cleanedCoords.clear();
+    velocity = {0.0, 0.0};
+    strategy = StrategyState();
+    stepEvents = 0;
+    stuckDetector.reset();
+    lastStuckState = StuckState::Moving;
+    stuckTelemetry = StuckTelemetry();
+    frontierMap.reset();
+    tickPath.clear();
+    blockedByRobot = false;
+    dockState = DockState::Cleaning;
+    nextHomeCheck = std::numeric_limits<int>::max();
+
+    Vector2D planTopLeft = position, planBottomRight = position;
+    if (collisionSystem->getBounds(planTopLeft, planBottomRight)) {
+        visitGrid.reset(planTopLeft.x, planTopLeft.y, planBottomRight.x, planBottomRight.y, visitCellSize);
+    }
+    cleanedPoints.reset(planTopLeft.x, planTopLeft.y, planBottomRight.x, planBottomRight.y);
+    visitGrid.stampDisc(position.x, position.y, radius);
 }
 
 
@@ -51,9 +88,37 @@ void Vacuum::reset()
 void Vacuum::setHousePath(QString& path)
 {
     housePath = path;
+    // Forks share the plan; give this vacuum its own before loading over it
+    if (collisionSystem.use_count() > 1) collisionSystem = std::make_shared<CollisionSystem>();
     if (!collisionSystem->loadFromJson(housePath)) {
         qWarning() << "Failed to load plan from" << housePath;
     }
+    compiledPlan = std::make_shared<const CompiledPlan>(*collisionSystem, radius);
+    roomGraph = std::make_shared<const RoomGraph>(compiledPlan);
+    coverageRoute.reset();
+    pathPlanner.reset();
+    navPath.reset();
+    frontierMap.reset();
+    hasStartPosition = false;
+    partitionRooms.clear();
+    partitionMask.clear();
+}
+
+// Restarts the random stream; the same seed and settings replay the same run
+void Vacuum::setSeed(uint64_t newSeed)
+{
+    seed = newSeed;
+    rng.setSeed(seed);
+}
+
+void Vacuum::setStuckAction(StuckAction action)
+{
+    stuckAction = action;
+}
+
+void Vacuum::setStrategyParams(const StrategyParams &params)
+{
+    strategyParams = params;
 }
 
 void Vacuum::setBatteryLife(int minutes)
@@ -91,10 +156,12 @@ void Vacuum::setSpeed(int inchesPerSecond)
 void Vacuum::setPathingAlgorithm(const QString& algorithm)
 {
     currentAlgorithm = algorithm;
+    frontierMap.reset();
 }
 
 void Vacuum::setVacuumPosition(Vector2D& startPosition)
 {
+    if (!vacuumGraphic) return;
     vacuumGraphic->setPos(startPosition.x, startPosition.y);
     startPosition.x = vacuumGraphic->pos().x();
     startPosition.y = vacuumGraphic->pos().y();
@@ -127,6 +194,11 @@ QString Vacuum::getPathingAlgorithm() const
     return currentAlgorithm;
 }
 
+QString Vacuum::getHousePath() const
+{
+    return housePath;
+}
+
 QGraphicsEllipseItem* Vacuum::getGraphic() const
 {
     return vacuumGraphic;
@@ -139,7 +211,455 @@ const Vector2D& Vacuum::getPosition() const
 
 double Vacuum::getCoveredArea() const
 {
-    return cleanedCoords.size(); //coveredArea;
+    return cleanedPoints.size();
+}
+
+const VisitGrid& Vacuum::getVisitGrid() const
+{
+    return visitGrid;
+}
+
+QByteArray Vacuum::getPlanHash() const
+{
+    return collisionSystem->getPlanHash();
+}
+
+uint8_t Vacuum::getStepEvents() const
+{
+    return stepEvents;
+}
+
+uint64_t Vacuum::getSeed() const
+{
+    return seed;
+}
+
+StuckAction Vacuum::getStuckAction() const
+{
+    return stuckAction;
+}
+
+const StrategyParams &Vacuum::getStrategyParams() const
+{
+    return strategyParams;
+}
+
+void Vacuum::setStartPosition(const Vector2D &start)
+{
+    hasStartPosition = true;
+    startPosition = start;
+}
+
+void Vacuum::setSharedCoverage(const VisitGrid *coverage)
+{
+    sharedCoverage = coverage;
+    frontierMap.reset();
+}
+
+void Vacuum::setRobotIndex(const RobotIndex *index, int id)
+{
+    robotIndex = index;
+    robotId = id;
+}
+
+void Vacuum::refreshCoverage(double left, double top, double right, double bottom)
+{
+    if (frontierMap) frontierMap->update(coverage(), left, top, right, bottom);
+}
+
+const std::vector<Vector2D> &Vacuum::getTickPath() const
+{
+    return tickPath;
+}
+
+bool Vacuum::wasBlockedByRobot() const
+{
+    return blockedByRobot;
+}
+
+void Vacuum::setRoomPartition(const std::vector<int> &rooms)
+{
+    partitionRooms.clear();
+    partitionMask.clear();
+    if (!rooms.empty() && compiledPlan) {
+        // Rooms the plan does not have are ignored
+        const int roomCount = int(compiledPlan->getRooms().size());
+        partitionMask.assign(roomCount, 0);
+        for (int room : rooms) {
+            if (room < 0 || room >= roomCount || partitionMask[room]) continue;
+            partitionMask[room] = 1;
+            partitionRooms.push_back(room);
+        }
+        if (partitionRooms.empty()) partitionMask.clear();
+    }
+    strategy.partitionRoom = -1;
+    coverageRoute.reset();
+}
+
+const std::vector<int> &Vacuum::getRoomPartition() const
+{
+    return partitionRooms;
+}
+
+bool Vacuum::inPartition(const Vector2D& pos) const
+{
+    if (partitionMask.empty()) return true;
+    const int room = compiledPlan->roomAt(pos);
+    return room < 0 || partitionMask[room];
+}
+
+// Outside its partition, a heuristic strategy first walks to the nearest of
+// its rooms on the room graph. The room is picked once per trip, not per
+// tick. False when inside or no way is found.
+bool Vacuum::moveToPartition(Vector2D& next, int speed)
+{
+    if (inPartition(position)) {
+        strategy.partitionRoom = -1;
+        return false;
+    }
+    if (strategy.partitionRoom < 0) {
+        const std::vector<int> order = roomGraph->tour(compiledPlan->roomNear(position), partitionRooms);
+        if (order.empty()) return false;
+        strategy.partitionRoom = order.front();
+    }
+    const Room2D& room = compiledPlan->getRooms()[strategy.partitionRoom];
+    const Vector2D centre = {(room.topLeft.x + room.bottomRight.x) / 2, (room.topLeft.y + room.bottomRight.y) / 2};
+    const int square = compiledPlan->nearestFree(centre, std::max(room.bottomRight.x - room.topLeft.x,
+                                                                  room.bottomRight.y - room.topLeft.y));
+    if (square < 0 || navigateTo(compiledPlan->gridCentre(square), next, speed) == NavStatus::Unreachable) return false;
+    const double len = std::hypot(next.x - position.x, next.y - position.y);
+    if (len > 0) velocity = {(next.x - position.x) / len, (next.y - position.y) / len};
+    return true;
+}
+
+void Vacuum::setReturnToDock(bool enabled, int reserveSeconds)
+{
+    returnToDock = enabled;
+    dockReserve = std::max(0, reserveSeconds);
+    nextHomeCheck = std::numeric_limits<int>::max();
+}
+
+bool Vacuum::getReturnToDock() const
+{
+    return returnToDock;
+}
+
+DockState Vacuum::getDockState() const
+{
+    return dockState;
+}
+
+void Vacuum::undock()
+{
+    if (dockState != DockState::Docked) return;
+    dockState = DockState::Resuming;
+    nextHomeCheck = std::numeric_limits<int>::max();
+    stuckDetector.reset();
+    lastStuckState = StuckState::Moving;
+}
+
+// Turns for home once the battery left is the way home plus the reserve.
+// Per tick the battery drops by one and the way home grows by at most one
+// tick's travel, so the margin shrinks by at most two: the planner is not
+// asked again until half of it is gone.
+void Vacuum::checkDockReserve()
+{
+    std::vector<Vector2D> path;
+    if (!compiledPlan || !getPathPlanner().findPath(position, collisionSystem->getDockPosition(), path)) {
+        // Pressed into a corner the planner cannot start from; look again shortly
+        nextHomeCheck = batteryLife - 10;
+        return;
+    }
+    double length = 0.0;
+    Vector2D at = position;
+    for (const Vector2D& point : path) {
+        length += std::hypot(point.x - at.x, point.y - at.y);
+        at = point;
+    }
+    const int margin = batteryLife - int(std::ceil(length / std::max(1, speed))) - dockReserve;
+    if (margin > 0) {
+        nextHomeCheck = batteryLife - std::max(1, margin / 2);
+        return;
+    }
+    dockState = DockState::Returning;
+    resumeAt = position;
+    resumeVelocity = velocity;
+    strategy.navIndex = -1;
+}
+
+// Home to the dock, or back from it to where the strategy broke off
+Vector2D Vacuum::moveDock(int speed)
+{
+    const bool home = dockState == DockState::Returning;
+    Vector2D next;
+    switch (navigateTo(home ? collisionSystem->getDockPosition() : resumeAt, next, speed)) {
+    case NavStatus::Moving:
+        break;
+    case NavStatus::Arrived:
+        if (home) {
+            dockState = DockState::Docked;
+        } else {
+            dockState = DockState::Cleaning;
+            velocity = resumeVelocity;
+            return next;
+        }
+        break;
+    case NavStatus::Unreachable:
+        // Lost the way: clean on where it stands
+        dockState = DockState::Cleaning;
+        nextHomeCheck = batteryLife - 10;
+        break;
+    }
+    const double len = std::hypot(next.x - position.x, next.y - position.y);
+    if (len > 0) velocity = {(next.x - position.x) / len, (next.y - position.y) / len};
+    return next;
+}
+
+const StuckTelemetry& Vacuum::getStuckTelemetry() const
+{
+    return stuckTelemetry;
+}
+
+const CollisionSystem& Vacuum::getCollisionSystem() const
+{
+    return *collisionSystem;
+}
+
+const CompiledPlan* Vacuum::getCompiledPlan() const
+{
+    return compiledPlan.get();
+}
+
+const RoomGraph* Vacuum::getRoomGraph() const
+{
+    return roomGraph.get();
+}
+
+bool Vacuum::isFinished() const
+{
+    return batteryLife <= 0 || stuckTelemetry.aborted || dockState == DockState::Docked;
+}
+
+bool Vacuum::isPlanningStrategy(const QString &algorithm, const StrategyParams &params)
+{
+    const QString name = algorithm.toLower();
+    return name == "boustrophedon" || name == "frontier" || (name == "spiral" && params.spiral.spotCleaning);
+}
+
+std::vector<uint8_t> Vacuum::saveStrategyState() const
+{
+    ByteWriter out;
+    out.putDouble(velocity.x);
+    out.putDouble(velocity.y);
+    out.putDouble(strategy.spiralAngle);
+    out.putDouble(strategy.spiralRadius);
+    out.putByte(strategy.spiralInRandomMode);
+    out.putSigned(strategy.spiralRandomCooldown);
+    out.putDouble(strategy.wallFollowAngle);
+    out.putByte(strategy.movingRight);
+    out.putByte(strategy.movingDown);
+    out.putByte(strategy.movingUpward);
+    out.putDouble(strategy.snakeLeftBound);
+    out.putDouble(strategy.snakeRightBound);
+    out.putDouble(strategy.snakeTopBound);
+    out.putDouble(strategy.snakeBottomBound);
+    out.putByte(strategy.inRandomFallback);
+    out.putSigned(strategy.recoveryTicks);
+    out.putSigned(strategy.routeIndex);
+    out.putDouble(strategy.routeStart.x);
+    out.putDouble(strategy.routeStart.y);
+    out.putDouble(strategy.spotRadius);
+    out.putDouble(strategy.spotCentre.x);
+    out.putDouble(strategy.spotCentre.y);
+    out.putByte(strategy.spotSpiraling);
+    out.putSigned(strategy.navIndex);
+    out.putDouble(strategy.navStart.x);
+    out.putDouble(strategy.navStart.y);
+    out.putDouble(strategy.navTarget.x);
+    out.putDouble(strategy.navTarget.y);
+    out.putSigned(strategy.partitionRoom);
+    return out.data();
+}
+
+bool Vacuum::restoreStrategyState(const std::vector<uint8_t>& bytes)
+{
+    ByteReader in(bytes);
+    Vector2D v;
+    StrategyState s;
+    v.x = in.getDouble();
+    v.y = in.getDouble();
+    s.spiralAngle = in.getDouble();
+    s.spiralRadius = in.getDouble();
+    s.spiralInRandomMode = in.getByte();
+    s.spiralRandomCooldown = int(in.getSigned());
+    s.wallFollowAngle = in.getDouble();
+    s.movingRight = in.getByte();
+    s.movingDown = in.getByte();
+    s.movingUpward = in.getByte();
+    s.snakeLeftBound = in.getDouble();
+    s.snakeRightBound = in.getDouble();
+    s.snakeTopBound = in.getDouble();
+    s.snakeBottomBound = in.getDouble();
+    s.inRandomFallback = in.getByte();
+    s.recoveryTicks = int(in.getSigned());
+    s.routeIndex = int(in.getSigned());
+    s.routeStart.x = in.getDouble();
+    s.routeStart.y = in.getDouble();
+    s.spotRadius = in.getDouble();
+    s.spotCentre.x = in.getDouble();
+    s.spotCentre.y = in.getDouble();
+    s.spotSpiraling = in.getByte();
+    s.navIndex = int(in.getSigned());
+    s.navStart.x = in.getDouble();
+    s.navStart.y = in.getDouble();
+    s.navTarget.x = in.getDouble();
+    s.navTarget.y = in.getDouble();
+    s.partitionRoom = int(in.getSigned());
+    if (!in.ok()) return false;
+
+    velocity = v;
+    strategy = s;
+    return true;
+}
+
+namespace {
+const char checkpointMagic[4] = {'R', 'S', 'V', 'C'};
+const uint64_t checkpointVersion = 7;
+}
+
+QByteArray Vacuum::saveCheckpoint() const
+{
+    ByteWriter out;
+    out.putRaw(checkpointMagic, sizeof checkpointMagic);
+    out.putVarint(checkpointVersion);
+    const QByteArray planHash = getPlanHash();
+    out.putBytes(reinterpret_cast<const uint8_t*>(planHash.constData()), size_t(planHash.size()));
+
+    out.putString(currentAlgorithm.toStdString());
+    out.putVarint(seed);
+    out.putSigned(vacuumEfficiency);
+    out.putSigned(whiskerEfficiency);
+    out.putSigned(speed);
+    out.putByte(uint8_t(stuckAction));
+    strategyParams.save(out);
+
+    out.putSigned(batteryLife);
+    out.putDouble(position.x);
+    out.putDouble(position.y);
+    out.putBytes(saveStrategyState());      // velocity and strategy
+    for (uint32_t word : rng.getState()) out.putVarint(word);
+    out.putByte(stepEvents);
+
+    stuckDetector.save(out);
+    out.putByte(uint8_t(lastStuckState));
+    out.putVarint(uint64_t(stuckTelemetry.stuckEvents));
+    out.putVarint(uint64_t(stuckTelemetry.oscillationEvents));
+    out.putVarint(uint64_t(stuckTelemetry.stuckTicks));
+    out.putVarint(uint64_t(stuckTelemetry.recoveries));
+    out.putByte(stuckTelemetry.aborted);
+
+    out.putByte(returnToDock);
+    out.putSigned(dockReserve);
+    out.putByte(uint8_t(dockState));
+    out.putSigned(nextHomeCheck);
+    out.putDouble(resumeAt.x);
+    out.putDouble(resumeAt.y);
+    out.putDouble(resumeVelocity.x);
+    out.putDouble(resumeVelocity.y);
+
+    cleanedPoints.save(out);
+    visitGrid.save(out);
+    return qCompress(reinterpret_cast<const uchar*>(out.data().data()), int(out.size()));
+}
+
+bool Vacuum::restoreCheckpoint(const QByteArray& checkpoint)
+{
+    const QByteArray bytes = qUncompress(checkpoint);
+    ByteReader in(reinterpret_cast<const uint8_t*>(bytes.constData()), size_t(bytes.size()));
+
+    char magic[4] = {};
+    in.getRaw(magic, sizeof magic);
+    if (!std::equal(magic, magic + 4, checkpointMagic) || in.getVarint() != checkpointVersion) return false;
+    std::vector<uint8_t> planHash = in.getBytes();
+    const QByteArray currentHash = getPlanHash();
+    if (planHash != std::vector<uint8_t>(currentHash.begin(), currentHash.end())) return false;
+
+    // Decode into locals first so a bad checkpoint changes nothing
+    QString algorithm = QString::fromStdString(in.getString());
+    uint64_t savedSeed = in.getVarint();
+    int savedVacuumEfficiency = int(in.getSigned());
+    int savedWhiskerEfficiency = int(in.getSigned());
+    int savedSpeed = int(in.getSigned());
+    uint8_t savedStuckAction = in.getByte();
+    StrategyParams savedParams;
+    bool valid = savedParams.load(in);
+
+    int savedBattery = int(in.getSigned());
+    Vector2D savedPosition;
+    savedPosition.x = in.getDouble();
+    savedPosition.y = in.getDouble();
+    std::vector<uint8_t> strategyBytes = in.getBytes();
+    std::array<uint32_t, 4> rngState;
+    for (uint32_t &word : rngState) word = uint32_t(in.getVarint());
+    uint8_t savedStepEvents = in.getByte();
+
+    StuckDetector savedDetector(stuckDetector.getWindow(), stuckDetector.getMinSpread());
+    valid = valid && savedDetector.load(in);
+    uint8_t savedStuckState = in.getByte();
+    StuckTelemetry savedTelemetry;
+    savedTelemetry.stuckEvents = int(in.getVarint());
+    savedTelemetry.oscillationEvents = int(in.getVarint());
+    savedTelemetry.stuckTicks = int(in.getVarint());
+    savedTelemetry.recoveries = int(in.getVarint());
+    savedTelemetry.aborted = in.getByte() != 0;
+
+    const bool savedReturnToDock = in.getByte() != 0;
+    const int savedDockReserve = int(in.getSigned());
+    const uint8_t savedDockState = in.getByte();
+    const int savedNextHomeCheck = int(in.getSigned());
+    Vector2D savedResumeAt, savedResumeVelocity;
+    savedResumeAt.x = in.getDouble();
+    savedResumeAt.y = in.getDouble();
+    savedResumeVelocity.x = in.getDouble();
+    savedResumeVelocity.y = in.getDouble();
+
+    CleanedPoints savedPoints;
+    VisitGrid savedGrid;
+    valid = valid && savedPoints.load(in) && savedGrid.load(in);
+    if (!valid || !in.ok() || savedStuckAction > uint8_t(StuckAction::Abort) ||
+        savedStuckState > uint8_t(StuckState::Oscillating) || savedDockState > uint8_t(DockState::Resuming)) {
+        return false;
+    }
+
+    // The last check; it only writes velocity and strategy when it succeeds
+    if (!restoreStrategyState(strategyBytes)) return false;
+
+    currentAlgorithm = algorithm;
+    seed = savedSeed;
+    rng.setState(rngState);
+    vacuumEfficiency = savedVacuumEfficiency;
+    whiskerEfficiency = savedWhiskerEfficiency;
+    speed = savedSpeed;
+    stuckAction = StuckAction(savedStuckAction);
+    strategyParams = savedParams;
+    batteryLife = savedBattery;
+    position = savedPosition;
+    stepEvents = savedStepEvents;
+    stuckDetector = savedDetector;
+    lastStuckState = StuckState(savedStuckState);
+    stuckTelemetry = savedTelemetry;
+    returnToDock = savedReturnToDock;
+    dockReserve = savedDockReserve;
+    dockState = DockState(savedDockState);
+    nextHomeCheck = savedNextHomeCheck;
+    resumeAt = savedResumeAt;
+    resumeVelocity = savedResumeVelocity;
+    cleanedPoints = std::move(savedPoints);
+    visitGrid = std::move(savedGrid);
+    frontierMap.reset();
+
+    if (vacuumGraphic) vacuumGraphic->setPos(position.x, position.y);
+    return true;
 }
 
 //---------------------------------------------------------------------------------------------------------------------------------------
@@ -163,6 +683,68 @@ const Room2D* CollisionSystem::getCurrentRoom(const Vector2D& pos) const
     return nullptr;
 }
 
+bool CollisionSystem::getBounds(Vector2D& topLeft, Vector2D& bottomRight) const
+{
+    if (rooms.empty()) return false;
+
+    topLeft = rooms.front().topLeft;
+    bottomRight = rooms.front().bottomRight;
+    for (const auto& room : rooms) {
+        topLeft.x = std::min(topLeft.x, room.topLeft.x);
+        topLeft.y = std::min(topLeft.y, room.topLeft.y);
+        bottomRight.x = std::max(bottomRight.x, room.bottomRight.x);
+        bottomRight.y = std::max(bottomRight.y, room.bottomRight.y);
+    }
+    return true;
+}
+
+QByteArray CollisionSystem::getPlanHash() const
+{
+    // Everything the collision checks and the start position depend on, in
+    // load order (room order decides which room a point belongs to)
+    ByteWriter canonical;
+    canonical.putString("robosim-plan 1");
+    canonical.putVarint(rooms.size());
+    for (const auto& room : rooms) {
+        canonical.putDouble(room.topLeft.x);
+        canonical.putDouble(room.topLeft.y);
+        canonical.putDouble(room.bottomRight.x);
+        canonical.putDouble(room.bottomRight.y);
+    }
+    canonical.putVarint(doors.size());
+    for (const auto& door : doors) {
+        canonical.putDouble(door.origin.x);
+        canonical.putDouble(door.origin.y);
+    }
+    canonical.putVarint(obstructions.size());
+    for (const auto& obs : obstructions) {
+        canonical.putByte(obs.isChest ? 1 : 0);
+        canonical.putDouble(obs.topLeft.x);
+        canonical.putDouble(obs.topLeft.y);
+        canonical.putDouble(obs.bottomRight.x);
+        canonical.putDouble(obs.bottomRight.y);
+    }
+    canonical.putDouble(vacuumStart.x);
+    canonical.putDouble(vacuumStart.y);
+    // Only plans that have them hash them, so older plans keep their hash
+    if (!additionalStarts.empty()) {
+        canonical.putVarint(additionalStarts.size());
+        for (const Vector2D& start : additionalStarts) {
+            canonical.putDouble(start.x);
+            canonical.putDouble(start.y);
+        }
+    }
+    if (hasDock) {
+        canonical.putString("dock");
+        canonical.putDouble(dock.x);
+        canonical.putDouble(dock.y);
+    }
+
+    const std::vector<uint8_t>& bytes = canonical.data();
+    return QCryptographicHash::hash(QByteArray(reinterpret_cast<const char*>(bytes.data()), int(bytes.size())),
+                                    QCryptographicHash::Sha256);
+}
+
 static double clamp(double value, double minVal, double maxVal)
 {
     return std::max(minVal, std::min(maxVal, value));
@@ -188,6 +770,11 @@ bool CollisionSystem::loadFromJson(const QString& filePath)
 
     QJsonObject root = doc.object();
 
+    // Loading a plan replaces whatever was loaded before
+    rooms.clear();
+    doors.clear();
+    obstructions.clear();
+
     // Parse rooms
     QJsonArray roomsArray = root["rooms"].toArray();
     for (const QJsonValue& val : roomsArray) {
@@ -236,11 +823,25 @@ bool CollisionSystem::loadFromJson(const QString& filePath)
         vacuumStart.y = v.value("vacuumY").toDouble();
     }
 
+    // Fleet runs: where the second, third, ... robot starts
+    additionalStarts.clear();
+    for (const QJsonValue& value : root["additional_vacuum_pos"].toArray()) {
+        QJsonObject v = value.toObject();
+        additionalStarts.push_back({v.value("vacuumX").toDouble(), v.value("vacuumY").toDouble()});
+    }
+
+    // Where the vacuum charges; plans without one charge where it starts
+    hasDock = root.contains("dock_pos") && root["dock_pos"].isObject();
+    if (hasDock) {
+        QJsonObject d = root["dock_pos"].toObject();
+        dock = {d.value("dockX").toDouble(), d.value("dockY").toDouble()};
+    }
+
     return true;
 }
 
 // Corrects pos if it overlaps a wall or chest. Returns true if any correction was done.
-bool CollisionSystem::handleCollision(Vector2D& pos, double radius)
+bool CollisionSystem::handleCollision(Vector2D& pos, double radius) const
 {
     // 1) find the room this candidate is in (or just outside)
     const Room2D* room = getCurrentRoom(pos);
@@ -306,13 +907,13 @@ bool CollisionSystem::handleCollision(Vector2D& pos, double radius)
                 // horizontal door at y = d.origin.y, spans x in [origin.x, origin.x+45]
                 if (std::abs(wallPos - d.origin.y) <= tol &&
                     orthPos >= d.origin.x  - tol &&
-                    orthPos <= d.origin.x + 45.0 + tol)
+                    orthPos <= d.origin.x + doorWidth + tol)
                     return true;
             } else {
                 // vertical door at x = d.origin.x, spans y in [origin.y, origin.y+45]
                 if (std::abs(wallPos - d.origin.x) <= tol &&
                     orthPos >= d.origin.y  - tol &&
-                    orthPos <= d.origin.y + 45.0 + tol)
+                    orthPos <= d.origin.y + doorWidth + tol)
                     return true;
             }
         }
@@ -431,28 +1032,62 @@ bool CollisionSystem::handleCollision(Vector2D& pos, double radius)
 
 void Vacuum::updateMovementandTrail(QGraphicsScene* scene)
 {
-    if (batteryLife <= 0 || !vacuumGraphic)
+    tickPath.clear();
+    blockedByRobot = false;
+    bool yieldToRobot = false;
+    if (isFinished() || (scene && !vacuumGraphic))
         return;
 
+    stepEvents = 0;
+    usedRandomFallback = false;
+
     // 1) Pick your full‐target based on the chosen algorithm
     Vector2D fullTarget;
     QString alg = currentAlgorithm.toLower();
-    if (alg == "wall follow") {
+    const bool planning = isPlanningStrategy(alg, strategyParams);
+    if (returnToDock && dockState == DockState::Cleaning && batteryLife <= nextHomeCheck) checkDockReserve();
+    if (dockState == DockState::Returning || dockState == DockState::Resuming) {
+        alg = "dock";
+        fullTarget = moveDock(speed);
+    }
+    else if (strategy.recoveryTicks > 0) {
+        // Walking out of a spot the stuck detector flagged
+        strategy.recoveryTicks--;
+        usedRandomFallback = true;
+        alg = "random";
+        fullTarget = moveRandomly(position, velocity, speed);
+    }
+    else if (!planning && moveToPartition(fullTarget, speed)) {
+        // On the way to its rooms
+    }
+    else if (alg == "wall follow") {
         fullTarget = moveWallFollow(position, velocity, speed);
     }
+    else if (alg == "spiral" && strategyParams.spiral.spotCleaning) {
+        fullTarget = moveSpotClean(position, velocity, speed);
+        if (usedRandomFallback) alg = "random";
+    }
     else if (alg == "spiral") {
         fullTarget = moveSpiral(position, velocity, speed);
     }
     else if (alg == "snaking") {
         const Room2D* room = collisionSystem->getCurrentRoom(position);
         if (room) {
-            snakeLeftBound   = room->topLeft.x;
-            snakeRightBound  = room->bottomRight.x;
-            snakeTopBound    = room->topLeft.y;
-            snakeBottomBound = room->bottomRight.y;
+            strategy.snakeLeftBound   = room->topLeft.x;
+            strategy.snakeRightBound  = room->bottomRight.x;
+            strategy.snakeTopBound    = room->topLeft.y;
+            strategy.snakeBottomBound = room->bottomRight.y;
         }
         fullTarget = moveSnaking(position, velocity, speed);
     }
+    else if (alg == "boustrophedon") {
+        fullTarget = moveBoustrophedon(position, velocity, speed);
+    }
+    else if (alg == "frontier") {
+        fullTarget = moveFrontier(position, velocity, speed);
+        // Out of frontiers it walks at random, bouncing as the random strategy does
+        if (usedRandomFallback) alg = "random";
+    }
     else {
         fullTarget = moveRandomly(position, velocity, speed);
     }
@@ -465,19 +1100,39 @@ void Vacuum::updateMovementandTrail(QGraphicsScene* scene)
     int     steps  = std::max(1, int(std::ceil(dist / radius)));
     Vector2D stepDelta { delta.x / steps, delta.y / steps };
 
-    // 3) Walk those steps, handling collisions at each micro-step
+    // 3) Walk those steps, handling collisions at each micro-step. A vacuum
+    //    wedged in on every side would bounce forever; give up for this tick
+    constexpr int maxBounces = 64;
+    constexpr int giveWayTicks = 10;    // random walk of a robot giving way in a fleet
+    int bounces = 0;
+    const Vector2D start = position;
+    tickPath.push_back(position);
     for (int i = 0; i < steps; ++i)
     {
         Vector2D candidate { position.x + stepDelta.x,
                            position.y + stepDelta.y };
 
         bool hit = collisionSystem->handleCollision(candidate, radius);
+        // Leaving the partition is walking into a wall
+        if (!hit && (!planning || alg == "random") && alg != "dock" && !inPartition(candidate) &&
+            inPartition(position)) {
+            hit = true;
+        }
+        if (!hit && robotIndex) {
+            const int blocker = robotIndex->blocker(position, candidate, radius, robotId);
+            if (blocker >= 0) {
+                hit = true;
+                blockedByRobot = true;
+                yieldToRobot = yieldToRobot || blocker < robotId;
+            }
+        }
         if (hit)
         {
-            if (alg == "random")
+            stepEvents |= TrajectoryCollision;
+            if (alg == "random" && ++bounces <= maxBounces)
             {
                 // -- bounce: pick a new random heading
-                qreal angle = QRandomGenerator::global()->bounded(360.0);
+                qreal angle = rng.nextDouble(360.0);
                 velocity = {
                     std::cos(qDegreesToRadians(angle)),
                     std::sin(qDegreesToRadians(angle))
@@ -497,47 +1152,91 @@ void Vacuum::updateMovementandTrail(QGraphicsScene* scene)
             }
             else
             {
-                // non-random alg: stop stepping on first collision
+                // non-random alg, or out of bounces: stop stepping on first collision
                 break;
             }
         }
 
-        // -- commit this micro-step
+        // -- record the pass in the visit raster, then commit this micro-step
+        visitGrid.stampSegment(position.x, position.y, candidate.x, candidate.y, radius);
         position = candidate;
+        tickPath.push_back(position);
+    }
 
-        // -- draw trail
-        QPointF now(position.x, position.y);
-        QPen pen(QColor(0, 0, 255, vacuumEfficiency));
-        pen.setWidth(12);
-        scene->addLine(QLineF(lastTrailPoint, now), pen);
-        lastTrailPoint = now;
+    // Re-read the frontier squares under everything this tick swept; a
+    // shared raster is not written until the fleet merges the tick
+    if (frontierMap && !sharedCoverage) {
+        const double margin = radius + visitCellSize;
+        frontierMap->update(visitGrid, std::min(start.x, position.x) - margin, std::min(start.y, position.y) - margin,
+                            std::max(start.x, position.x) + margin, std::max(start.y, position.y) + margin);
     }
 
     // 4) Finally, update the graphic and record coverage
-    vacuumGraphic->setPos(position.x, position.y);
-
-    bool add = true;
-    for (auto &pt : cleanedCoords) {
-        if (int(pt.x) >= int(position.x) - 6 &&
-            int(pt.x) <= int(position.x) + 6 &&
-            int(pt.y) >= int(position.y) - 6 &&
-            int(pt.y) <= int(position.y) + 6)
-        {
-            add = false;
-            break;
-        }
+    if (vacuumGraphic)
+        vacuumGraphic->setPos(position.x, position.y);
+
+    cleanedPoints.add(position.x, position.y);
+
+    // Blocked by a lower-numbered robot of a fleet: step aside at random
+    if (yieldToRobot && strategy.recoveryTicks == 0) {
+        qreal angle = rng.nextDouble(360.0);
+        velocity = { std::cos(qDegreesToRadians(angle)), std::sin(qDegreesToRadians(angle)) };
+        strategy.recoveryTicks = giveWayTicks;
     }
-    if (add) {
-        cleanedCoords.append(position);
+
+    if (usedRandomFallback != strategy.inRandomFallback) {
+        stepEvents |= TrajectoryModeSwitch;
+        strategy.inRandomFallback = usedRandomFallback;
     }
 
     batteryLife--;
+    checkStuck();
+}
+
+// Feeds the position to the stuck detector and acts when it fires. A flagged
+// stretch counts as one event however many ticks it lasts.
+void Vacuum::checkStuck()
+{
+    constexpr int recoveryDuration = 10;    // ticks of random walk
+
+    StuckState state = stuckDetector.add(position.x, position.y);
+    if (state == StuckState::Moving) {
+        lastStuckState = state;
+        return;
+    }
+
+    stuckTelemetry.stuckTicks++;
+    if (state != lastStuckState) {
+        if (state == StuckState::Stuck) stuckTelemetry.stuckEvents++;
+        else stuckTelemetry.oscillationEvents++;
+    }
+    lastStuckState = state;
+
+    switch (stuckAction) {
+    case StuckAction::Report:
+        break;
+    case StuckAction::Recover: {
+        stuckTelemetry.recoveries++;
+        qreal angle = rng.nextDouble(360.0);
+        velocity = { std::cos(qDegreesToRadians(angle)), std::sin(qDegreesToRadians(angle)) };
+        strategy.recoveryTicks = recoveryDuration;
+        strategy.spiralRadius = 1.0;
+        strategy.spiralInRandomMode = false;
+        // Let the window refill before judging the new heading
+        stuckDetector.reset();
+        lastStuckState = StuckState::Moving;
+        break;
+    }
+    case StuckAction::Abort:
+        stuckTelemetry.aborted = true;
+        break;
+    }
 }
 
 Vector2D Vacuum::moveRandomly(Vector2D currentPos, Vector2D& velocity, int speed)
 {
     if (velocity.x == 0 && velocity.y == 0) {
-        qreal angle = QRandomGenerator::global()->bounded(360.0);
+        qreal angle = rng.nextDouble(360.0);
         velocity = { std::cos(qDegreesToRadians(angle)), std::sin(qDegreesToRadians(angle)) };
     }
     return currentPos + velocity * speed;
@@ -546,29 +1245,84 @@ Vector2D Vacuum::moveRandomly(Vector2D currentPos, Vector2D& velocity, int speed
 Vector2D Vacuum::moveWallFollow(Vector2D currentPos, Vector2D& velocity, int speed)
 {
     constexpr double vacuumRadius = 6.4;
-    constexpr double rotateStep = M_PI / 12.0;   // 15 degrees
-    constexpr int maxRotations = 24;
-    constexpr int randomChanceOnBlock = 15;      // % chance to switch to Random if blocked
-
-    static double wallFollowAngle = 0.0;
+    const WallFollowParams &params = strategyParams.wallFollow;
+    const double rotateStep = params.rotateStep;
+    const int maxRotations = int(std::ceil(2 * M_PI / rotateStep - 1e-9));   // once round
+    const int randomChanceOnBlock = params.randomChanceOnBlock;  // % chance to switch to Random if blocked
 
     auto isValid = [&](Vector2D pos) {
         return !collisionSystem->handleCollision(pos, vacuumRadius);
     };
 
+    // A fresh run starts at rest; pick a heading as the random walk does
+    if (velocity.x == 0 && velocity.y == 0) {
+        qreal angle = rng.nextDouble(360.0);
+        velocity = { std::cos(qDegreesToRadians(angle)), std::sin(qDegreesToRadians(angle)) };
+    }
+
+    // With a compiled plan, trace the isoline of the wall distance field
+    // traceLevel grid squares out from where the robot would touch: step along it,
+    // steering back towards it in proportion to the drift. Far from any wall
+    // the same rule heads in at 45 degrees. One field lookup per half square.
+    if (compiledPlan && compiledPlan->getGridWidth() > 1) {
+        const double level = params.traceLevel * CompiledPlan::gridCellSize;
+        const double substep = CompiledPlan::gridCellSize / 2.0;
+        // The tick moves in a straight line, so round a corner only as far
+        // as the chord from the start keeps a square clear of the walls
+        auto chordClear = [&](const Vector2D& to) {
+            const int samples = int(std::ceil(std::hypot(to.x - currentPos.x, to.y - currentPos.y) / substep));
+            for (int k = 1; k <= samples; k++) {
+                const double t = double(k) / samples;
+                const Vector2D p = {currentPos.x + (to.x - currentPos.x) * t, currentPos.y + (to.y - currentPos.y) * t};
+                if (compiledPlan->wallDistanceAt(p) < CompiledPlan::gridCellSize) return false;
+            }
+            return true;
+        };
+        Vector2D at = currentPos;
+        Vector2D heading = velocity;
+        Vector2D firstHeading = {0.0, 0.0};
+        bool straight = true;       // the chord is the trace itself
+        for (double left = speed; left > 0; left -= substep) {
+            Vector2D gradient;
+            const double d = compiledPlan->wallDistanceAt(at, &gradient);
+            const double g = std::hypot(gradient.x, gradient.y);
+            if (g > 1e-9) {
+                // Walls kept on the same side, so corners turn the right way
+                const Vector2D away = {gradient.x / g, gradient.y / g};
+                const Vector2D along = {away.y, -away.x};
+                const double pull = std::clamp((d - level) / level, -1.0, 1.0);
+                heading = {along.x - away.x * pull, along.y - away.y * pull};
+                const double len = std::hypot(heading.x, heading.y);
+                heading = {heading.x / len, heading.y / len};
+            }
+            if (left == speed) firstHeading = heading;
+            straight = straight && std::abs(heading.x * firstHeading.y - heading.y * firstHeading.x) < 1e-3;
+            const Vector2D ahead = at + heading * std::min(substep, left);
+            if (!straight && !chordClear(ahead)) break;
+            at = ahead;
+        }
+        Vector2D probe = at;
+        if (!collisionSystem->handleCollision(probe, vacuumRadius)) {
+            velocity = heading;
+            strategy.wallFollowAngle = std::atan2(velocity.y, velocity.x);
+            return at;
+        }
+    }
+
     // Step 1: Try current direction
     Vector2D next = { currentPos.x + velocity.x * speed, currentPos.y + velocity.y * speed };
     if (isValid(next)) {
-        wallFollowAngle = std::atan2(velocity.y, velocity.x);
+        strategy.wallFollowAngle = std::atan2(velocity.y, velocity.x);
         return next;
     }
 
     // Step 2: Rotate left/right to find alternative path
+    stepEvents |= TrajectoryCollision;
     for (int i = 0; i < maxRotations; ++i) {
-        wallFollowAngle += rotateStep;
-        if (wallFollowAngle > 2 * M_PI) wallFollowAngle -= 2 * M_PI;
+        strategy.wallFollowAngle += rotateStep;
+        if (strategy.wallFollowAngle > 2 * M_PI) strategy.wallFollowAngle -= 2 * M_PI;
 
-        Vector2D tryVel = { std::cos(wallFollowAngle), std::sin(wallFollowAngle) };
+        Vector2D tryVel = { std::cos(strategy.wallFollowAngle), std::sin(strategy.wallFollowAngle) };
         Vector2D tryNext = { currentPos.x + tryVel.x * speed, currentPos.y + tryVel.y * speed };
 
         if (isValid(tryNext)) {
@@ -581,7 +1335,8 @@ Vector2D Vacuum::moveWallFollow(Vector2D currentPos, Vector2D& velocity, int spe
     }
 
     // Step 3: Still blocked — inject random with chance
-    if (QRandomGenerator::global()->bounded(100) < randomChanceOnBlock) {
+    if (int(rng.nextInt(100)) < randomChanceOnBlock) {
+        usedRandomFallback = true;
         return moveRandomly(currentPos, velocity, speed);
     }
 
@@ -594,23 +1349,23 @@ Vector2D Vacuum::moveWallFollow(Vector2D currentPos, Vector2D& velocity, int spe
 Vector2D Vacuum::moveSpiral(Vector2D currentPos, Vector2D& velocity, int speed)
 {
     constexpr double vacuumRadius = 6.4;
-    constexpr double angleIncrement = 0.07;
-    constexpr double radiusGrowthRate = 0.03;
+    const SpiralParams &params = strategyParams.spiral;
+    const double angleIncrement = params.angleIncrement;
+    const double radiusGrowthRate = params.radiusGrowthRate;
     constexpr double minDistanceFromWall = 18.0;
-    constexpr double maxSpiralRadius = 60.0;
+    const double maxSpiralRadius = params.maxSpiralRadius;
     constexpr int randomFallbackFrames = 5;
-    constexpr int randomTriggerChance = 20; // % chance spiral *actually* switches when blocked
-
-    static bool spiralInRandomMode = false;
-    static int spiralRandomCooldown = 0;
+    const int randomTriggerChance = params.randomTriggerChance; // % chance spiral *actually* switches when blocked
 
     // Step 1: Check if we should still be in fallback random mode
-    if (spiralInRandomMode) {
-        spiralRandomCooldown--;
-        if (spiralRandomCooldown <= 0)
-            spiralInRandomMode = false;
-        else
+    if (strategy.spiralInRandomMode) {
+        strategy.spiralRandomCooldown--;
+        if (strategy.spiralRandomCooldown <= 0)
+            strategy.spiralInRandomMode = false;
+        else {
+            usedRandomFallback = true;
             return moveRandomly(currentPos, velocity, speed); // 🔁 TEMP switch
+        }
     }
 
     // Step 2: Proximity probe (are we near a wall?)
@@ -630,23 +1385,24 @@ Vector2D Vacuum::moveSpiral(Vector2D currentPos, Vector2D& velocity, int speed)
     };
 
     // Step 3: Rarely trigger fallback random if too close
-    if (tooCloseToWall() && QRandomGenerator::global()->bounded(100) < randomTriggerChance) {
-        spiralInRandomMode = true;
-        spiralRandomCooldown = randomFallbackFrames;
+    if (tooCloseToWall() && int(rng.nextInt(100)) < randomTriggerChance) {
+        strategy.spiralInRandomMode = true;
+        strategy.spiralRandomCooldown = randomFallbackFrames;
+        usedRandomFallback = true;
         return moveRandomly(currentPos, velocity, speed);
     }
 
     // Step 4: Continue normal spiral
-    spiralAngle += angleIncrement;
-    spiralRadius += radiusGrowthRate;
+    strategy.spiralAngle += angleIncrement;
+    strategy.spiralRadius += radiusGrowthRate;
 
-    if (maxSpiralRadius > maxSpiralRadius) {
-        spiralRadius = 1.0;
-        spiralAngle = 0.0;
+    if (strategy.spiralRadius > maxSpiralRadius) {
+        strategy.spiralRadius = 1.0;
+        strategy.spiralAngle = 0.0;
     }
 
-    double dx = std::cos(spiralAngle) * spiralRadius;
-    double dy = std::sin(spiralAngle) * spiralRadius;
+    double dx = std::cos(strategy.spiralAngle) * strategy.spiralRadius;
+    double dy = std::sin(strategy.spiralAngle) * strategy.spiralRadius;
     Vector2D next = { currentPos.x + dx, currentPos.y + dy };
 
     auto isValid = [&](Vector2D pos) {
@@ -654,14 +1410,15 @@ Vector2D Vacuum::moveSpiral(Vector2D currentPos, Vector2D& velocity, int speed)
     };
 
     if (!isValid(next)) {
+        stepEvents |= TrajectoryCollision;
         // Slight bounce
-        spiralAngle += (std::rand() % 60 - 30) * (M_PI / 180.0);
-        dx = std::cos(spiralAngle) * spiralRadius;
-        dy = std::sin(spiralAngle) * spiralRadius;
+        strategy.spiralAngle += (int(rng.nextInt(60)) - 30) * (M_PI / 180.0);
+        dx = std::cos(strategy.spiralAngle) * strategy.spiralRadius;
+        dy = std::sin(strategy.spiralAngle) * strategy.spiralRadius;
         next = { currentPos.x + dx, currentPos.y + dy };
 
         if (!isValid(next)) {
-            spiralRadius = std::max(1.0, spiralRadius - 0.5);
+            strategy.spiralRadius = std::max(1.0, strategy.spiralRadius - 0.5);
             return currentPos;
         }
     }
@@ -679,10 +1436,13 @@ Vector2D Vacuum::moveSnaking(Vector2D currentPos, Vector2D& velocity, int speed)
     constexpr double shiftDistance = (vacuumRadius * 2) - 1;
 
     // Fallback to random mode if too close to room bounds (avoid being stuck)
-    bool nearWall = currentPos.x - snakeLeftBound < 10 || snakeRightBound - currentPos.x < 10 ||
-                    currentPos.y - snakeTopBound < 10 || snakeBottomBound - currentPos.y < 10;
+    const SnakingParams &params = strategyParams.snaking;
+    const double nearDistance = params.nearWallDistance;
+    bool nearWall = currentPos.x - strategy.snakeLeftBound < nearDistance || strategy.snakeRightBound - currentPos.x < nearDistance ||
+                    currentPos.y - strategy.snakeTopBound < nearDistance || strategy.snakeBottomBound - currentPos.y < nearDistance;
 
-    if (nearWall && QRandomGenerator::global()->bounded(100) < 10) {
+    if (nearWall && int(rng.nextInt(100)) < params.nearWallRandomChance) {
+        usedRandomFallback = true;
         return moveRandomly(currentPos, velocity, speed);
     }
 
@@ -690,53 +1450,296 @@ Vector2D Vacuum::moveSnaking(Vector2D currentPos, Vector2D& velocity, int speed)
     Vector2D next = { currentPos.x + velocity.x * speed, currentPos.y + velocity.y * speed };
 
     // Horizontal boundary check
-    if (!movingUpward) {
-        if (movingRight && (next.x + vacuumRadius) >= snakeRightBound) {
-            movingRight = false;
-            next.x = snakeRightBound - vacuumRadius;
+    if (!strategy.movingUpward) {
+        if (strategy.movingRight && (next.x + vacuumRadius) >= strategy.snakeRightBound) {
+            strategy.movingRight = false;
+            next.x = strategy.snakeRightBound - vacuumRadius;
             next.y = currentPos.y + shiftDistance;
-        } else if (!movingRight && (next.x - vacuumRadius) <= snakeLeftBound) {
-            movingRight = true;
-            next.x = snakeLeftBound + vacuumRadius;
+        } else if (!strategy.movingRight && (next.x - vacuumRadius) <= strategy.snakeLeftBound) {
+            strategy.movingRight = true;
+            next.x = strategy.snakeLeftBound + vacuumRadius;
             next.y = currentPos.y + shiftDistance;
         }
 
-        if ((next.y + vacuumRadius) >= snakeBottomBound) {
-            next.y = snakeBottomBound - vacuumRadius;
-            movingUpward = true;
+        if ((next.y + vacuumRadius) >= strategy.snakeBottomBound) {
+            next.y = strategy.snakeBottomBound - vacuumRadius;
+            strategy.movingUpward = true;
         }
 
-        velocity = { movingRight ? 1.0 : -1.0, 0.0 };
+        velocity = { strategy.movingRight ? 1.0 : -1.0, 0.0 };
     } else {
-        if (movingRight && (next.x + vacuumRadius) >= snakeRightBound) {
-            movingRight = false;
-            next.x = snakeRightBound - vacuumRadius;
+        if (strategy.movingRight && (next.x + vacuumRadius) >= strategy.snakeRightBound) {
+            strategy.movingRight = false;
+            next.x = strategy.snakeRightBound - vacuumRadius;
             next.y = currentPos.y - shiftDistance;
-        } else if (!movingRight && (next.x - vacuumRadius) <= snakeLeftBound) {
-            movingRight = true;
-            next.x = snakeLeftBound + vacuumRadius;
+        } else if (!strategy.movingRight && (next.x - vacuumRadius) <= strategy.snakeLeftBound) {
+            strategy.movingRight = true;
+            next.x = strategy.snakeLeftBound + vacuumRadius;
             next.y = currentPos.y - shiftDistance;
         }
 
-        if ((next.y - vacuumRadius) <= snakeTopBound) {
-            next.y = snakeTopBound + vacuumRadius;
-            movingUpward = false;
+        if ((next.y - vacuumRadius) <= strategy.snakeTopBound) {
+            next.y = strategy.snakeTopBound + vacuumRadius;
+            strategy.movingUpward = false;
         }
 
-        velocity = { movingRight ? 1.0 : -1.0, 0.0 };
+        velocity = { strategy.movingRight ? 1.0 : -1.0, 0.0 };
     }
 
     // Clamp within room bounds
-    next.x = std::clamp(next.x, snakeLeftBound + vacuumRadius, snakeRightBound - vacuumRadius);
-    next.y = std::clamp(next.y, snakeTopBound + vacuumRadius, snakeBottomBound - vacuumRadius);
+    next.x = std::clamp(next.x, strategy.snakeLeftBound + vacuumRadius, strategy.snakeRightBound - vacuumRadius);
+    next.y = std::clamp(next.y, strategy.snakeTopBound + vacuumRadius, strategy.snakeBottomBound - vacuumRadius);
 
     // ✅ Check for collision
     if (collisionSystem->handleCollision(next, vacuumRadius)) {
         // If collision, fallback to random pathing temporarily
-        qreal angle = QRandomGenerator::global()->bounded(360.0);
+        stepEvents |= TrajectoryCollision;
+        usedRandomFallback = true;
+        qreal angle = rng.nextDouble(360.0);
         velocity = { std::cos(qDegreesToRadians(angle)), std::sin(qDegreesToRadians(angle)) };
         return moveRandomly(currentPos, velocity, speed);
     }
 
     return next;
 }
+
+// Follows the lane route the compiled plan lays over every room. The route
+// is planned once from where the robot stands; when it is done a new one
+// starts from the finishing point.
+Vector2D Vacuum::moveBoustrophedon(Vector2D currentPos, Vector2D& velocity, int speed)
+{
+    if (!compiledPlan || compiledPlan->getCells().empty()) {
+        usedRandomFallback = true;
+        return moveRandomly(currentPos, velocity, speed);
+    }
+
+    if (strategy.routeIndex < 0) {
+        strategy.routeIndex = 0;
+        strategy.routeStart = currentPos;
+    }
+    // Restored or forked state may refer to a route this vacuum has not built
+    if (!coverageRoute || coverageRouteStart.x != strategy.routeStart.x ||
+        coverageRouteStart.y != strategy.routeStart.y) {
+        // Rooms in the order of the shortest tour from the starting room
+        const int startRoom = compiledPlan->roomAt(strategy.routeStart);
+        if (partitionRooms.empty()) {
+            std::vector<int> rooms(compiledPlan->getRooms().size());
+            for (size_t r = 0; r < rooms.size(); r++) rooms[r] = int(r);
+            coverageRoute = std::make_shared<const std::vector<RouteWaypoint>>(compiledPlan->boustrophedonRoute(
+                strategy.routeStart, diameter - 1.0, roomGraph->tour(startRoom, rooms)));
+        } else {
+            std::vector<int> order;
+            if (startRoom >= 0 && partitionMask[startRoom]) order.push_back(startRoom);
+            for (int room : roomGraph->tour(startRoom, partitionRooms)) order.push_back(room);
+            if (startRoom < 0) order = partitionRooms;
+            coverageRoute = std::make_shared<const std::vector<RouteWaypoint>>(compiledPlan->boustrophedonRoute(
+                strategy.routeStart, diameter - 1.0, order, true));
+        }
+        coverageRouteStart = strategy.routeStart;
+    }
+    const std::vector<RouteWaypoint>& route = *coverageRoute;
+
+    // Spend the tick's distance along the route. Turning a waypoint within
+    // one tick cuts the corner, which is only safe when both legs lie in
+    // the same (convex) cell.
+    double budget = speed;
+    Vector2D next = currentPos;
+    while (strategy.routeIndex < int(route.size())) {
+        const RouteWaypoint& waypoint = route[strategy.routeIndex];
+        const double dx = waypoint.position.x - next.x;
+        const double dy = waypoint.position.y - next.y;
+        const double dist = std::hypot(dx, dy);
+        if (dist > budget) {
+            next = {next.x + dx * budget / dist, next.y + dy * budget / dist};
+            break;
+        }
+        next = waypoint.position;
+        budget -= dist;
+        strategy.routeIndex++;
+        if (waypoint.cell < 0 || strategy.routeIndex >= int(route.size()) ||
+            route[strategy.routeIndex].cell != waypoint.cell) {
+            break;
+        }
+    }
+    if (strategy.routeIndex >= int(route.size())) strategy.routeIndex = -1;
+
+    const double len = std::hypot(next.x - currentPos.x, next.y - currentPos.y);
+    if (len > 0) velocity = {(next.x - currentPos.x) / len, (next.y - currentPos.y) / len};
+    return next;
+}
+
+// Heads for the nearest frontier between covered and uncovered floor, then
+// sweeps a lane of the uncovered side. Keeps a target until it is reached
+// or swept on the way there.
+Vector2D Vacuum::moveFrontier(Vector2D currentPos, Vector2D& velocity, int speed)
+{
+    const double laneLength = 120.0;
+
+    if (compiledPlan && !frontierMap) {
+        frontierMap = std::make_shared<FrontierMap>(compiledPlan);
+        frontierMap->rebuild(coverage());
+    }
+
+    Vector2D next;
+    if (frontierMap) {
+        const int square = strategy.navIndex >= 0 ? compiledPlan->gridIndex(strategy.navTarget) : -1;
+        Vector2D target = strategy.navTarget;
+        int frontier = 0;
+        if (square < 0 || frontierMap->isCovered(square)) {
+            frontier = frontierMap->nearest(currentPos, roomGraph.get(), partitionMask.empty() ? nullptr : &partitionMask);
+            if (frontier >= 0) target = frontierMap->target(frontier, laneLength);
+        }
+        if (frontier >= 0 && navigateTo(target, next, speed) != NavStatus::Unreachable) {
+            const double len = std::hypot(next.x - currentPos.x, next.y - currentPos.y);
+            if (len > 0) velocity = {(next.x - currentPos.x) / len, (next.y - currentPos.y) / len};
+            return next;
+        }
+    }
+
+    // No plan, nothing left to explore from here, or no way to the frontier
+    strategy.navIndex = -1;
+    usedRandomFallback = true;
+    return moveRandomly(currentPos, velocity, speed);
+}
+
+// Picks the worst under-cleaned pocket, walks to its centre and winds an
+// Archimedean spiral out from there, a lane apart and speed along the curve
+// per tick, until the spot radius. The pocket map is summed afresh for each
+// pick from the frontier map's covered squares; a pocket whose centre is
+// swept on the way there is dropped for the next one.
+Vector2D Vacuum::moveSpotClean(Vector2D currentPos, Vector2D& velocity, int speed)
+{
+    const double maxRadius = strategyParams.spiral.maxSpiralRadius;
+
+    if (compiledPlan && !frontierMap) {
+        frontierMap = std::make_shared<FrontierMap>(compiledPlan);
+        frontierMap->rebuild(coverage());
+    }
+
+    // Another robot of a fleet may sweep the pocket's centre first
+    if (frontierMap && strategy.spotRadius > 0.0 && !strategy.spotSpiraling &&
+        frontierMap->isCovered(compiledPlan->gridIndex(strategy.spotCentre))) {
+        strategy.spotRadius = 0.0;
+    }
+
+    Vector2D next = currentPos;
+    if (frontierMap && strategy.spotRadius <= 0.0) {
+        const PocketMap pockets(*frontierMap);
+        const int pocket = pockets.worst(currentPos, maxRadius, partitionMask.empty() ? nullptr : &partitionMask);
+        if (pocket >= 0) {
+            strategy.spotCentre = compiledPlan->gridCentre(pocket);
+            // A pocket in a gap narrower than a lane is cleaned by getting there
+            strategy.spotRadius = std::max(pockets.spotRadius(pocket, maxRadius), 1e-6);
+            strategy.spotSpiraling = false;
+        }
+    }
+
+    if (frontierMap && strategy.spotRadius > 0.0) {
+        bool moved = false;
+        if (!strategy.spotSpiraling) {
+            switch (navigateTo(strategy.spotCentre, next, speed)) {
+            case NavStatus::Moving:
+                moved = true;
+                break;
+            case NavStatus::Arrived:
+                strategy.spotSpiraling = true;
+                strategy.spiralAngle = 0.0;
+                moved = true;
+                break;
+            case NavStatus::Unreachable:
+                break;
+            }
+        }
+        else {
+            // r = a * angle puts successive turns a lane apart; an arc of
+            // speed turns the angle by speed / sqrt(r^2 + a^2)
+            const double lane = PocketMap::laneSpacing(*compiledPlan);
+            const double a = lane / (2.0 * M_PI);
+            const Vector2D& centre = strategy.spotCentre;
+            const double was = a * strategy.spiralAngle;
+            const Vector2D expected = {centre.x + std::cos(strategy.spiralAngle) * was,
+                                       centre.y + std::sin(strategy.spiralAngle) * was};
+            strategy.spiralAngle += speed / std::hypot(was, a);
+            const double r = a * strategy.spiralAngle;
+            next = {centre.x + std::cos(strategy.spiralAngle) * r, centre.y + std::sin(strategy.spiralAngle) * r};
+            // Done at the spot radius, or knocked off the curve by a
+            // collision or another robot
+            moved = r <= strategy.spotRadius &&
+                    std::hypot(currentPos.x - expected.x, currentPos.y - expected.y) <= lane &&
+                    !collisionSystem->handleCollision(next, compiledPlan->getRobotRadius());
+            if (!moved) {
+                strategy.spotRadius = 0.0;
+                strategy.spotSpiraling = false;
+                return moveSpotClean(currentPos, velocity, speed);
+            }
+        }
+        if (moved) {
+            const double len = std::hypot(next.x - currentPos.x, next.y - currentPos.y);
+            if (len > 0) velocity = {(next.x - currentPos.x) / len, (next.y - currentPos.y) / len};
+            return next;
+        }
+    }
+
+    // No plan, every pocket clean, or no way to the one picked
+    strategy.spotRadius = 0.0;
+    strategy.spotSpiraling = false;
+    strategy.navIndex = -1;
+    usedRandomFallback = true;
+    return moveRandomly(currentPos, velocity, speed);
+}
+
+PathPlanner& Vacuum::getPathPlanner()
+{
+    if (!pathPlanner) pathPlanner = std::make_shared<PathPlanner>(compiledPlan);
+    return *pathPlanner;
+}
+
+NavStatus Vacuum::navigateTo(const Vector2D& target, Vector2D& next, int speed)
+{
+    next = position;
+    if (!compiledPlan) return NavStatus::Unreachable;
+
+    if (strategy.navIndex < 0 || strategy.navTarget.x != target.x || strategy.navTarget.y != target.y) {
+        strategy.navIndex = 0;
+        strategy.navStart = position;
+        strategy.navTarget = target;
+    }
+    // Restored or forked state may refer to a path this vacuum has not planned
+    if (!navPath || navPathStart.x != strategy.navStart.x || navPathStart.y != strategy.navStart.y ||
+        navPathTarget.x != strategy.navTarget.x || navPathTarget.y != strategy.navTarget.y) {
+        std::vector<Vector2D> path;
+        if (!getPathPlanner().findPath(strategy.navStart, strategy.navTarget, path)) {
+            strategy.navIndex = -1;
+            navPath.reset();
+            return NavStatus::Unreachable;
+        }
+        navPath = std::make_shared<const std::vector<Vector2D>>(std::move(path));
+        navPathStart = strategy.navStart;
+        navPathTarget = strategy.navTarget;
+    }
+    const std::vector<Vector2D>& path = *navPath;
+
+    // Round a waypoint within the tick only while the straight line from
+    // here stays in free space
+    double budget = speed;
+    bool turned = false;
+    while (strategy.navIndex < int(path.size())) {
+        const Vector2D& waypoint = path[strategy.navIndex];
+        const double dx = waypoint.x - next.x;
+        const double dy = waypoint.y - next.y;
+        const double dist = std::hypot(dx, dy);
+        const Vector2D ahead = dist > budget ? Vector2D{next.x + dx * budget / dist, next.y + dy * budget / dist}
+                                             : waypoint;
+        if (turned && !getPathPlanner().lineOfSight(position, ahead)) break;
+        next = ahead;
+        if (dist > budget) break;
+        budget -= dist;
+        strategy.navIndex++;
+        turned = true;
+    }
+    if (strategy.navIndex >= int(path.size())) {
+        strategy.navIndex = -1;
+        return NavStatus::Arrived;
+    }
+    return NavStatus::Moving;
+}
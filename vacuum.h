@@ -6,8 +6,17 @@
 #include <QPointF>
 #include <QBrush>
 #include <QString>
+#include <QByteArray>
 #include <QtMath>
 
+#include <memory>
+
+#include "visitgrid.h"
+#include "rng.h"
+#include "cleanedpoints.h"
+#include "stuckdetector.h"
+#include "strategyparams.h"
+
 struct Vector2D {
     double x;
     double y;
@@ -45,24 +54,109 @@ struct Obstruction2D
 class CollisionSystem
 {
 public:
+    static constexpr double doorWidth = 45.0;   // gap a door leaves along its wall
+
     bool loadFromJson(const QString& filePath);
-    bool handleCollision(Vector2D& position, double radius);
+    bool handleCollision(Vector2D& position, double radius) const;
     const Room2D* getCurrentRoom(const Vector2D& pos) const;
+    bool getBounds(Vector2D& topLeft, Vector2D& bottomRight) const;
+    // SHA-256 of the loaded geometry, independent of JSON formatting and of
+    // fields the simulation never reads
+    QByteArray getPlanHash() const;
 
     Vector2D getVacuumStartPosition() const;
+    // Starts of a second and further robots ("additional_vacuum_pos"), in order
+    const std::vector<Vector2D>& getAdditionalStartPositions() const { return additionalStarts; }
+    // The charging dock ("dock_pos"); the start position when the plan has none
+    Vector2D getDockPosition() const { return hasDock ? dock : vacuumStart; }
+    bool hasDockPosition() const { return hasDock; }
+    const std::vector<Room2D>& getRooms() const { return rooms; }
+    const std::vector<Door2D>& getDoors() const { return doors; }
+    const std::vector<Obstruction2D>& getObstructions() const { return obstructions; }
 
 private:
     std::vector<Room2D> rooms;
     std::vector<Door2D> doors;
     Vector2D vacuumStart = {67.0, 192.0};
+    std::vector<Vector2D> additionalStarts;
+    bool hasDock = false;
+    Vector2D dock = {0.0, 0.0};
     std::vector<Obstruction2D> obstructions;
 };
 
+// Everything the movement strategies carry from one tick to the next.
+// Kept in one place so it can be snapshotted into trajectory keyframes.
+struct StrategyState
+{
+    double spiralAngle = 0.0;
+    double spiralRadius = 1.0;
+    bool spiralInRandomMode = false;
+    int spiralRandomCooldown = 0;
+
+    double wallFollowAngle = 0.0;
+
+    bool movingRight = true;
+    bool movingDown = true;
+    bool movingUpward = false;
+    double snakeLeftBound = 0.0;
+    double snakeRightBound = 0.0;
+    double snakeTopBound = 0.0;
+    double snakeBottomBound = 0.0;
+
+    int routeIndex = -1;           // next boustrophedon waypoint, -1 before planning
+    Vector2D routeStart = {0.0, 0.0};  // where the current route was planned from
+
+    double spotRadius = 0.0;       // of the pocket being spot cleaned, 0 before one is picked
+    Vector2D spotCentre = {0.0, 0.0};
+    bool spotSpiraling = false;    // at the pocket, spiralAngle winding out from its centre
+
+    int navIndex = -1;             // next navigateTo waypoint, -1 when not navigating
+    Vector2D navStart = {0.0, 0.0};
+    Vector2D navTarget = {0.0, 0.0};
+
+    int partitionRoom = -1;        // room a robot outside its partition heads for, -1 until picked
+
+    bool inRandomFallback = false; // last tick was driven by the random fallback
+    int recoveryTicks = 0;         // random walk left after a stuck recovery or giving way
+};
+
+class CompiledPlan;
+class PathPlanner;
+class RobotIndex;
+class FrontierMap;
+class RoomGraph;
+struct RouteWaypoint;
+
+enum class NavStatus
+{
+    Moving,
+    Arrived,        // the returned position is the target
+    Unreachable     // no free path; the vacuum stays put
+};
+
+// Where a vacuum that returns to its dock is in its charge cycle
+enum class DockState : uint8_t
+{
+    Cleaning,
+    Returning,      // heading home on the reserve
+    Docked,         // home; finished until undock()
+    Resuming        // back from the dock to where it broke off
+};
+
+// A vacuum bound to a scene draws itself there. Constructed with a null
+// scene it runs headless, which is how the ensemble runner steps it on
+// worker threads.
 class Vacuum
 {
 public:
     Vacuum(QGraphicsScene* scene);
-    
+    ~Vacuum();
+
+    // A headless copy of this vacuum mid-run, sharing the plan and every
+    // raster tile until one of the two writes to it; stepping the copy
+    // continues the run exactly as stepping the original would
+    std::unique_ptr<Vacuum> fork() const;
+
     // Setters
     void setBatteryLife(int minutes);
     void setVacuumEfficiency(int vacuumEff);
@@ -71,6 +165,41 @@ public:
     void setPathingAlgorithm(const QString &algorithm);
     void setVacuumPosition(Vector2D& position);
     void setHousePath(QString& path);
+    void setSeed(uint64_t seed);
+    void setStuckAction(StuckAction action);
+    void setStrategyParams(const StrategyParams &params);
+    // Where reset() puts the vacuum: the plan's vacuum_pos until set, and
+    // again once another plan is loaded
+    void setStartPosition(const Vector2D &start);
+
+    // Fleet runs (fleet.h). With a shared coverage raster the strategies
+    // read it instead of the vacuum's own passes, and the vacuum leaves
+    // refreshing what it derives from it to refreshCoverage(). With a robot
+    // index, the other robots block moves as walls do.
+    void setSharedCoverage(const VisitGrid *coverage);
+    void setRobotIndex(const RobotIndex *index, int id);
+    void refreshCoverage(double left, double top, double right, double bottom);
+    // Where the head went during the last tick, its start first
+    const std::vector<Vector2D> &getTickPath() const;
+    // Another robot blocked the last tick's move
+    bool wasBlockedByRobot() const;
+    // Rooms to clean (partitioner.h); empty for the whole plan. The
+    // heuristic strategies walk there first and then treat doorways out of
+    // them as walls; the planning strategies (isPlanningStrategy) cross
+    // other rooms on the way but clean only these. Rooms the plan does not
+    // have are ignored. Cleared when another plan is loaded.
+    void setRoomPartition(const std::vector<int> &rooms);
+    const std::vector<int> &getRoomPartition() const;
+
+    // Return to dock: keep the battery the planner's way home takes plus
+    // reserveSeconds, and head home when it runs down to that. Docked
+    // counts as finished. Off by default; reset() keeps the setting.
+    void setReturnToDock(bool enabled, int reserveSeconds = 60);
+    bool getReturnToDock() const;
+    DockState getDockState() const;
+    // Leaves the dock on the battery set since (setBatteryLife), goes back
+    // to where the vacuum broke off and lets its strategy carry on there
+    void undock();
 
     // Getters
     int getBatteryLife() const;
@@ -78,10 +207,39 @@ public:
     int getWhiskerEfficiency() const;
     int getSpeed() const;
     QString getPathingAlgorithm() const;
+    QString getHousePath() const;
     QGraphicsEllipseItem* getGraphic() const;
     const Vector2D &getPosition() const;
     Vector2D& getVelocity() const;
     double getCoveredArea() const;
+    const VisitGrid& getVisitGrid() const;
+    QByteArray getPlanHash() const;
+    uint8_t getStepEvents() const;
+    uint64_t getSeed() const;
+    StuckAction getStuckAction() const;
+    const StrategyParams &getStrategyParams() const;
+    const StuckTelemetry &getStuckTelemetry() const;
+    const CollisionSystem& getCollisionSystem() const;
+    // Null until a plan is loaded
+    const CompiledPlan* getCompiledPlan() const;
+    const RoomGraph* getRoomGraph() const;
+    // Battery empty, docked, or the run was aborted by the stuck detector
+    bool isFinished() const;
+    // Strategies that plan their way across the plan rather than react to
+    // what they bump into: boustrophedon, frontier and spot cleaning
+    static bool isPlanningStrategy(const QString &algorithm, const StrategyParams &params);
+
+    // Strategy snapshot for trajectory keyframes
+    std::vector<uint8_t> saveStrategyState() const;
+    bool restoreStrategyState(const std::vector<uint8_t>& bytes);
+
+    // Everything a run carries from one tick to the next: settings, battery,
+    // motion, strategy and generator state, stuck detector and both coverage
+    // rasters, compressed. Restoring onto a vacuum with the same plan loaded
+    // continues the run bit for bit; a checkpoint taken on another plan, or a
+    // damaged one, is rejected and leaves the vacuum untouched.
+    QByteArray saveCheckpoint() const;
+    bool restoreCheckpoint(const QByteArray& checkpoint);
 
     // Movement
     void updateMovementandTrail(QGraphicsScene* scene);
@@ -90,6 +248,18 @@ public:
     Vector2D moveWallFollow(Vector2D currentPos, Vector2D& velocity, int speed);
     Vector2D moveSpiral(Vector2D currentPos, Vector2D& velocity, int speed);
     Vector2D moveSnaking(Vector2D currentPos, Vector2D& velocity, int speed);
+    Vector2D moveBoustrophedon(Vector2D currentPos, Vector2D& velocity, int speed);
+    Vector2D moveFrontier(Vector2D currentPos, Vector2D& velocity, int speed);
+    // Spiral with spot cleaning: heads for the worst under-cleaned pocket
+    // (pocketmap.h) and spirals out over it, then picks the next one
+    Vector2D moveSpotClean(Vector2D currentPos, Vector2D& velocity, int speed);
+    // Plans a free-space path to target on the first call for it, then
+    // advances along it by speed per call; next is this tick's position
+    NavStatus navigateTo(const Vector2D& target, Vector2D& next, int speed);
+    PathPlanner& getPathPlanner();
+    void checkStuck();
+    void checkDockReserve();
+    Vector2D moveDock(int speed);
 
     QMap<QString, int> visitCount;
 private:
@@ -103,33 +273,73 @@ private:
     int whiskerEfficiency;
     int speed;
     QString currentAlgorithm;
+    StrategyParams strategyParams;
 
     QString housePath;
 
-    QGraphicsEllipseItem *vacuumGraphic;
+    QGraphicsEllipseItem *vacuumGraphic = nullptr;
 
     Vector2D position;
     Vector2D nextPosition;
     Vector2D velocity;
-    CollisionSystem* collisionSystem;
+    std::shared_ptr<CollisionSystem> collisionSystem;  // shared with forks
+    std::shared_ptr<const CompiledPlan> compiledPlan;  // built with the plan, shared with forks
+    std::shared_ptr<const RoomGraph> roomGraph;         // likewise
+    // The boustrophedon route planned from strategy.routeStart
+    std::shared_ptr<const std::vector<RouteWaypoint>> coverageRoute;
+    Vector2D coverageRouteStart = {0.0, 0.0};
+    // Per vacuum, not shared: it holds search scratch and its cache
+    std::shared_ptr<PathPlanner> pathPlanner;
+    // The path planned from strategy.navStart to strategy.navTarget
+    std::shared_ptr<const std::vector<Vector2D>> navPath;
+    Vector2D navPathStart = {0.0, 0.0};
+    Vector2D navPathTarget = {0.0, 0.0};
+    // Coverage frontiers, built on the first frontier tick and updated after
+    // every tick from then on; rebuilt from visitGrid whenever dropped
+    std::shared_ptr<FrontierMap> frontierMap;
 
     double coveredArea = 0.0;
-    double spiralAngle = 0.0;
-    double spiralRadius = 1.0;
-    bool movingRight = true;
-    bool movingDown = true;
-    bool movingUpward = false;
+    StrategyState strategy;
 
-    double snakeLeftBound = 0.0;
-    double snakeRightBound = 0.0;
-    double snakeTopBound = 0.0;
-    double snakeBottomBound = 0.0;
+    uint8_t stepEvents = 0;     // TrajectoryFlag bits raised during the last tick
+    uint64_t seed = 0;
+    Rng rng;
+    bool usedRandomFallback = false;
 
     QGraphicsScene* scene;
 
-    QList<Vector2D> cleanedCoords;
-    QPointF lastTrailPoint;
+    bool hasStartPosition = false;
+    Vector2D startPosition = {0.0, 0.0};
+    const VisitGrid* sharedCoverage = nullptr;
+    const RobotIndex* robotIndex = nullptr;
+    int robotId = 0;
+    std::vector<Vector2D> tickPath;
+    bool blockedByRobot = false;
+    std::vector<int> partitionRooms;
+    std::vector<char> partitionMask;    // a flag per room of the plan
+    // In a partition room, or in none; always without a partition
+    bool inPartition(const Vector2D& pos) const;
+    bool moveToPartition(Vector2D& next, int speed);
+    // What the strategies read as covered
+    const VisitGrid& coverage() const { return sharedCoverage ? *sharedCoverage : visitGrid; }
+
+    StuckDetector stuckDetector;
+    StuckAction stuckAction = StuckAction::Report;
+    StuckState lastStuckState = StuckState::Moving;
+    StuckTelemetry stuckTelemetry;
+
+    bool returnToDock = false;
+    int dockReserve = 60;               // seconds of battery over the way home
+    DockState dockState = DockState::Cleaning;
+    int nextHomeCheck = 0;              // battery left at the next look at the way home
+    Vector2D resumeAt = {0.0, 0.0};     // where the vacuum broke off for the dock
+    Vector2D resumeVelocity = {0.0, 0.0};
+
+    CleanedPoints cleanedPoints;
+    VisitGrid visitGrid;
+    const double visitCellSize = 1.0;
 
+    Vacuum(const Vacuum&) = default;    // through fork()
 };
 
 #endif // VACUUM_H
@@ -0,0 +1,278 @@
+#include "visitgrid.h"
+#include "bytestream.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+VisitGrid::VisitGrid() {}
+
+void VisitGrid::reset(double left, double top, double right, double bottom, double size)
+{
+    cellSize = size > 0.0 ? size : 1.0;
+    originX = std::min(left, right);
+    originY = std::min(top, bottom);
+    width  = std::max(1, int(std::ceil(std::abs(right - left) / cellSize)));
+    height = std::max(1, int(std::ceil(std::abs(bottom - top) / cellSize)));
+    counts.resize(width, height);
+    maxCount = 0;
+    visitedCells = 0;
+    revisitedCells = 0;
+}
+
+void VisitGrid::clear()
+{
+    counts.clear();
+    maxCount = 0;
+    visitedCells = 0;
+    revisitedCells = 0;
+}
+
+uint16_t VisitGrid::getCountAt(double x, double y) const
+{
+    const int ix = int(std::floor((x - originX) / cellSize));
+    const int iy = int(std::floor((y - originY) / cellSize));
+    if (ix < 0 || iy < 0 || ix >= width || iy >= height) return 0;
+    return counts.get(ix, iy);
+}
+
+void VisitGrid::save(ByteWriter& out) const
+{
+    out.putDouble(originX);
+    out.putDouble(originY);
+    out.putDouble(cellSize);
+    out.putVarint(uint64_t(width));
+    out.putVarint(uint64_t(height));
+    for (int iy = 0; iy < height; ++iy) {
+        for (int ix = 0, length = 0; ix < width; ix += length) {
+            const uint16_t* run = counts.readRun(ix, iy, length);
+            out.putRaw(run, size_t(length) * sizeof(uint16_t));
+        }
+    }
+}
+
+bool VisitGrid::load(ByteReader& in)
+{
+    double x = in.getDouble();
+    double y = in.getDouble();
+    double size = in.getDouble();
+    uint64_t w = in.getVarint();
+    uint64_t h = in.getVarint();
+    if (!in.ok() || !(size > 0.0) || w == 0 || h == 0 || w * h > in.size()) return false;
+
+    std::vector<uint16_t> loaded(size_t(w * h));
+    if (!in.getRaw(loaded.data(), loaded.size() * sizeof(uint16_t))) return false;
+
+    originX = x;
+    originY = y;
+    cellSize = size;
+    width = int(w);
+    height = int(h);
+    counts.resize(width, height);
+    maxCount = 0;
+    visitedCells = 0;
+    revisitedCells = 0;
+    for (int iy = 0; iy < height; ++iy) {
+        for (int ix = 0, length = 0; ix < width; ix += length) {
+            counts.readRun(ix, iy, length);
+            const uint16_t* source = &loaded[size_t(iy) * width + ix];
+            // All-zero stretches stay in unallocated tiles
+            if (std::all_of(source, source + length, [](uint16_t c) { return c == 0; })) continue;
+            std::copy(source, source + length, counts.writeRun(ix, iy));
+            for (int i = 0; i < length; ++i) {
+                if (source[i] > 0) visitedCells++;
+                if (source[i] > 1) revisitedCells++;
+                maxCount = std::max(maxCount, source[i]);
+            }
+        }
+    }
+    return true;
+}
+
+void VisitGrid::increment(uint16_t& c, Tally& tally)
+{
+    if (c == 0) tally.visitedCells++;
+    else if (c == 1) tally.revisitedCells++;
+    if (c < UINT16_MAX) c++;
+    if (c > tally.maxCount) tally.maxCount = c;
+}
+
+void VisitGrid::addTally(const Tally& tally)
+{
+    visitedCells += tally.visitedCells;
+    revisitedCells += tally.revisitedCells;
+    maxCount = std::max(maxCount, tally.maxCount);
+}
+
+void VisitGrid::stampDisc(double cx, double cy, double radius)
+{
+    const double r2 = radius * radius;
+    int x0 = std::max(0, int(std::floor((cx - radius - originX) / cellSize)));
+    int x1 = std::min(width - 1, int(std::floor((cx + radius - originX) / cellSize)));
+    int y0 = std::max(0, int(std::floor((cy - radius - originY) / cellSize)));
+    int y1 = std::min(height - 1, int(std::floor((cy + radius - originY) / cellSize)));
+
+    Tally tally;
+    for (int iy = y0; iy <= y1; ++iy) {
+        double py = originY + (iy + 0.5) * cellSize - cy;
+        uint16_t* run = nullptr;
+        int runStart = 0, runEnd = -1;
+        for (int ix = x0; ix <= x1; ++ix) {
+            double px = originX + (ix + 0.5) * cellSize - cx;
+            if (px * px + py * py > r2) continue;
+            if (ix > runEnd) {
+                run = counts.writeRun(ix, iy);
+                runStart = ix;
+                runEnd = ix | TiledRaster<uint16_t>::tileMask;
+            }
+            increment(run[ix - runStart], tally);
+        }
+    }
+    addTally(tally);
+}
+
+namespace {
+
+// Part of the line y = py within `reach` of the point (cx, cy)
+bool discSpan(double cx, double cy, double py, double reach, double& left, double& right)
+{
+    double h = py - cy;
+    if (reach <= 0.0 || h * h > reach * reach) return false;
+    double w = std::sqrt(reach * reach - h * h);
+    left = cx - w;
+    right = cx + w;
+    return true;
+}
+
+// Part of the line y = py within `reach` of the segment from (ax, ay) by
+// (dx, dy): the end discs plus the band between them. The capsule is convex,
+// so the pieces join into one span.
+bool capsuleSpan(double ax, double ay, double dx, double dy, double py, double reach,
+                 double& left, double& right)
+{
+    if (reach <= 0.0) return false;
+    left = std::numeric_limits<double>::infinity();
+    right = -left;
+
+    double l, r;
+    if (discSpan(ax, ay, py, reach, l, r)) { left = std::min(left, l); right = std::max(right, r); }
+    if (discSpan(ax + dx, ay + dy, py, reach, l, r)) { left = std::min(left, l); right = std::max(right, r); }
+
+    // Band: |cross| <= reach * len and 0 <= projection <= len2, linear in u = x - ax
+    const double ry = py - ay;
+    const double len2 = dx * dx + dy * dy;
+    const double halfWidth = reach * std::sqrt(len2);
+    double bandLeft = -std::numeric_limits<double>::infinity();
+    double bandRight = std::numeric_limits<double>::infinity();
+    bool empty = false;
+    auto clip = [&](double coef, double offset, double low, double high) {
+        if (coef == 0.0) {
+            empty = empty || offset < low || offset > high;
+            return;
+        }
+        double u0 = (low - offset) / coef, u1 = (high - offset) / coef;
+        bandLeft = std::max(bandLeft, std::min(u0, u1));
+        bandRight = std::min(bandRight, std::max(u0, u1));
+    };
+    clip(dy, -ry * dx, -halfWidth, halfWidth);
+    clip(dx, ry * dy, 0.0, len2);
+    if (!empty && bandLeft <= bandRight) {
+        left = std::min(left, ax + bandLeft);
+        right = std::max(right, ax + bandRight);
+    }
+    return left <= right;
+}
+
+}
+
+void VisitGrid::stampSegment(double ax, double ay, double bx, double by, double radius)
+{
+    Tally tally;
+    stampSegment(ax, ay, bx, by, radius, 0, height - 1, tally);
+    addTally(tally);
+}
+
+void VisitGrid::stampSegment(double ax, double ay, double bx, double by, double radius,
+                             int firstRow, int lastRow, Tally& tally)
+{
+    const double r2 = radius * radius;
+    const double dx = bx - ax;
+    const double dy = by - ay;
+    const double len2 = dx * dx + dy * dy;
+    if (len2 <= 0.0) return;
+
+    int x0 = std::max(0, int(std::floor((std::min(ax, bx) - radius - originX) / cellSize)));
+    int x1 = std::min(width - 1, int(std::floor((std::max(ax, bx) + radius - originX) / cellSize)));
+    int y0 = std::max(firstRow, int(std::floor((std::min(ay, by) - radius - originY) / cellSize)));
+    int y1 = std::min(lastRow, int(std::floor((std::max(ay, by) + radius - originY) / cellSize)));
+    y0 = std::max(y0, 0);
+    y1 = std::min(y1, height - 1);
+
+    // Cells of a row whose centres lie in [left, right]
+    auto cellsIn = [&](double left, double right, int& first, int& last) {
+        first = int(std::ceil((left - originX) / cellSize - 0.5));
+        last = int(std::floor((right - originX) / cellSize - 0.5));
+    };
+
+    // Per row, work out which cells the disc sweeps for certain, which it
+    // certainly misses and which are certainly under the starting disc, using
+    // shapes grown or shrunk by a slack far above rounding error. Only the
+    // cells near an edge go through the exact tests, so the result is the
+    // same as testing every cell of the bounding box.
+    const double slack = 0.01 * cellSize;
+    for (int iy = y0; iy <= y1; ++iy) {
+        double py = originY + (iy + 0.5) * cellSize;
+
+        double left, right;
+        if (!capsuleSpan(ax, ay, dx, dy, py, radius + slack, left, right)) continue;
+        int rowStart, rowEnd;
+        cellsIn(left, right, rowStart, rowEnd);
+        rowStart = std::max(rowStart, x0);
+        rowEnd = std::min(rowEnd, x1);
+
+        int sweptStart = 0, sweptEnd = -1;
+        if (capsuleSpan(ax, ay, dx, dy, py, radius - slack, left, right))
+            cellsIn(left, right, sweptStart, sweptEnd);
+
+        int startStart = 0, startEnd = -1;     // may be under the starting disc
+        if (discSpan(ax, ay, py, radius + slack, left, right))
+            cellsIn(left, right, startStart, startEnd);
+
+        int underStart = 0, underEnd = -1;     // certainly under the starting disc
+        if (discSpan(ax, ay, py, radius - slack, left, right))
+            cellsIn(left, right, underStart, underEnd);
+
+        // Cells are written through the tile holding them; fetched (and
+        // unshared) on the first write that lands in each tile
+        uint16_t* run = nullptr;
+        int runStart = 0, runEnd = -1;
+
+        for (int ix = rowStart; ix <= rowEnd; ++ix) {
+            if (ix >= underStart && ix <= underEnd) {
+                ix = underEnd;
+                continue;
+            }
+
+            bool swept = ix >= sweptStart && ix <= sweptEnd && (ix < startStart || ix > startEnd);
+            if (!swept) {
+                double px = originX + (ix + 0.5) * cellSize;
+
+                // Already under the head at the start of this segment
+                double sx = px - ax;
+                double sy = py - ay;
+                if (sx * sx + sy * sy <= r2) continue;
+
+                double t = std::clamp((sx * dx + sy * dy) / len2, 0.0, 1.0);
+                double qx = sx - t * dx;
+                double qy = sy - t * dy;
+                if (qx * qx + qy * qy > r2) continue;
+            }
+            if (ix > runEnd) {
+                run = counts.writeRun(ix, iy);
+                runStart = ix;
+                runEnd = ix | TiledRaster<uint16_t>::tileMask;
+            }
+            increment(run[ix - runStart], tally);
+        }
+    }
+}
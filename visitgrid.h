@@ -0,0 +1,87 @@
+#ifndef VISITGRID_H
+#define VISITGRID_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "tiledraster.h"
+
+class ByteWriter;
+class ByteReader;
+
+// Raster of how many separate passes the vacuum head made over each cell.
+// Cells are square, cellSize plan units wide, with cell (0,0) at
+// (originX, originY). Counts saturate at 65535. The counts live in
+// copy-on-write tiles (tiledraster.h), so a copied grid costs only what the
+// copies later write differently.
+class VisitGrid
+{
+public:
+    VisitGrid();
+
+    void reset(double left, double top, double right, double bottom, double cellSize);
+    void clear();
+
+    // Marks every cell under a disc, used for the starting position
+    void stampDisc(double cx, double cy, double radius);
+    // Marks cells swept by a disc moving from (x0,y0) to (x1,y1), skipping the
+    // cells already under the disc at (x0,y0) so consecutive segments of one
+    // pass do not count the same cell twice
+    void stampSegment(double x0, double y0, double x1, double y1, double radius);
+
+    // Statistics of stamps made apart from the grid's own, folded in later
+    // with addTally. Threads stamping disjoint bands of tile rows each keep
+    // a tally, so they never write the same tile or counter.
+    struct Tally
+    {
+        int visitedCells = 0;
+        int revisitedCells = 0;
+        uint16_t maxCount = 0;
+    };
+    // stampSegment limited to rows firstRow..lastRow, counted into tally
+    void stampSegment(double x0, double y0, double x1, double y1, double radius,
+                      int firstRow, int lastRow, Tally& tally);
+    void addTally(const Tally& tally);
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    double getOriginX() const { return originX; }
+    double getOriginY() const { return originY; }
+    double getCellSize() const { return cellSize; }
+
+    uint16_t getCount(int ix, int iy) const { return counts.get(ix, iy); }
+    // Count of the cell containing the plan point (x, y), 0 off the grid
+    uint16_t getCountAt(double x, double y) const;
+    uint16_t getMaxCount() const { return maxCount; }
+    // Counts of cells (ix, iy) onwards, contiguous for `length` cells
+    const uint16_t* readRun(int ix, int iy, int& length) const { return counts.readRun(ix, iy, length); }
+
+    int getAllocatedTiles() const { return counts.getAllocatedTiles(); }
+    int getSharedTiles() const { return counts.getSharedTiles(); }
+
+    int getVisitedCells() const { return visitedCells; }
+    // Cells passed over more than once
+    int getRevisitedCells() const { return revisitedCells; }
+    double getVisitedArea() const { return visitedCells * cellSize * cellSize; }
+
+    // Geometry and counts; load() rebuilds the statistics from the counts
+    void save(ByteWriter& out) const;
+    bool load(ByteReader& in);
+
+private:
+    static void increment(uint16_t& c, Tally& tally);
+
+    double originX = 0.0;
+    double originY = 0.0;
+    double cellSize = 1.0;
+    int width = 0;
+    int height = 0;
+
+    TiledRaster<uint16_t> counts;
+    uint16_t maxCount = 0;
+    int visitedCells = 0;
+    int revisitedCells = 0;
+};
+
+#endif // VISITGRID_H
@@ -0,0 +1,113 @@
+#ifndef WORKDEQUE_H
+#define WORKDEQUE_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Chase-Lev work-stealing deque (the C11 formulation by Le, Pop, Cohen and
+// Zappa Nardelli). The owning worker pushes and pops at the bottom without
+// locking; other workers steal from the top with one compare-and-swap.
+// Arrays outgrown by push() are kept until the deque is destroyed, since a
+// thief may still be reading from one.
+template <typename T>
+class WorkDeque
+{
+public:
+    explicit WorkDeque(int64_t initialCapacity = 256)
+    {
+        int64_t capacity = 1;
+        while (capacity < initialCapacity) capacity <<= 1;
+        arrays.push_back(std::make_unique<Array>(capacity));
+        array.store(arrays.back().get(), std::memory_order_relaxed);
+    }
+
+    WorkDeque(const WorkDeque&) = delete;
+    WorkDeque& operator=(const WorkDeque&) = delete;
+
+    // Owner only
+    void push(T* item)
+    {
+        int64_t b = bottom.load(std::memory_order_relaxed);
+        int64_t t = top.load(std::memory_order_acquire);
+        Array* a = array.load(std::memory_order_relaxed);
+        if (b - t > a->capacity - 1) a = grow(a, t, b);
+        a->put(b, item);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom.store(b + 1, std::memory_order_relaxed);
+    }
+
+    // Owner only; newest item first
+    T* pop()
+    {
+        int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+        Array* a = array.load(std::memory_order_relaxed);
+        bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = top.load(std::memory_order_relaxed);
+
+        if (t > b) {
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        T* item = a->get(b);
+        if (t == b) {
+            // Last item: race the thieves for it
+            if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                item = nullptr;
+            }
+            bottom.store(b + 1, std::memory_order_relaxed);
+        }
+        return item;
+    }
+
+    // Any thread; oldest item first. nullptr when empty or on a lost race.
+    T* steal()
+    {
+        int64_t t = top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = bottom.load(std::memory_order_acquire);
+        if (t >= b) return nullptr;
+
+        Array* a = array.load(std::memory_order_acquire);
+        T* item = a->get(t);
+        if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        return item;
+    }
+
+    bool isEmpty() const
+    {
+        return bottom.load(std::memory_order_relaxed) <= top.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct Array
+    {
+        explicit Array(int64_t capacity) : capacity(capacity), slots(new std::atomic<T*>[size_t(capacity)]) {}
+
+        T* get(int64_t i) const { return slots[size_t(i & (capacity - 1))].load(std::memory_order_relaxed); }
+        void put(int64_t i, T* item) { slots[size_t(i & (capacity - 1))].store(item, std::memory_order_relaxed); }
+
+        const int64_t capacity;
+        std::unique_ptr<std::atomic<T*>[]> slots;
+    };
+
+    Array* grow(Array* old, int64_t t, int64_t b)
+    {
+        arrays.push_back(std::make_unique<Array>(old->capacity * 2));
+        Array* bigger = arrays.back().get();
+        for (int64_t i = t; i < b; i++) bigger->put(i, old->get(i));
+        array.store(bigger, std::memory_order_release);
+        return bigger;
+    }
+
+    alignas(64) std::atomic<int64_t> top{0};
+    alignas(64) std::atomic<int64_t> bottom{0};
+    std::atomic<Array*> array{nullptr};
+    std::vector<std::unique_ptr<Array>> arrays;     // owner only
+};
+
+#endif // WORKDEQUE_H